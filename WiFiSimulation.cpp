@@ -1,16 +1,22 @@
-#include "WiFiSimulation.h"
+#include "wifi4_simulation.h"
+#include "profiler.h"
+#include "snapshot.h"
+#include <algorithm>
 
-// User Class Implementation
-Packet<std::string> User::getNextPacket() {
-    if (m_packetQueue.empty()) {
-        throw WiFiSimulationException("No packets available");
-    }
-    
-    Packet<std::string> packet = m_packetQueue.front();
-    m_packetQueue.pop();
-    return packet;
+template <typename T>
+void FrequencyChannel<T>::saveState(SnapshotWriter& out) const {
+    out.put(m_bandwidth);
+    out.put(m_busyUntil);
+}
+
+template <typename T>
+void FrequencyChannel<T>::loadState(SnapshotReader& in) {
+    in.get(m_bandwidth);
+    in.get(m_busyUntil);
 }
 
+template class FrequencyChannel<std::string>;
+
 // Access Point Implementation
 double AccessPoint::calculateMaxThroughput() const {
     // Calculate theoretical max throughput based on WiFi 4 parameters
@@ -20,88 +26,123 @@ double AccessPoint::calculateMaxThroughput() const {
            m_codingRate;
 }
 
-bool AccessPoint::tryTransmit(User* user) {
-    if (!user->hasPackets()) return false;
-
-    // Check if channel is free
-    if (!m_channel.isChannelFree()) {
-        // Backoff mechanism
-        int backoffTime = m_channel.getBackoffTime();
-        return false;
+void AccessPoint::setPhyConfig(const PhyConfig& phy) {
+    if (phy.channelWidth <= 0.0 || phy.modulationOrder < 2 ||
+        phy.codingRate <= 0.0 || phy.codingRate > 1.0) {
+        throw WiFiSimulationException("Invalid PHY configuration");
     }
+    m_channel.setBandwidth(phy.channelWidth);
+    m_modulationOrder = phy.modulationOrder;
+    m_codingRate = phy.codingRate;
+}
 
-    // Occupy the channel
-    m_channel.occupy();
+PhyConfig AccessPoint::getPhyConfig() const {
+    PhyConfig phy;
+    phy.channelWidth = m_channel.getBandwidth();
+    phy.modulationOrder = m_modulationOrder;
+    phy.codingRate = m_codingRate;
+    return phy;
+}
 
-    // Transmit packet
-    try {
-        Packet<std::string> packet = user->getNextPacket();
-        
-        // Record transmission time
-        auto transmissionTime = std::chrono::steady_clock::now();
-        user->recordTransmissionTime(transmissionTime);
+SimTime AccessPoint::getTransmissionDuration(size_t sizeBytes) const {
+    // Bits divided by Mbps gives microseconds
+    double bits = sizeBytes * 8.0;
+    return std::chrono::duration_cast<SimTime>(
+        std::chrono::duration<double, std::micro>(bits / calculateMaxThroughput())
+    );
+}
 
-        // Release channel
-        m_channel.release();
-        return true;
-    }
-    catch (const WiFiSimulationException& e) {
-        std::cerr << "Transmission error: " << e.what() << std::endl;
-        m_channel.release();
-        return false;
-    }
+SimTime AccessPoint::getTransmissionDuration(const StationTable& stations, StationId station,
+                                             size_t sizeBytes) const {
+    double bits = sizeBytes * 8.0;
+    return std::chrono::duration_cast<SimTime>(
+        std::chrono::duration<double, std::micro>(
+            bits / (calculateMaxThroughput() * stations.getLinkEfficiency(station)))
+    );
+}
+
+void AccessPoint::saveState(SnapshotWriter& out) const {
+    out.putString(m_id);
+    out.put(m_position);
+    m_channel.saveState(out);
+    out.putVector(m_connectedUsers);
+    out.putGenerator(m_generator);
+    out.put(m_modulationOrder);
+    out.put(m_codingRate);
+}
+
+void AccessPoint::loadState(SnapshotReader& in) {
+    m_id = in.getString();
+    in.get(m_position);
+    m_channel.loadState(in);
+    in.getVector(m_connectedUsers);
+    in.getGenerator(m_generator);
+    in.get(m_modulationOrder);
+    in.get(m_codingRate);
+}
+
+void printLatencyPercentiles(const LatencyHistogram& latency, std::ostream& out) {
+    out << "Latency p50/p90/p99/p99.9: "
+        << latency.percentileMicroseconds(50.0) << " / "
+        << latency.percentileMicroseconds(90.0) << " / "
+        << latency.percentileMicroseconds(99.0) << " / "
+        << latency.percentileMicroseconds(99.9) << " microseconds\n";
 }
 
 // WiFi4 Simulation Implementation
-WiFi4Simulation::WiFi4Simulation(size_t userCount, const std::string& apId)
-    : m_accessPoint(apId) {
-    // Create users
-    for (size_t i = 0; i < userCount; ++i) {
-        m_users.emplace_back("User" + std::to_string(i));
-        
-        // Add some packets to each user
-        for (int j = 0; j < 10; ++j) {
-            m_users[i].addPacket(Packet<std::string>("Data" + std::to_string(j)));
-        }
-        
-        // Connect users to access point
-        m_accessPoint.addUser(&m_users[i]);
+template class Simulator<DcfMac, HtPhy, DcfBackoff>;
+
+std::unique_ptr<WiFiSimulation> createWiFi4Simulation(size_t userCount, std::uint64_t seed) {
+    return std::make_unique<SimulationAdapter<WiFi4Simulation>>(std::in_place, userCount, "AP1", seed);
+}
+
+const char* toString(WiFiStandard standard) {
+    switch (standard) {
+    case WiFiStandard::WIFI4: return "WiFi4";
+    case WiFiStandard::WIFI5: return "WiFi5";
+    case WiFiStandard::WIFI6: return "WiFi6";
     }
+    return "Unknown";
 }
 
-void WiFi4Simulation::runSimulation() {
-    const int MAX_ITERATIONS = 1000;
+// Derive throughput and latency summaries from the raw counters
+static void finalizeMetrics(SimulationMetrics& metrics) {
+    metrics.avgLatencyUs = metrics.latency.meanMicroseconds();
+    metrics.maxLatencyUs = std::chrono::duration<double, std::micro>(metrics.latency.max()).count();
 
-    for (int iter = 0; iter < MAX_ITERATIONS; ++iter) {
-        // Attempt transmission for each user
-        for (auto& user : m_users) {
-            m_accessPoint.tryTransmit(&user);
-        }
-    }
+    // Bits divided by microseconds gives Mbps
+    double elapsedUs = std::chrono::duration<double, std::micro>(metrics.lastDelivery).count();
+    metrics.throughputMbps = elapsedUs > 0.0 ? metrics.deliveredBytes * 8.0 / elapsedUs : 0.0;
 }
 
-void WiFi4Simulation::printSimulationResults() {
-    // Calculate and print throughput and latency
-    std::cout << "Simulation Results:\n";
-    std::cout << "Max Theoretical Throughput: " 
-              << m_accessPoint.calculateMaxThroughput() << " Mbps\n";
-
-    float avg_latency = 0.0;
-    float max_latency = 0.0;
-    // Calculate latency for each user
-    for (const auto& user : m_users) {
-        const auto& transmissionTimes = user.getTransmissionTimes();
-        
-        if (transmissionTimes.size() > 1) {
-            auto totalLatency = std::chrono::duration_cast<std::chrono::microseconds>(
-                transmissionTimes.back() - transmissionTimes.front()
-            ).count();
-            max_latency = max_latency > (totalLatency / transmissionTimes.size()) ? max_latency : (totalLatency / transmissionTimes.size());
-            avg_latency += totalLatency / transmissionTimes.size();
-            // std::cout << user.getId() << " Average Latency: " 
-            //           << (totalLatency / transmissionTimes.size()) << " microseconds\n";
+SimulationMetrics collectStationMetrics(const StationTable& stations) {
+    PROFILE_SCOPE("collectStationMetrics");
+    SimulationMetrics metrics;
+
+    const StationId stationCount = static_cast<StationId>(stations.size());
+    for (StationId station = 0; station < stationCount; ++station) {
+        std::uint64_t delivered = stations.getDeliveredPackets(station);
+        metrics.deliveredPackets += delivered;
+        metrics.deliveredBytes += stations.getDeliveredBytes(station);
+        if (delivered > 0) {
+            metrics.lastDelivery = std::max(metrics.lastDelivery, stations.getLastDelivery(station));
         }
     }
-    std::cout<< "Average Latency of "<< m_users.size() << " Users: " << avg_latency / m_users.size() << " microseconds\n";
-    std::cout<< "Max Latency of "<< m_users.size() << " Users: " << max_latency << " microseconds\n";
+
+    // Per-packet enqueue-to-delivery latency of the whole cell
+    metrics.latency = stations.getLatencyHistogram();
+    metrics.droppedPackets = stations.getTotalDroppedPackets();
+    finalizeMetrics(metrics);
+    return metrics;
+}
+
+void mergeMetrics(SimulationMetrics& total, const SimulationMetrics& other) {
+    PROFILE_SCOPE("mergeMetrics");
+    total.deliveredPackets += other.deliveredPackets;
+    total.deliveredBytes += other.deliveredBytes;
+    total.droppedPackets += other.droppedPackets;
+    total.collisions += other.collisions;
+    total.lastDelivery = std::max(total.lastDelivery, other.lastDelivery);
+    total.latency.merge(other.latency);
+    finalizeMetrics(total);
 }
@@ -1,6 +1,7 @@
 #ifndef WIFI_SIMULATION_H
-#define __WIFI_SIMULATION_H
+#define WIFI_SIMULATION_H
 
+#include <algorithm>
 #include <vector>
 #include <queue>
 #include <random>
@@ -10,6 +11,11 @@
 #include <iostream>
 #include <cmath>
 
+#include "wifi_common.h"
+#include "station_table.h"
+#include "random_streams.h"
+#include "traffic.h"
+
 // Forward declarations
 template <typename T>
 class Packet;
@@ -19,157 +25,191 @@ class FrequencyChannel;
 
 class User;
 class AccessPoint;
-
-// Exception class for WiFi simulation errors
-class WiFiSimulationException : public std::runtime_error {
-public:
-    explicit WiFiSimulationException(const std::string& message)
-        : std::runtime_error(message) {}
-};
-
-// Abstract base class for network entities
-class NetworkEntity {
-protected:
-    std::string m_id;
-
-public:
-    NetworkEntity(const std::string& id) : m_id(id) {}
-    virtual ~NetworkEntity() = default;
-    std::string getId() const { return m_id; }
-};
-
-// Packet Template Class
-template <typename T>
-class Packet {
-private:
-    T m_data;
-    size_t m_size;  // in KB
-    std::chrono::steady_clock::time_point m_creationTime;
-
-public:
-    Packet(const T& data, size_t size = 1) 
-        : m_data(data), m_size(size), 
-          m_creationTime(std::chrono::steady_clock::now()) {}
-
-    size_t getSize() const { return m_size; }
-    auto getCreationTime() const { return m_creationTime; }
-};
+class SnapshotWriter;
+class SnapshotReader;
 
 // Frequency Channel Template Class
 template <typename T>
 class FrequencyChannel {
 private:
     double m_bandwidth;  // in MHz
-    bool m_isOccupied;
-    std::mt19937 m_generator;
-    std::uniform_int_distribution<> m_backoffDistribution;
+    SimTime m_busyUntil; // Simulated time at which the current transmission ends
 
 public:
-    FrequencyChannel(double bandwidth = 20.0) 
-        : m_bandwidth(bandwidth), 
-          m_isOccupied(false), 
-          m_generator(std::random_device{}()),
-          m_backoffDistribution(0, 15) {}
-
-    bool isChannelFree() const { return !m_isOccupied; }
-    void occupy() { m_isOccupied = true; }
-    void release() { m_isOccupied = false; }
-
-    int getBackoffTime() {
-        return m_backoffDistribution(m_generator);
-    }
+    explicit FrequencyChannel(double bandwidth = 20.0)
+        : m_bandwidth(bandwidth),
+          m_busyUntil(SimTime::zero()) {}
 
-    double getBandwidth() const { return m_bandwidth; }
-};
+    bool isChannelFree(SimTime now) const { return now >= m_busyUntil; }
+    void occupy(SimTime until) { m_busyUntil = until; }
+    void release(SimTime now) { m_busyUntil = now; }
+    SimTime getBusyUntil() const { return m_busyUntil; }
 
-// User Class
-class User : public NetworkEntity {
-private:
-    std::queue<Packet<std::string>> m_packetQueue;
-    std::vector<std::chrono::steady_clock::time_point> m_transmissionTimes;
-
-public:
-    User(const std::string& id) : NetworkEntity(id) {}
-
-    void addPacket(const Packet<std::string>& packet) {
-        m_packetQueue.push(packet);
-    }
-
-    bool hasPackets() const { return !m_packetQueue.empty(); }
-    Packet<std::string> getNextPacket();
+    double getBandwidth() const { return m_bandwidth; }
+    void setBandwidth(double bandwidth) { m_bandwidth = bandwidth; }
 
-    void recordTransmissionTime(const std::chrono::steady_clock::time_point& time) {
-        m_transmissionTimes.push_back(time);
-    }
+    // Defined for FrequencyChannel<std::string> in WiFiSimulation.cpp
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+};
 
-    const std::vector<std::chrono::steady_clock::time_point>& getTransmissionTimes() const {
-        return m_transmissionTimes;
-    }
+// PHY parameters of an access point (defaults are the original 20 MHz 256-QAM 5/6)
+struct PhyConfig {
+    double channelWidth = 20.0;      // in MHz
+    int modulationOrder = 256;       // QAM constellation size
+    double codingRate = 5.0 / 6.0;
 };
 
 // Access Point Class
 class AccessPoint : public NetworkEntity {
 private:
     FrequencyChannel<std::string> m_channel;
-    std::vector<User*> m_connectedUsers;
+    std::vector<StationId> m_connectedUsers;
     std::mt19937 m_generator;
     std::uniform_real_distribution<> m_probabilityDistribution;
 
     // Modulation and coding parameters
-    const int m_modulationOrder = 256;  // 256-QAM
-    const double m_codingRate = 5.0 / 6.0;
+    int m_modulationOrder;  // 256-QAM by default
+    double m_codingRate;
 
 public:
-    AccessPoint(const std::string& id) 
+    AccessPoint(const std::string& id, std::uint64_t seed = DEFAULT_SIMULATION_SEED,
+                const PhyConfig& phy = PhyConfig()) 
         : NetworkEntity(id), 
-          m_channel(20.0),
-          m_generator(std::random_device{}()),
-          m_probabilityDistribution(0.0, 1.0) {}
+          m_channel(phy.channelWidth),
+          m_probabilityDistribution(0.0, 1.0),
+          m_modulationOrder(phy.modulationOrder),
+          m_codingRate(phy.codingRate) {
+        seedGenerator(m_generator, deriveStreamSeed(seed, 1));
+    }
+
+    // Change channel width, modulation and coding rate
+    void setPhyConfig(const PhyConfig& phy);
+    PhyConfig getPhyConfig() const;
+
+    void addUser(StationId station) {
+        m_connectedUsers.push_back(station);
+    }
 
-    void addUser(User* user) {
-        m_connectedUsers.push_back(user);
+    // Disassociate a station (e.g. on handoff to another AP)
+    void removeUser(StationId station) {
+        m_connectedUsers.erase(std::remove(m_connectedUsers.begin(), m_connectedUsers.end(), station),
+                               m_connectedUsers.end());
     }
 
+    const std::vector<StationId>& getConnectedUsers() const { return m_connectedUsers; }
+
     FrequencyChannel<std::string>& getChannel() { return m_channel; }
 
     double calculateMaxThroughput() const;
-    
-    bool tryTransmit(User* user);
+
+    // Airtime needed to send a packet of the given size (bytes) at the max PHY rate
+    SimTime getTransmissionDuration(size_t sizeBytes) const;
+
+    // Airtime of a packet to `station`, at the max PHY rate scaled by its link efficiency
+    SimTime getTransmissionDuration(const StationTable& stations, StationId station, size_t sizeBytes) const;
+
+
+    // Channel, associated stations, generator and PHY parameters
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
 };
 
-class WiFiSimulation{
-    public:
-        virtual void runSimulation()=0;
-        virtual void printSimulationResults()=0;
+// Aggregate results of one simulation run
+struct SimulationMetrics {
+    size_t deliveredPackets = 0;
+    size_t deliveredBytes = 0;
+    size_t droppedPackets = 0;     // Lost to full queues or the retry limit
+    size_t collisions = 0;         // DCF channel accesses that collided
+    SimTime lastDelivery = SimTime::zero();
+    double throughputMbps = 0.0;   // Delivered bits over elapsed simulated time
+    double avgLatencyUs = 0.0;     // Mean per-packet enqueue-to-delivery latency
+    double maxLatencyUs = 0.0;     // Largest per-packet latency
+    LatencyHistogram latency;      // Full per-packet latency distribution
 };
 
-// WiFi Simulation Class
-// class WiFi4Simulation : public WiFiSimulation {
-// private:
-//     AccessPoint m_accessPoint;
-//     std::vector<User> m_users;
+// Throughput and latency of everything delivered to the stations of a table
+SimulationMetrics collectStationMetrics(const StationTable& stations);
+
+// Fold `other` (e.g. another cell) into `total`; throughput is recomputed
+// over the combined elapsed time
+void mergeMetrics(SimulationMetrics& total, const SimulationMetrics& other);
 
-// public:
-//     WiFi4Simulation(size_t userCount, const std::string& apId = "AP1");
+// Print the p50/p90/p99/p99.9 latency line shared by every standard
+void printLatencyPercentiles(const LatencyHistogram& latency, std::ostream& out = std::cout);
 
-//     void runSimulation();
-//     void printSimulationResults();
-// };
+// Supported WiFi standards
+enum class WiFiStandard {
+    WIFI4,
+    WIFI5,
+    WIFI6
+};
 
-class WiFi4Simulation {
-protected:
-    // Make m_users protected to allow access in derived classes
-    std::vector<User> m_users;
-    AccessPoint m_accessPoint;
+// Human-readable name of a standard ("WiFi4", ...)
+const char* toString(WiFiStandard standard);
 
+// Common interface of every standard's simulation, for code that picks the
+// standard at run time (factories, sweeps, snapshots). Each implementation
+// is a SimulationAdapter around one Simulator composition (simulator.h);
+// the virtual calls stop at this API, the event loop behind it has none.
+class WiFiSimulation {
 public:
-    WiFi4Simulation(size_t userCount, const std::string& apId = "AP1");
+    virtual ~WiFiSimulation() = default;
+
+    virtual WiFiStandard getStandard() const = 0;
+
+    // Number of contention rounds / sounding rounds / OFDMA windows to run (0 = no limit).
+    // A WiFi4 round is one channel access per user, on average.
+    virtual void setMaxIterations(int iterations) = 0;
+    virtual int getMaxIterations() const = 0;
+
+    // Traffic offered by the stations; must be set before runSimulation()
+    virtual void setTrafficConfig(const TrafficConfig& config) = 0;
+    virtual const TrafficGenerator& getTraffic() const = 0;
+
+    // Apply PHY parameters to the access point
+    virtual void setPhyConfig(const PhyConfig& phy) = 0;
+
+    // Current simulated time
+    virtual SimTime getSimulatedTime() const = 0;
+
+    virtual StationTable& getStations() = 0;
+    virtual const StationTable& getStations() const = 0;
+
+    // Start the traffic sources and the MAC at the current simulated time
+    // (once; later calls do nothing)
+    virtual void start() = 0;
+
+    // Run every event up to `endTime`, then stop the clock there; the run
+    // can be continued (or forked) from that point
+    virtual void runUntil(SimTime endTime) = 0;
+
+    virtual void runSimulation() = 0;
+    virtual void printSimulationResults() = 0;
+
+    // Associate `count` new stations, e.g. clients joining mid-run. Their
+    // traffic starts at the current simulated time if the run has started.
+    // Returns the id of the first new station.
+    virtual StationId addUsers(size_t count) = 0;
+
+    // Throughput and latency of the run so far
+    virtual SimulationMetrics collectMetrics() const = 0;
+
+    // Independent copy of the simulation in its current state; running the
+    // copy gives the same results as running the original. Station columns
+    // are shared copy-on-write, so a fork costs the per-station state the
+    // copy actually changes. Forking is a read of the original: several
+    // threads may fork the same (not running) simulation at once.
+    virtual std::unique_ptr<WiFiSimulation> fork() const = 0;
 
-    // Getter for users
-    std::vector<User>& getUsers() { return m_users; }
-    const std::vector<User>& getUsers() const { return m_users; }
+    // Complete simulation state (see simulation_snapshot.h for the file format)
+    virtual void saveState(SnapshotWriter& out) const = 0;
+    virtual void loadState(SnapshotReader& in) = 0;
 
-    virtual void runSimulation();
-    virtual void printSimulationResults();
+    // The composition behind this interface, e.g. as<WiFi6Simulation>() for
+    // the RU scheduling policy; null if it is another standard. Defined in
+    // simulator.h.
+    template <typename Sim> Sim* as();
+    template <typename Sim> const Sim* as() const;
 };
-#endif // WIFI4_SIMULATION_H
+#endif // WIFI_SIMULATION_H
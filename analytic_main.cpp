@@ -0,0 +1,95 @@
+#include "sweep_engine.h"
+#include "statistics.h"
+#include "command_line.h"
+#include <cmath>
+#include <iomanip>
+#include <map>
+
+// Relative error of an estimate against the simulated value, in percent
+static double errorPercent(double estimate, double simulated) {
+    return simulated != 0.0 ? 100.0 * (estimate - simulated) / simulated : 0.0;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        size_t maxUsers = 1000;
+        std::uint64_t masterSeed = DEFAULT_SIMULATION_SEED;
+        if (argc > 3 || (argc > 1 && !parseCount(argv[1], maxUsers)) ||
+            (argc > 2 && !parseUnsigned(argv[2], masterSeed))) {
+            std::cerr << "Usage: validate [max users] [master seed]\n";
+            return 1;
+        }
+
+        // Backlogged cells and Poisson loads from light to beyond capacity,
+        // up to the cell sizes sweep covers, on the corners of its PHY grid
+        SweepSpace space;
+        space.userCounts.clear();
+        for (size_t users : {1, 5, 10, 50, 100, 500, 1000}) {
+            if (users <= maxUsers) space.userCounts.push_back(users);
+        }
+        space.modulationOrders = {16, 256};
+        space.codingRates = {1.0 / 2.0, 5.0 / 6.0};
+        space.channelWidths = {20.0, 80.0};
+        space.offeredLoadsMbps = {0.0, 5.0, 20.0, 50.0, 200.0};
+
+        // Host time of one estimate, over every point
+        std::vector<SweepPoint> points = SweepEngine::expand(space);
+        const int REPEATS = 100;
+        double checksum = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < REPEATS; ++repeat) {
+            for (const SweepPoint& point : points) checksum += SweepEngine::estimate(point).throughputMbps;
+        }
+        double estimateUs = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start).count() / (REPEATS * points.size());
+
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "standard users  mod width  load |  sim Mbps  est Mbps   err% |    sim us    est us   err%\n";
+
+        struct ErrorSummary {
+            RunningStatistics throughput;
+            RunningStatistics latency;
+            double simulationMs = 0.0;
+        };
+        std::map<WiFiStandard, ErrorSummary> summaries;
+
+        SweepEngine engine(masterSeed);
+        engine.run(space, [&summaries](const SweepResult& result) {
+            const SweepPoint& point = result.point;
+            const double throughputError = errorPercent(result.estimate.throughputMbps, result.metrics.throughputMbps);
+            const double latencyError = errorPercent(result.estimate.avgLatencyUs, result.metrics.avgLatencyUs);
+            std::cout << std::setw(8) << toString(point.standard) << std::setw(6) << point.userCount
+                      << std::setw(5) << point.phy.modulationOrder << std::setw(6) << point.phy.channelWidth
+                      << std::setw(6) << point.offeredLoadMbps << " |"
+                      << std::setw(10) << result.metrics.throughputMbps << std::setw(10) << result.estimate.throughputMbps
+                      << std::setw(7) << throughputError << " |"
+                      << std::setw(10) << result.metrics.avgLatencyUs << std::setw(10) << result.estimate.avgLatencyUs
+                      << std::setw(7) << latencyError << "\n";
+
+            ErrorSummary& summary = summaries[point.standard];
+            summary.throughput.add(std::fabs(throughputError));
+            summary.latency.add(std::fabs(latencyError));
+            summary.simulationMs += result.wallTimeMs;
+        });
+
+        std::cout << "\nMean / worst absolute error:\n";
+        for (const auto& entry : summaries) {
+            const ErrorSummary& summary = entry.second;
+            std::cout << "  " << toString(entry.first) << ": throughput " << summary.throughput.mean() << "% / "
+                      << summary.throughput.max() << "%, latency " << summary.latency.mean() << "% / "
+                      << summary.latency.max() << "%, simulated in "
+                      << summary.simulationMs / summary.throughput.count() << " ms per point\n";
+        }
+        std::cout << std::setprecision(2) << "Estimate: " << estimateUs << " us per point ("
+                  << points.size() << " points, checksum " << checksum << ")\n";
+        return 0;
+    }
+    catch (const WiFiSimulationException& e) {
+        std::cerr << "Simulation Error: " << e.what() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Unexpected Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
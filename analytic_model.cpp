@@ -0,0 +1,672 @@
+#include "analytic_model.h"
+#include "ru_allocation.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+const double QUEUE_PACKETS = static_cast<double>(StationTable::DEFAULT_QUEUE_CAPACITY);
+
+// Fixed MAC timings of the simulator, in microseconds
+const double MU_MIMO_WINDOW_US = 15000.0;
+const double OFDMA_WINDOW_US = 5000.0;
+const double SOUNDING_BYTES = 512.0;
+const double CSI_BYTES = 200.0;
+
+double microseconds(SimTime time) {
+    return std::chrono::duration<double, std::micro>(time).count();
+}
+
+// What the workload asks of the cell
+struct Workload {
+    enum Kind { BACKLOG, SATURATED, ARRIVALS } kind;
+    double users;
+    double packetBits;
+    double backlogPackets;  // BACKLOG: total over the cell
+    double rounds;          // SATURATED: MAC rounds the run is limited to; 0 = unbounded
+    double arrivalRate;     // ARRIVALS: offered packets per microsecond, whole cell
+    double durationUs;      // ARRIVALS
+};
+
+// Packets per microsecond one station offers under an arrival model
+double stationArrivalRate(const TrafficConfig& traffic) {
+    switch (traffic.model) {
+    case TrafficModel::POISSON:
+    case TrafficModel::CBR:
+        return traffic.packetsPerSecond / 1e6;
+    case TrafficModel::ON_OFF:
+        // Long-run rate; the burstiness itself is not modelled
+        return traffic.packetsPerSecond / 1e6 * traffic.meanOnMs / (traffic.meanOnMs + traffic.meanOffMs);
+    case TrafficModel::REPLAY:
+        throw WiFiSimulationException("The analytic model does not cover replayed traffic");
+    default:
+        return 0.0;
+    }
+}
+
+// P(X < count) for X ~ Poisson(mean)
+double poissonBelow(double mean, unsigned count) {
+    double term = std::exp(-mean);
+    double sum = 0.0;
+    for (unsigned k = 0; k < count; ++k) {
+        sum += term;
+        term *= mean / (k + 1);
+    }
+    return sum;
+}
+
+// Saturated cell serving `capacity` packets per microsecond: queues stay
+// full, so by Little's law a packet waits for a whole queue of every
+// station. Queues start full at time zero, which a short run still sees.
+void estimateSaturated(AnalyticEstimate& estimate, const Workload& load, double capacity, double runUs) {
+    const double queued = QUEUE_PACKETS * load.users;
+    const double steadyLatency = queued / capacity;
+    estimate.throughputMbps = capacity * load.packetBits;
+    estimate.avgLatencyUs = steadyLatency;
+    if (runUs > 0.0) {
+        const double delivered = capacity * runUs;
+        if (delivered <= queued) {
+            estimate.avgLatencyUs = runUs / 2.0;
+        } else {
+            estimate.avgLatencyUs = (queued * steadyLatency / 2.0 + (delivered - queued) * steadyLatency) / delivered;
+        }
+    }
+    estimate.utilization = 1.0;
+}
+
+// Arrivals beyond the capacity: queues fill and the excess is dropped. A
+// packet waits for a full queue of every station once the queues have
+// filled; they grow at the excess rate until then, and the run goes on
+// until the queues left at the end of the traffic drain.
+bool estimateOverload(AnalyticEstimate& estimate, const Workload& load, double capacity) {
+    estimate.utilization = load.arrivalRate / capacity;
+    if (estimate.utilization < 1.0) return false;
+
+    // Each station's queue as M/M/1/K at the same overload: not quite full
+    const double rho = estimate.utilization;
+    const double tail = std::pow(rho, QUEUE_PACKETS + 1.0);
+    const double occupancy = rho > 1.0 + 1e-9
+        ? rho / (1.0 - rho) - (QUEUE_PACKETS + 1.0) * tail / (1.0 - tail)
+        : QUEUE_PACKETS / 2.0;
+    const double steadyLatency = occupancy * load.users / capacity;
+    // Latency of a delivery at time t: min(steady, growth * t)
+    const double growth = std::min(rho - 1.0, 1.0);
+    const double rampUs = steadyLatency / growth;
+    double total;
+    if (rampUs >= load.durationUs) {
+        const double last = growth * load.durationUs;
+        total = growth * load.durationUs * load.durationUs / 2.0 + last * last;
+        estimate.avgLatencyUs = total / (load.durationUs + last);
+    } else {
+        total = steadyLatency * (rampUs / 2.0 + load.durationUs - rampUs + steadyLatency);
+        estimate.avgLatencyUs = total / (load.durationUs + steadyLatency);
+    }
+    estimate.throughputMbps = capacity * load.packetBits;
+    return true;
+}
+
+// Arrivals beyond the capacity of a cell whose stations all contend, each
+// queue served at `serviceRate` packets per microsecond. Queues take much
+// of a run to fill, so each is an M/M/1/K chain started empty and carried
+// through the run with implicit Euler steps (stable at any step size); an
+// accepted arrival waits for the packets ahead of it. Returns the mean
+// share of stations holding a packet.
+double estimateFillingQueues(AnalyticEstimate& estimate, const Workload& load, double capacity,
+                             double serviceRate) {
+    const int STEPS = 64;
+    const size_t LIMIT = static_cast<size_t>(QUEUE_PACKETS);
+    const double arrival = load.arrivalRate / load.users;
+    const double step = load.durationUs / STEPS;
+
+    std::vector<double> occupancy(LIMIT + 1, 0.0);  // P(k queued)
+    occupancy[0] = 1.0;
+    std::vector<double> diagonal(LIMIT + 1), upper(LIMIT + 1), solved(LIMIT + 1);
+    double accepted = 0.0;
+    double latency = 0.0;
+    double backlogged = 0.0;
+    for (int i = 0; i < STEPS; ++i) {
+        // (I - step * Q) next = occupancy, tridiagonal (Thomas algorithm)
+        for (size_t k = 0; k <= LIMIT; ++k) {
+            diagonal[k] = 1.0 + step * ((k < LIMIT ? arrival : 0.0) + (k > 0 ? serviceRate : 0.0));
+        }
+        const double below = -step * arrival;      // Into k from k - 1
+        const double above = -step * serviceRate;  // Into k from k + 1
+        upper[0] = above / diagonal[0];
+        solved[0] = occupancy[0] / diagonal[0];
+        for (size_t k = 1; k <= LIMIT; ++k) {
+            const double pivot = diagonal[k] - below * upper[k - 1];
+            upper[k] = k < LIMIT ? above / pivot : 0.0;
+            solved[k] = (occupancy[k] - below * solved[k - 1]) / pivot;
+        }
+        occupancy[LIMIT] = solved[LIMIT];
+        for (size_t k = LIMIT; k-- > 0;) occupancy[k] = solved[k] - upper[k] * occupancy[k + 1];
+
+        const double open = 1.0 - occupancy[LIMIT];
+        double ahead = 0.0;
+        for (size_t k = 0; k < LIMIT; ++k) ahead += k * occupancy[k];
+        accepted += arrival * open * step;
+        latency += arrival * step * (ahead + open) / serviceRate;
+        backlogged += (1.0 - occupancy[0]) / STEPS;
+    }
+    estimate.avgLatencyUs = accepted > 0.0 ? latency / accepted : 0.0;
+    estimate.throughputMbps = capacity * load.packetBits;
+    return backlogged;
+}
+
+// Arrivals delivered up to `capacity` packets per microsecond; the last
+// packet lands one latency after the last arrival
+void estimateDelivered(AnalyticEstimate& estimate, const Workload& load, double capacity, double latencyUs) {
+    estimate.avgLatencyUs = latencyUs;
+    const double delivered = std::min(load.arrivalRate, capacity) * load.durationUs;
+    const double lastDelivery = std::max(load.durationUs - 1.0 / load.arrivalRate, 0.0) + estimate.avgLatencyUs;
+    estimate.throughputMbps = lastDelivery > 0.0 ? delivered * load.packetBits / lastDelivery : 0.0;
+}
+
+// Share of the time a gated round-based MAC is busy under Poisson
+// arrivals: an arrival to an idle cell starts a round of `roundUs`, and
+// rounds follow each other while any packet arrived during the last one
+double busyFraction(double arrivalRate, double roundUs) {
+    const double rounds = std::exp(std::min(arrivalRate * roundUs, 50.0));
+    const double busy = rounds * roundUs;
+    return busy / (busy + 1.0 / arrivalRate);
+}
+
+// Mean wait of a packet arriving mid-round for the next round to start.
+// Queues that fill before the round ends only take arrivals early in it.
+double nextRoundWait(const Workload& load, double roundUs) {
+    const double fill = QUEUE_PACKETS * load.users / load.arrivalRate;
+    return roundUs - std::min(fill, roundUs) / 2.0;
+}
+
+// ---- WiFi4: DCF ----------------------------------------------------------
+
+AnalyticEstimate estimateDcf(const Workload& load, double peakRate) {
+    const DcfParameters params;
+    const DcfSaturation saturation = solveDcfSaturation(static_cast<size_t>(load.users),
+                                                        static_cast<std::uint32_t>(load.packetBits / 8.0),
+                                                        peakRate, params);
+    const double capacity = saturation.throughputMbps / load.packetBits;
+    const double ackUs = microseconds(params.sifs + params.ackDuration);
+
+    AnalyticEstimate estimate;
+    estimate.capacityMbps = saturation.throughputMbps;
+    estimate.collisionProbability = saturation.collisionProbability;
+
+    if (load.kind == Workload::BACKLOG) {
+        // Every packet is queued at time zero. Packets leave a queue,
+        // delivered or dropped at the retry limit, at the rate of the
+        // stations still contending, and a station stops contending once
+        // its queue is empty: taking each queue's departures as Poisson,
+        // the contenders left after `consumed` departures per station are
+        // those below their backlog. The latency is measured before the ACK.
+        const unsigned backlog = static_cast<unsigned>(std::max(std::lround(load.backlogPackets / load.users), 1L));
+        double consumedEnd = backlog;
+        while (load.users * poissonBelow(consumedEnd, backlog) > 0.5) consumedEnd += 0.5;
+
+        const int STEPS = 16;
+        const double step = consumedEnd / STEPS;
+        double elapsed = 0.0;
+        double delivered = 0.0;
+        double deliveryTimes = 0.0;
+        double firstInterval = 0.0;  // Deliveries are discrete: the first waits a whole interval
+        for (int i = 0; i < STEPS; ++i) {
+            const double contenders = load.users * poissonBelow((i + 0.5) * step, backlog);
+            const DcfSaturation draining = solveDcfSaturation(
+                static_cast<size_t>(std::max(std::lround(contenders), 1L)),
+                static_cast<std::uint32_t>(load.packetBits / 8.0), peakRate, params);
+            const double deliveryRate = draining.throughputMbps / load.packetBits;
+            if (i == 0) firstInterval = 1.0 / deliveryRate;
+            const double duration = step * contenders * (1.0 - draining.dropProbability) / deliveryRate;
+            delivered += deliveryRate * duration;
+            deliveryTimes += deliveryRate * duration * (elapsed + duration / 2.0);
+            elapsed += duration;
+        }
+        estimate.throughputMbps = delivered * load.packetBits / (elapsed - ackUs);
+        estimate.avgLatencyUs = deliveryTimes / delivered + firstInterval / 2.0 - ackUs;
+        estimate.utilization = 1.0;
+        return estimate;
+    }
+    if (load.kind == Workload::SATURATED) {
+        // A round is one access per station
+        estimateSaturated(estimate, load, capacity, load.rounds * load.users * saturation.accessDurationUs);
+        return estimate;
+    }
+    // M/D/1 waiting on top of one access with DIFS, the mean first backoff
+    // and the frame. Below saturation only the stations holding a packet
+    // contend, so the service rate is that of about Little's-law many
+    // stations, found by iterating. A run of finite length stops the
+    // queue short of its steady state near the capacity: a critically
+    // loaded queue grows like sqrt(2 lambda t / pi), averaged over the run.
+    const double access = microseconds(params.difs) + microseconds(params.slotTime) * params.cwMin / 2.0 +
+                          load.packetBits / peakRate;
+    const double horizonQueue = 2.0 / 3.0 * std::sqrt(2.0 * load.arrivalRate * load.durationUs / M_PI);
+    double contenders = 1.0;
+    double latency = access;
+    double service = capacity;
+    for (int step = 0; step < 8; ++step) {
+        service = solveDcfSaturation(static_cast<size_t>(std::lround(contenders)),
+                                     static_cast<std::uint32_t>(load.packetBits / 8.0),
+                                     peakRate, params).throughputMbps / load.packetBits;
+        const double rho = std::min(load.arrivalRate / service, 1.0);
+        const double waiting = rho < 1.0 ? rho / (2.0 * (1.0 - rho)) / service : horizonQueue / service;
+        latency = access + std::min(waiting, horizonQueue / service);
+        const double next = std::max(1.0, load.users * (1.0 - std::exp(-load.arrivalRate * latency / load.users)));
+        if (std::lround(next) == std::lround(contenders)) break;
+        contenders = next;
+    }
+
+    // Beyond the capacity of every station contending, a cell can still
+    // settle where only a few hold packets. Loaded past CONGESTION_TIP of
+    // that, the Poisson bursts of a run back up enough stations to tip it
+    // into full contention, and every queue then fills.
+    const double CONGESTION_TIP = 0.75;
+    estimate.utilization = load.arrivalRate / service;
+    if (load.arrivalRate >= capacity && estimate.utilization >= CONGESTION_TIP) {
+        // Packets leave the queues delivered or dropped at the retry limit
+        const double departures = capacity / (1.0 - saturation.dropProbability);
+        const double backlogged = estimateFillingQueues(estimate, load, capacity, departures / load.users);
+        // Only the stations holding a packet contend for the medium
+        const double delivered = solveDcfSaturation(
+            static_cast<size_t>(std::max(std::lround(backlogged * load.users), 1L)),
+            static_cast<std::uint32_t>(load.packetBits / 8.0), peakRate, params).throughputMbps;
+        estimate.throughputMbps = std::min(delivered, load.arrivalRate * load.packetBits);
+        estimate.utilization = load.arrivalRate / capacity;
+        return estimate;
+    }
+    estimateDelivered(estimate, load, service, latency);
+    return estimate;
+}
+
+// ---- WiFi5: MU-MIMO --------------------------------------------------------
+
+// CDF of a Gamma(shape, 1) variable with integer shape (Erlang)
+double erlangCdf(unsigned shape, double x) {
+    if (x <= 0.0) return 0.0;
+    double term = 1.0;
+    double sum = 1.0;
+    for (unsigned i = 1; i < shape; ++i) {
+        term *= x / i;
+        sum += term;
+    }
+    return 1.0 - std::exp(-x) * sum;
+}
+
+// Mean normalized correlation |h_i^H h_j|^2 / (|h_i|^2 |h_j|^2) of two
+// members: Beta(1, antennas - 1), truncated at the grouping threshold
+double meanMemberCorrelation(const MuMimoConfig& config) {
+    const double b = static_cast<double>(config.antennas) - 1.0;
+    const double t = std::min(config.correlationThreshold * config.correlationThreshold, 1.0);
+    const double mass = 1.0 - std::pow(1.0 - t, b);
+    if (!(mass > 0.0)) return 0.0;
+    return (-t * std::pow(1.0 - t, b) + (1.0 - std::pow(1.0 - t, b + 1.0)) / (b + 1.0)) / mass;
+}
+
+// Mean airtime factor 1 / (spectral efficiency) of the weakest of `group`
+// zero-forcing streams. A stream's SINR is SNR / group times its channel
+// gain, Gamma(antennas), less what zero forcing projects out against the
+// other members' near-orthogonal channels. Streams below the minimum SINR
+// are dropped, and no stream beats the peak efficiency.
+double weakestStreamTime(const MuMimoConfig& config, unsigned group, double peakEfficiency) {
+    const double projected = std::max(1.0 - (group - 1.0) * meanMemberCorrelation(config), 0.05);
+    const double snr = std::pow(10.0, config.snrDb / 10.0) / group * projected;
+    const double minSinr = std::pow(10.0, config.minSinrDb / 10.0);
+    const unsigned shape = config.antennas;
+    auto time = [&](double gain) { return 1.0 / std::min(std::log2(1.0 + snr * gain), peakEfficiency); };
+    auto survival = [&](double gain) { return std::pow(1.0 - erlangCdf(shape, gain), group); };
+
+    // E[h(Y) | Y >= x0] = h(x0) + integral of h'(x) P(Y > x | Y >= x0), with
+    // h flat past the gain that reaches the peak efficiency
+    const double lowest = std::max(minSinr, 1e-3) / snr;
+    const double capped = (std::exp2(peakEfficiency) - 1.0) / snr;
+    if (capped <= lowest) return 1.0 / peakEfficiency;
+    const double base = survival(lowest);
+    if (!(base > 0.0)) return time(lowest);
+
+    const int STEPS = 64;
+    const double ratio = std::pow(capped / lowest, 1.0 / STEPS);
+    double expected = time(lowest);
+    double x = lowest;
+    for (int step = 0; step < STEPS; ++step) {
+        double next = x * ratio;
+        expected += (time(next) - time(x)) * survival(std::sqrt(x * next)) / base;
+        x = next;
+    }
+    return expected;
+}
+
+// Mean members and length of a TXOP whose greedy selection sees a given
+// number of candidates
+struct TxopShape {
+    double members;
+    double lengthUs;
+};
+
+// TXOP shapes for pools of 1..candidatePool candidates. Two random
+// channels pass the correlation test with probability
+// 1 - (1 - threshold^2)^(antennas - 1) (the normalized correlation is
+// Beta(1, antennas - 1)); a candidate must pass against every member so far.
+std::vector<TxopShape> txopShapes(const MuMimoConfig& config, double packetBits, double bandwidth,
+                                  double peakEfficiency) {
+    const unsigned largest = std::max(1u, std::min(config.maxGroupSize, config.antennas));
+    const double pass = 1.0 - std::pow(1.0 - config.correlationThreshold * config.correlationThreshold,
+                                       static_cast<double>(config.antennas) - 1.0);
+    std::vector<double> streamUs(largest + 1, 0.0);
+    for (unsigned g = 1; g <= largest; ++g) {
+        streamUs[g] = packetBits / bandwidth * weakestStreamTime(config, g, peakEfficiency);
+    }
+
+    std::vector<TxopShape> shapes;
+    std::vector<double> members(largest + 1, 0.0);
+    members[1] = 1.0;
+    for (size_t pool = 1; pool <= std::max<size_t>(config.candidatePool, 1); ++pool) {
+        if (pool > 1) {
+            for (unsigned m = largest - 1; m >= 1; --m) {
+                double accepted = members[m] * std::pow(pass, m);
+                members[m] -= accepted;
+                members[m + 1] += accepted;
+            }
+        }
+        TxopShape shape{0.0, 0.0};
+        for (unsigned g = 1; g <= largest; ++g) {
+            shape.members += g * members[g];
+            shape.lengthUs += members[g] * streamUs[g];
+        }
+        shapes.push_back(shape);
+    }
+    return shapes;
+}
+
+AnalyticEstimate estimateMuMimo(const Workload& load, double peakRate, double bandwidth) {
+    const MuMimoConfig config;
+    const double peakEfficiency = peakRate / bandwidth;
+    const double sounding = (SOUNDING_BYTES + CSI_BYTES * load.users) * 8.0 / peakRate;
+    const double round = sounding + MU_MIMO_WINDOW_US;
+
+    // Mean group size and TXOP length; each member sends one packet
+    const std::vector<TxopShape> shapes = txopShapes(config, load.packetBits, bandwidth, peakEfficiency);
+    auto txop = [&](double candidates, double& members) {
+        const TxopShape& shape = shapes[static_cast<size_t>(
+            std::min<double>(std::max(candidates, 1.0), static_cast<double>(shapes.size()))) - 1];
+        members = shape.members;
+        return shape.lengthUs;
+    };
+    double group;
+    const double txopUs = txop(load.users, group);
+    const double txopsPerWindow = std::ceil(MU_MIMO_WINDOW_US / txopUs);
+    const double macPerRound = group * txopsPerWindow;
+    const double perRound = std::min(macPerRound, load.users * QUEUE_PACKETS);
+    const double capacity = perRound / round;
+
+    AnalyticEstimate estimate;
+    estimate.capacityMbps = capacity * load.packetBits;
+
+    if (load.kind == Workload::BACKLOG) {
+        // Users run out of packets at different times, so the pool the
+        // groups are chosen from shrinks: take each pool size from the full
+        // cell down to one user to carry an equal share of the packets.
+        // Airtime adds up in "TXOP time", `dataPerRound` of it per round.
+        const double packets = load.backlogPackets;
+        const double perUser = packets / load.users;
+        const double dataPerRound = txopUs * perRound / group;
+        const size_t users = static_cast<size_t>(load.users);
+        double dataUs = 0.0;
+        double meanDataUs = 0.0;
+        if (users > shapes.size()) {
+            // Every pool above the candidate limit looks the same
+            const TxopShape& shape = shapes.back();
+            const double levels = static_cast<double>(users - shapes.size());
+            dataUs = levels * perUser * shape.lengthUs / shape.members;
+            meanDataUs = levels * perUser * dataUs / 2.0;
+        }
+        for (size_t pool = std::min(users, shapes.size()); pool >= 1; --pool) {
+            const TxopShape& shape = shapes[pool - 1];
+            const double level = perUser * shape.lengthUs / shape.members;
+            meanDataUs += perUser * (dataUs + level / 2.0);
+            dataUs += level;
+        }
+        meanDataUs /= packets;
+
+        // Each round adds the sounding and the idle rest of the round;
+        // meanRounds is the rounds completed before a mean delivery
+        const double fullRounds = std::ceil(dataUs / dataPerRound) - 1.0;
+        const double rest = dataUs - fullRounds * dataPerRound;
+        const double meanRounds = (dataPerRound * fullRounds * (fullRounds - 1.0) / 2.0 + fullRounds * rest) / dataUs;
+        const double lastDelivery = fullRounds * round + sounding + rest;
+        estimate.throughputMbps = packets * load.packetBits / lastDelivery;
+        estimate.avgLatencyUs = sounding + meanDataUs + (round - dataPerRound) * meanRounds;
+        estimate.utilization = 1.0;
+        return estimate;
+    }
+    if (load.kind == Workload::SATURATED) {
+        estimateSaturated(estimate, load, capacity, load.rounds * round);
+        return estimate;
+    }
+    if (macPerRound < load.users * QUEUE_PACKETS && estimateOverload(estimate, load, capacity)) return estimate;
+
+    // Gated rounds: a packet reaching an idle cell waits only for the
+    // sounding; one arriving mid-round waits for the next round, its
+    // sounding and the TXOPs ahead of it
+    const double queued = std::min(load.arrivalRate * round, load.users * QUEUE_PACKETS);
+    double busyGroup;
+    const double busyTxop = txop(std::min(load.users, queued), busyGroup);
+    double single;
+    const double idle = sounding + txop(1.0, single);
+    const double busy = nextRoundWait(load, round) + sounding + busyTxop * (1.0 + queued / (2.0 * busyGroup));
+    const double fraction = busyFraction(load.arrivalRate, round);
+    estimate.utilization = load.arrivalRate / capacity;
+    estimateDelivered(estimate, load, capacity, (1.0 - fraction) * idle + fraction * busy);
+    return estimate;
+}
+
+// ---- WiFi6: OFDMA ----------------------------------------------------------
+
+// One window's service of a user: its RU and the packets it sends
+struct OfdmaVisit {
+    double airtimeUs;
+    double packets;
+};
+
+// RU sizing of allocateSubChannels() for `users` selected users that each
+// hold `queued` packets: demand-sized RUs, capped at an equal share
+OfdmaVisit ofdmaVisit(const RuLayout& layout, size_t users, double queued, double packetBits, double peakRate) {
+    const double bitsPerTone = peakRate * OFDMA_WINDOW_US / layout.fullBandTones;
+    const std::uint32_t share = largestRuWithin(static_cast<std::uint32_t>(layout.fullBandTones / users));
+    const std::uint32_t demand = static_cast<std::uint32_t>(
+        std::min<double>(std::ceil(queued * packetBits / bitsPerTone), share));
+
+    RuAllocator allocator(layout);
+    std::vector<int> assignments;
+    allocator.allocate(std::vector<std::uint32_t>(users, demand), assignments);
+    double tones = 0.0;
+    size_t granted = 0;
+    for (int unit : assignments) {
+        if (unit == RuAllocator::NO_RU) continue;
+        tones += layout.units[unit].tones;
+        ++granted;
+    }
+    tones = granted > 0 ? tones / granted : RU_TONES[0];
+
+    // Whole packets within the window, but always at least one
+    OfdmaVisit visit;
+    visit.airtimeUs = packetBits / (peakRate * tones / layout.fullBandTones);
+    visit.packets = std::min(queued, std::max(1.0, std::floor(OFDMA_WINDOW_US / visit.airtimeUs + 1e-9)));
+    return visit;
+}
+
+AnalyticEstimate estimateOfdma(const Workload& load, double peakRate, double bandwidth) {
+    const RuLayout& layout = ruLayoutFor(bandwidth);
+    const size_t users = static_cast<size_t>(load.users);
+    const size_t perWindow = std::min(users, layout.maxUsers());
+    const OfdmaVisit full = ofdmaVisit(layout, perWindow, QUEUE_PACKETS, load.packetBits, peakRate);
+    const double capacity = perWindow * full.packets / OFDMA_WINDOW_US;
+
+    AnalyticEstimate estimate;
+    estimate.capacityMbps = capacity * load.packetBits;
+
+    if (load.kind == Workload::BACKLOG) {
+        // Follow one user's visits as its queue drains; with more users
+        // than RUs the round robin visits it every users/perWindow windows
+        const double backlog = load.backlogPackets / load.users;
+        const double cycle = static_cast<double>(users) / perWindow;
+        double remaining = backlog;
+        double visits = 0.0;
+        double latency = 0.0;
+        double lastAirtime = 0.0;
+        while (remaining > 0.0) {
+            OfdmaVisit visit = ofdmaVisit(layout, perWindow, std::min(remaining, QUEUE_PACKETS),
+                                          load.packetBits, peakRate);
+            const double window = visits * cycle + (cycle - 1.0) / 2.0;
+            latency += visit.packets * (window * OFDMA_WINDOW_US + visit.airtimeUs * (visit.packets + 1.0) / 2.0);
+            lastAirtime = visit.packets * visit.airtimeUs;
+            remaining -= visit.packets;
+            visits += 1.0;
+        }
+        const double lastDelivery = (std::ceil(visits * users / perWindow) - 1.0) * OFDMA_WINDOW_US + lastAirtime;
+        estimate.throughputMbps = load.backlogPackets * load.packetBits / lastDelivery;
+        estimate.avgLatencyUs = latency / backlog;
+        estimate.utilization = 1.0;
+        return estimate;
+    }
+    if (load.kind == Workload::SATURATED) {
+        estimateSaturated(estimate, load, capacity, load.rounds * OFDMA_WINDOW_US);
+        return estimate;
+    }
+    if (full.packets < QUEUE_PACKETS && estimateOverload(estimate, load, capacity)) return estimate;
+
+    // Gated windows: a packet reaching an idle cell goes out at once on a
+    // demand-sized RU; one arriving mid-window waits for the next window.
+    // With more users than RUs the round robin is a polling cycle of
+    // users/perWindow windows: a user idles until its first arrival (1/a
+    // windows at a arrivals per window) and then waits out the rest of the
+    // cycle, while later arrivals wait part of it; once its queue is full
+    // the arrivals it keeps are the earliest ones.
+    const double perUser = load.arrivalRate * OFDMA_WINDOW_US / load.users;
+    const double queued = std::min(load.arrivalRate * OFDMA_WINDOW_US, load.users * QUEUE_PACKETS);
+    const double waiting = std::max(1.0, load.users * (1.0 - std::exp(-queued / load.users)));
+    const size_t served = std::min<size_t>(static_cast<size_t>(std::ceil(waiting)), layout.maxUsers());
+    const double windows = std::max(nextRoundWait(load, OFDMA_WINDOW_US) / OFDMA_WINDOW_US,
+                                    load.users / perWindow - 1.0 / perUser);
+    const double later = std::min(perUser * windows, QUEUE_PACKETS - 1.0);
+    const OfdmaVisit idle = ofdmaVisit(layout, 1, 1.0, load.packetBits, peakRate);
+    const OfdmaVisit busy = ofdmaVisit(layout, served, 1.0 + later, load.packetBits, peakRate);
+    const double fraction = busyFraction(load.arrivalRate, OFDMA_WINDOW_US);
+    const double waitUs = windows * OFDMA_WINDOW_US;
+    const double laterWaitUs = waitUs - later / 2.0 * OFDMA_WINDOW_US / perUser;
+    const double busyLatency = (waitUs + later * laterWaitUs) / (1.0 + later) +
+                               busy.airtimeUs * (busy.packets + 1.0) / 2.0;
+    estimate.utilization = load.arrivalRate / capacity;
+    estimateDelivered(estimate, load, capacity, (1.0 - fraction) * idle.airtimeUs + fraction * busyLatency);
+    return estimate;
+}
+
+} // namespace
+
+DcfSaturation solveDcfSaturation(size_t stations, std::uint32_t packetSize, double peakRateMbps,
+                                 const DcfParameters& params) {
+    const double n = static_cast<double>(std::max<size_t>(stations, 1));
+    const double slot = microseconds(params.slotTime);
+    const double airtime = packetSize * 8.0 / peakRateMbps;
+    const double success = microseconds(params.difs) + airtime + microseconds(params.sifs + params.ackDuration);
+    const double collision = success + slot;
+
+    // Per packet: stage j waits CW_j / 2 slots on average. A zero backoff
+    // (probability 1 / (CW_j + 1)) re-arms on the slot the last access
+    // used, so the frame goes out before any other counter expires and
+    // succeeds; only the other attempts contend, colliding with
+    // probability p. The packet is dropped after the last stage.
+    struct PerPacket {
+        double contended = 0.0;  // Attempts in a contended slot
+        double free = 0.0;       // Attempts right after the last access
+        double backoff = 0.0;    // Idle slots waited
+        double dropped = 0.0;    // Probability of reaching the retry limit
+    };
+    auto perPacket = [&](double p) {
+        PerPacket packet;
+        double reach = 1.0;
+        double window = params.cwMin;
+        for (unsigned stage = 0; stage <= params.retryLimit; ++stage) {
+            const double zero = 1.0 / (window + 1.0);
+            packet.contended += reach * (1.0 - zero);
+            packet.free += reach * zero;
+            packet.backoff += reach * window / 2.0;
+            reach *= (1.0 - zero) * p;
+            window = std::min(2.0 * window + 1.0, static_cast<double>(params.cwMax));
+        }
+        packet.dropped = reach;
+        return packet;
+    };
+    // tau = contended attempts / (contended attempts + backoff slots)
+    auto attemptProbability = [&](double p) {
+        const PerPacket packet = perPacket(p);
+        return packet.contended / (packet.contended + packet.backoff);
+    };
+
+    // Fixed point p = 1 - (1 - tau(p))^(n - 1); the right side falls as p
+    // grows, so bisection converges
+    double low = 0.0;
+    double high = 1.0;
+    for (int step = 0; step < 50; ++step) {
+        double p = (low + high) / 2.0;
+        if (1.0 - std::pow(1.0 - attemptProbability(p), n - 1.0) > p) {
+            low = p;
+        } else {
+            high = p;
+        }
+    }
+
+    DcfSaturation result;
+    result.collisionProbability = (low + high) / 2.0;
+    const PerPacket packet = perPacket(result.collisionProbability);
+    result.attemptProbability = attemptProbability(result.collisionProbability);
+    result.dropProbability = packet.dropped;
+    const double tau = result.attemptProbability;
+    const double transmit = 1.0 - std::pow(1.0 - tau, n);
+    const double succeed = n * tau * std::pow(1.0 - tau, n - 1.0) / transmit;
+    // Free attempts per contended slot, each a success of its own
+    const double free = n * tau * packet.free / packet.contended;
+    const double slotLength = (1.0 - transmit) * slot + transmit * succeed * success +
+                              transmit * (1.0 - succeed) * collision + free * success;
+    result.throughputMbps = (transmit * succeed + free) * packetSize * 8.0 / slotLength;
+    result.accessDurationUs = slotLength / (transmit + free);
+    return result;
+}
+
+AnalyticEstimate estimatePerformance(WiFiStandard standard, size_t userCount,
+                                     const PhyConfig& phy, const TrafficConfig& traffic,
+                                     int iterations) {
+    if (phy.channelWidth <= 0.0 || phy.modulationOrder < 2 ||
+        phy.codingRate <= 0.0 || phy.codingRate > 1.0) {
+        throw WiFiSimulationException("Invalid PHY configuration");
+    }
+    if (traffic.packetSize == 0) throw WiFiSimulationException("Invalid traffic configuration");
+    if (userCount == 0) return AnalyticEstimate();
+
+    // Same peak rate as AccessPoint::calculateMaxThroughput()
+    const double peakRate = phy.channelWidth * std::log2(phy.modulationOrder) * phy.codingRate;
+
+    Workload load;
+    load.kind = traffic.model == TrafficModel::BACKLOG   ? Workload::BACKLOG
+              : traffic.model == TrafficModel::SATURATED ? Workload::SATURATED
+                                                         : Workload::ARRIVALS;
+    load.users = static_cast<double>(userCount);
+    load.packetBits = traffic.packetSize * 8.0;
+    load.backlogPackets = load.users * traffic.backlogPackets;
+    load.rounds = std::max(iterations, 0);
+    load.arrivalRate = stationArrivalRate(traffic) * load.users;
+    load.durationUs = microseconds(traffic.duration);
+    if (load.kind == Workload::BACKLOG && !(load.backlogPackets > 0.0)) return AnalyticEstimate();
+    if (load.kind == Workload::ARRIVALS && !(load.arrivalRate > 0.0 && load.durationUs > 0.0)) {
+        return AnalyticEstimate();
+    }
+
+    switch (standard) {
+    case WiFiStandard::WIFI4:
+        return estimateDcf(load, peakRate);
+    case WiFiStandard::WIFI5:
+        return estimateMuMimo(load, peakRate, phy.channelWidth);
+    case WiFiStandard::WIFI6:
+        return estimateOfdma(load, peakRate, phy.channelWidth);
+    }
+    throw WiFiSimulationException("Unknown WiFi standard");
+}
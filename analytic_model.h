@@ -0,0 +1,50 @@
+#ifndef ANALYTIC_MODEL_H
+#define ANALYTIC_MODEL_H
+
+#include "WiFiSimulation.h"
+#include "traffic.h"
+#include "dcf.h"
+#include "mu_mimo.h"
+
+// Closed-form estimates of what the event simulation of a configuration
+// would measure, in microseconds of host time instead of seconds, so a
+// sweep can rule points out before simulating them. Stations are assumed
+// symmetric (same link, same traffic) and the MAC parameters are the
+// simulator's defaults:
+//   WiFi4  Bianchi's fixed point for saturated DCF with a retry limit;
+//          a backlog drains as the stations holding packets thin out
+//   WiFi5  sounding plus a window of zero-forcing MU-MIMO TXOPs; group size
+//          from the greedy correlation test, rate from the ZF SINR of the
+//          weakest member
+//   WiFi6  OFDMA windows with the simulator's RU sizing, on the real layout
+// Backlogged and saturated runs follow from the cell's capacity; arrival
+// models add queueing delay (M/G/1 for DCF, gated rounds for MU-MIMO and
+// OFDMA) and saturate at the capacity. Replayed traffic is not modelled.
+struct AnalyticEstimate {
+    double throughputMbps = 0.0;   // Delivered bits over elapsed time, as collectMetrics() reports it
+    double avgLatencyUs = 0.0;     // Mean enqueue-to-delivery latency
+    double capacityMbps = 0.0;     // Saturation throughput of the cell
+    double utilization = 0.0;      // Offered load over capacity; 1 when backlogged or saturated
+    double collisionProbability = 0.0;  // WiFi4: probability an attempt collides
+};
+
+// Estimate a run of `standard` with `userCount` stations. `iterations`
+// bounds the run as WiFiSimulation::setMaxIterations() does (0 = until the
+// traffic ends); it matters for saturated traffic only.
+AnalyticEstimate estimatePerformance(WiFiStandard standard, size_t userCount,
+                                     const PhyConfig& phy, const TrafficConfig& traffic,
+                                     int iterations);
+
+// Saturation throughput of a DCF cell with `stations` always-backlogged
+// stations sending `packetSize`-byte frames at `peakRateMbps` (Bianchi)
+struct DcfSaturation {
+    double throughputMbps = 0.0;        // Delivered; frames dropped at the retry limit excluded
+    double attemptProbability = 0.0;    // tau: per-slot transmission probability of a station
+    double collisionProbability = 0.0;  // p: an attempt meets another transmission
+    double dropProbability = 0.0;       // A packet reaches the retry limit and is dropped
+    double accessDurationUs = 0.0;      // Mean time between channel accesses
+};
+DcfSaturation solveDcfSaturation(size_t stations, std::uint32_t packetSize, double peakRateMbps,
+                                 const DcfParameters& params = DcfParameters());
+
+#endif // ANALYTIC_MODEL_H
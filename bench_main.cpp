@@ -0,0 +1,271 @@
+#include "simulation_factory.h"
+#include "simulation_snapshot.h"
+#include "profiler.h"
+#include "wifi6_simulation.h"
+#include "spatial_index.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <new>
+
+// Count every heap allocation made by the benchmark and the library
+static std::atomic<std::uint64_t> g_allocations(0);
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    profiler::noteAllocation();
+    if (void* p = std::malloc(size > 0 ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+struct BenchResult {
+    std::string name;
+    size_t users = 0;
+    std::uint64_t packets = 0;     // Simulated packets (or per-station units) processed
+    double wallNs = 0.0;
+    std::uint64_t allocations = 0;
+
+    double nsPerPacket() const { return packets ? wallNs / packets : 0.0; }
+    double packetsPerSecond() const { return wallNs > 0.0 ? packets * 1e9 / wallNs : 0.0; }
+    double allocationsPerPacket() const { return packets ? static_cast<double>(allocations) / packets : 0.0; }
+};
+
+// Time `body`, which returns the number of packets it processed
+static BenchResult measure(const std::string& name, size_t users,
+                           const std::function<std::uint64_t()>& body) {
+    BenchResult result;
+    result.name = name;
+    result.users = users;
+
+    std::uint64_t allocationsBefore = g_allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    result.packets = body();
+    auto end = std::chrono::steady_clock::now();
+    result.allocations = g_allocations.load() - allocationsBefore;
+    result.wallNs = std::chrono::duration<double, std::nano>(end - start).count();
+    return result;
+}
+
+// Station table with `packetsPerUser` queued 1 KB packets per station
+static void fillStations(StationTable& stations, size_t users, int packetsPerUser) {
+    stations.addStations(users);
+    stations.reservePackets(users * packetsPerUser);
+    PacketDescriptor packet;
+    for (StationId station = 0; station < users; ++station) {
+        packet.flowId = station;
+        for (int j = 0; j < packetsPerUser; ++j) {
+            stations.enqueue(station, packet);
+        }
+    }
+}
+
+// Repeat count so per-station benchmarks touch ~1M stations in total
+static size_t repeatsFor(size_t users) {
+    const size_t TARGET = 1000000;
+    return users >= TARGET ? 1 : TARGET / users;
+}
+
+static std::vector<BenchResult> runBenchmarks(size_t users) {
+    const int PACKETS_PER_USER = 10;
+    std::vector<BenchResult> results;
+
+    // End-to-end simulation of each standard (setup excluded)
+    for (WiFiStandard standard : {WiFiStandard::WIFI4, WiFiStandard::WIFI5, WiFiStandard::WIFI6}) {
+        auto simulation = createSimulation(standard, users);
+        simulation->setMaxIterations(getDefaultIterations(standard));
+        results.push_back(measure(std::string("simulate/") + toString(standard), users, [&]() -> std::uint64_t {
+            simulation->runSimulation();
+            return simulation->collectMetrics().deliveredPackets;
+        }));
+    }
+
+    // The same WiFi4 run with the binary event trace on (compare with simulate/WiFi4)
+    {
+        const char* TRACE_PATH = "bench_trace.bin";
+        auto simulation = createSimulation(WiFiStandard::WIFI4, users);
+        simulation->setMaxIterations(getDefaultIterations(WiFiStandard::WIFI4));
+        {
+            TraceWriter trace(TRACE_PATH);
+            simulation->getStations().setTraceWriter(&trace);
+            results.push_back(measure("simulate/WiFi4 traced", users, [&]() -> std::uint64_t {
+                simulation->runSimulation();
+                trace.close();
+                return simulation->collectMetrics().deliveredPackets;
+            }));
+            simulation->getStations().setTraceWriter(nullptr);
+        }
+        std::remove(TRACE_PATH);
+    }
+
+    // Forking a warmed-up WiFi4 run (one unit per station per fork)
+    {
+        auto simulation = createSimulation(WiFiStandard::WIFI4, users);
+        simulation->setMaxIterations(getDefaultIterations(WiFiStandard::WIFI4));
+        simulation->runUntil(std::chrono::milliseconds(10));
+        SimulationSnapshot snapshot(*simulation);
+        size_t repeats = std::max<size_t>(1, repeatsFor(users) / 100);
+        results.push_back(measure("SimulationSnapshot::fork", users, [&]() -> std::uint64_t {
+            for (size_t i = 0; i < repeats; ++i) {
+                snapshot.fork();
+            }
+            return static_cast<std::uint64_t>(repeats) * users;
+        }));
+    }
+
+    // DcfContention::access over ~1M transmission attempts (collisions included)
+    {
+        StationTable stations;
+        fillStations(stations, users, PACKETS_PER_USER);
+        AccessPoint accessPoint("AP1");
+        DcfContention dcf;
+        dcf.resize(users);
+        results.push_back(measure("DcfContention::access", users, [&]() -> std::uint64_t {
+            const std::uint64_t ATTEMPTS = 1000000;
+            for (StationId station = 0; station < users; ++station) {
+                dcf.activate(station);
+            }
+            std::uint64_t attempts = 0;
+            SimTime now = SimTime::zero();
+            while (attempts < ATTEMPTS && dcf.hasContenders()) {
+                DcfAccess access = dcf.access(stations, accessPoint, now);
+                attempts += access.transmitters;
+                now = access.end;
+            }
+            return attempts;
+        }));
+    }
+
+    // User::getNextPacket through the station view
+    {
+        StationTable stations;
+        fillStations(stations, users, PACKETS_PER_USER);
+        results.push_back(measure("User::getNextPacket", users, [&]() -> std::uint64_t {
+            std::uint64_t popped = 0;
+            std::uint64_t bytes = 0;
+            for (StationId station = 0; station < users; ++station) {
+                User user = stations.getUser(station);
+                while (user.hasPackets()) {
+                    bytes += user.getNextPacket().sizeBytes;
+                    ++popped;
+                }
+            }
+            return bytes > 0 ? popped : 0;
+        }));
+    }
+
+    // Per-station sounding (one unit per station per call)
+    {
+        StationTable stations;
+        fillStations(stations, users, 0);
+        WiFi5AccessPoint accessPoint("AP1");
+        size_t repeats = repeatsFor(users);
+        results.push_back(measure("WiFi5AccessPoint::collectChannelStateInfo", users, [&]() -> std::uint64_t {
+            SimTime now = SimTime::zero();
+            for (size_t i = 0; i < repeats; ++i) {
+                now = accessPoint.collectChannelStateInfo(stations, now);
+            }
+            return static_cast<std::uint64_t>(repeats) * users;
+        }));
+    }
+
+    // RU allocation among all-backlogged users (one unit per window)
+    {
+        StationTable stations;
+        fillStations(stations, users, 1);
+        WiFi6AccessPoint accessPoint("AP1");
+        accessPoint.initializeSubChannels();
+        for (StationId station = 0; station < users; ++station) {
+            accessPoint.activateUser(stations, station);
+        }
+        const size_t WINDOWS = 1000000;
+        results.push_back(measure("WiFi6AccessPoint::allocateSubChannels", users, [&]() -> std::uint64_t {
+            for (size_t i = 0; i < WINDOWS; ++i) {
+                accessPoint.allocateSubChannels(stations);
+            }
+            return WINDOWS;
+        }));
+    }
+
+    // WiFi6AccessPoint::performOFDMA until every queue is empty
+    {
+        StationTable stations;
+        fillStations(stations, users, PACKETS_PER_USER);
+        WiFi6AccessPoint accessPoint("AP1");
+        for (StationId station = 0; station < users; ++station) {
+            accessPoint.activateUser(stations, station);
+        }
+        results.push_back(measure("WiFi6AccessPoint::performOFDMA", users, [&]() -> std::uint64_t {
+            size_t queued = stations.getQueuedPackets();
+            SimTime now = SimTime::zero();
+            while (stations.getQueuedPackets() > 0) {
+                now = std::max(accessPoint.performOFDMA(stations, now), now + accessPoint.getOFDMADuration());
+            }
+            return queued;
+        }));
+    }
+
+    // Carrier-sense range query around every station (one station per 25 m^2)
+    {
+        SpatialGrid grid;
+        const double side = std::sqrt(static_cast<double>(users)) * 5.0;
+        const double RANGE = 30.0;
+        grid.reset({0.0, 0.0}, {side, side}, RANGE);
+        std::mt19937 generator(1);
+        std::uniform_real_distribution<> coordinate(0.0, side);
+        for (size_t i = 0; i < users; ++i) grid.insert({coordinate(generator), coordinate(generator)});
+        results.push_back(measure("SpatialGrid::forEachWithin", users, [&]() -> std::uint64_t {
+            std::uint64_t neighbours = 0;
+            for (std::uint32_t entry = 0; entry < users; ++entry) {
+                grid.forEachWithin(grid.getPosition(entry), RANGE, [&neighbours](std::uint32_t, double) { ++neighbours; });
+            }
+            return neighbours > 0 ? users : 0;
+        }));
+    }
+    return results;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        // Usage: wifi_bench [output file] [max users]
+        std::string outputPath = argc > 1 ? argv[1] : "bench_output.txt";
+        size_t maxUsers = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000;
+
+        std::ofstream output(outputPath);
+        if (!output) {
+            throw WiFiSimulationException("Cannot open " + outputPath);
+        }
+        output << "benchmark\tusers\tpackets\tns_per_packet\tpackets_per_sec\tallocs_per_packet\n";
+
+        std::cout << std::left << std::setw(44) << "Benchmark" << std::setw(10) << "Users"
+                  << std::setw(14) << "ns/packet" << std::setw(16) << "packets/sec"
+                  << "allocs/packet\n";
+        for (size_t users : {1, 100, 10000, 1000000}) {
+            if (users > maxUsers) break;
+            for (const BenchResult& result : runBenchmarks(users)) {
+                std::cout << std::setw(44) << result.name << std::setw(10) << result.users
+                          << std::setw(14) << result.nsPerPacket()
+                          << std::setw(16) << result.packetsPerSecond()
+                          << result.allocationsPerPacket() << "\n";
+                output << result.name << '\t' << result.users << '\t' << result.packets << '\t'
+                       << result.nsPerPacket() << '\t' << result.packetsPerSecond() << '\t'
+                       << result.allocationsPerPacket() << '\n';
+            }
+        }
+        std::cout << "\nResults written to " << outputPath << "\n";
+        return 0;
+    }
+    catch (const WiFiSimulationException& e) {
+        std::cerr << "Simulation Error: " << e.what() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Unexpected Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef COMMAND_LINE_H
+#define COMMAND_LINE_H
+
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+// Argument parsing for the command-line tools. Each parser accepts only a
+// whole argument in range and leaves `value` untouched otherwise, so a typo
+// becomes a usage error instead of a silent zero.
+
+// Unsigned decimal integer; no sign, no trailing characters
+inline bool parseUnsigned(const char* text, std::uint64_t& value) {
+    if (*text < '0' || *text > '9') return false;
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long parsed = std::strtoull(text, &end, 10);
+    if (errno == ERANGE || *end != '\0') return false;
+    value = parsed;
+    return true;
+}
+
+// Positive count (users, replications, ...)
+inline bool parseCount(const char* text, size_t& value) {
+    std::uint64_t parsed = 0;
+    if (!parseUnsigned(text, parsed) || parsed == 0 || parsed > SIZE_MAX) return false;
+    value = static_cast<size_t>(parsed);
+    return true;
+}
+
+// Finite decimal number
+inline bool parseNumber(const char* text, double& value) {
+    char* end = nullptr;
+    errno = 0;
+    double parsed = std::strtod(text, &end);
+    if (end == text || *end != '\0' || errno == ERANGE || !std::isfinite(parsed)) return false;
+    value = parsed;
+    return true;
+}
+
+#endif // COMMAND_LINE_H
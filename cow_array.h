@@ -0,0 +1,123 @@
+#ifndef COW_ARRAY_H
+#define COW_ARRAY_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Array whose copies share their elements until one of them writes (copy
+// on write). A copy marks both arrays shared; the first mutable access of
+// a shared array copies the elements once, unless it turns out to be the
+// last holder. Reads through a const array never copy. Copying the same
+// array from several threads at once is safe; writing one while it is
+// being copied is not.
+template <typename T>
+class CowArray {
+private:
+    std::shared_ptr<std::vector<T>> m_storage;
+    T* m_begin;
+    size_t m_size;
+    mutable std::atomic<bool> m_shared;
+
+    void attach() {
+        m_begin = m_storage->data();
+        m_size = m_storage->size();
+    }
+
+    void detach() {
+        if (m_storage.use_count() > 1) {
+            m_storage = std::make_shared<std::vector<T>>(*m_storage);
+            attach();
+        }
+        m_shared.store(false, std::memory_order_relaxed);
+    }
+
+    void prepareWrite() {
+        if (m_shared.load(std::memory_order_relaxed)) detach();
+    }
+
+    std::vector<T>& writable() {
+        prepareWrite();
+        return *m_storage;
+    }
+
+public:
+    CowArray() : m_storage(std::make_shared<std::vector<T>>()), m_begin(nullptr), m_size(0), m_shared(false) {}
+
+    CowArray(const CowArray& other)
+        : m_storage(other.m_storage), m_begin(other.m_begin), m_size(other.m_size), m_shared(true) {
+        other.m_shared.store(true, std::memory_order_relaxed);
+    }
+
+    CowArray(CowArray&& other) noexcept
+        : m_storage(std::move(other.m_storage)), m_begin(other.m_begin), m_size(other.m_size),
+          m_shared(other.m_shared.load(std::memory_order_relaxed)) {
+        other.m_storage = std::make_shared<std::vector<T>>();
+        other.attach();
+        other.m_shared.store(false, std::memory_order_relaxed);
+    }
+
+    CowArray& operator=(const CowArray& other) {
+        if (this != &other) {
+            m_storage = other.m_storage;
+            attach();
+            m_shared.store(true, std::memory_order_relaxed);
+            other.m_shared.store(true, std::memory_order_relaxed);
+        }
+        return *this;
+    }
+
+    CowArray& operator=(CowArray&& other) noexcept {
+        if (this != &other) {
+            m_storage = std::move(other.m_storage);
+            attach();
+            m_shared.store(other.m_shared.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            other.m_storage = std::make_shared<std::vector<T>>();
+            other.attach();
+            other.m_shared.store(false, std::memory_order_relaxed);
+        }
+        return *this;
+    }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    const T& operator[](size_t index) const { return m_begin[index]; }
+    T& operator[](size_t index) {
+        prepareWrite();
+        return m_begin[index];
+    }
+
+    const T* data() const { return m_begin; }
+    T* data() {
+        prepareWrite();
+        return m_begin;
+    }
+    const T* begin() const { return m_begin; }
+    const T* end() const { return m_begin + m_size; }
+    T* begin() { return data(); }
+    T* end() { return data() + m_size; }
+
+    void resize(size_t count, const T& value = T()) {
+        writable().resize(count, value);
+        attach();
+    }
+    void assign(size_t count, const T& value) {
+        writable().assign(count, value);
+        attach();
+    }
+    void clear() {
+        writable().clear();
+        attach();
+    }
+    void shrink_to_fit() {
+        writable().shrink_to_fit();
+        attach();
+    }
+
+    // True while the elements may be referenced by another array
+    bool isShared() const { return m_shared.load(std::memory_order_relaxed) && m_storage.use_count() > 1; }
+};
+
+#endif // COW_ARRAY_H
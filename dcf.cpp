@@ -0,0 +1,136 @@
+#include "dcf.h"
+#include "WiFiSimulation.h"
+#include "profiler.h"
+#include "snapshot.h"
+#include <algorithm>
+
+DcfContention::DcfContention(const DcfParameters& params, std::uint64_t seed)
+    : m_params(params),
+      m_successes(0),
+      m_collisions(0),
+      m_retryDrops(0) {
+    if (params.cwMin == 0 || params.cwMax < params.cwMin) {
+        throw WiFiSimulationException("Invalid DCF parameters");
+    }
+    seedGenerator(m_generator, seed);
+}
+
+void DcfContention::resize(size_t stations) {
+    if (stations < m_contentionWindow.size() && hasContenders()) {
+        throw WiFiSimulationException("Cannot remove DCF stations while stations contend");
+    }
+    m_contentionWindow.resize(stations, m_params.cwMin);
+    m_retries.resize(stations, 0);
+    m_backoff.resize(stations);
+}
+
+void DcfContention::drawBackoff(StationId station) {
+    std::uniform_int_distribution<std::uint32_t> slots(0, m_contentionWindow[station]);
+    m_backoff.arm(station, m_backoff.now() + slots(m_generator));
+}
+
+void DcfContention::activate(StationId station) {
+    if (m_backoff.isArmed(station)) return;
+    drawBackoff(station);
+}
+
+DcfAccess DcfContention::contend(SimTime idleSince) {
+    DcfAccess result;
+    result.start = idleSince;
+    result.end = idleSince;
+
+    // Skip the idle slots up to the earliest expiry in one step
+    std::uint64_t idleFrom = m_backoff.now();
+    m_winners.clear();
+    if (!m_backoff.expireNext(m_winners)) return result;
+    result.start = idleSince + m_params.difs + m_params.slotTime * (m_backoff.now() - idleFrom);
+    result.transmitters = m_winners.size();
+    if (m_winners.size() == 1) {
+        ++m_successes;
+    } else {
+        ++m_collisions;
+    }
+    return result;
+}
+
+bool DcfContention::finish(StationId contender, bool collided) {
+    if (collided && m_retries[contender] < m_params.retryLimit) {
+        ++m_retries[contender];
+        m_contentionWindow[contender] = static_cast<std::uint16_t>(
+            std::min<std::uint32_t>(2u * m_contentionWindow[contender] + 1, m_params.cwMax));
+        return false;
+    }
+    m_contentionWindow[contender] = m_params.cwMin;
+    m_retries[contender] = 0;
+    if (collided) ++m_retryDrops;
+    return collided;
+}
+
+DcfAccess DcfContention::access(StationTable& stations, const AccessPoint& accessPoint,
+                                SimTime idleSince) {
+    PROFILE_SCOPE("DcfContention::access");
+    DcfAccess result = contend(idleSince);
+    if (result.transmitters == 0) return result;
+
+    if (m_winners.size() == 1) {
+        // Success: data, SIFS, ACK
+        StationId station = m_winners.front();
+        PacketDescriptor packet;
+        stations.tryDequeue(station, packet);
+        stations.trace(TraceEventType::TX_START, station, result.start, packet.sizeBytes);
+        SimTime delivered = result.start + accessPoint.getTransmissionDuration(stations, station, packet.sizeBytes);
+        stations.recordDelivery(station, packet, delivered);
+        stations.admitBacklog(station, result.start);
+        result.end = delivered + m_params.sifs + m_params.ackDuration;
+        finish(station, false);
+    } else {
+        // Collision: the medium stays busy for the longest frame plus the ACK timeout
+        SimTime longest = SimTime::zero();
+        for (StationId station : m_winners) {
+            stations.trace(TraceEventType::COLLISION, station, result.start, stations.peekPacket(station).sizeBytes);
+            longest = std::max(longest, accessPoint.getTransmissionDuration(
+                stations, station, stations.peekPacket(station).sizeBytes));
+        }
+        result.end = result.start + longest + m_params.sifs + m_params.ackDuration + m_params.slotTime;
+
+        for (StationId station : m_winners) {
+            if (finish(station, true)) {
+                stations.dropHead(station, result.start);
+                stations.admitBacklog(station, result.start);
+            }
+        }
+    }
+
+    // Winners with more to send draw a fresh backoff; the rest leave contention
+    for (StationId station : m_winners) {
+        if (stations.hasPackets(station)) {
+            activate(station);
+        }
+    }
+    return result;
+}
+
+void DcfContention::saveState(SnapshotWriter& out) const {
+    out.put(m_params);
+    out.putGenerator(m_generator);
+    out.putVector(m_contentionWindow);
+    out.putVector(m_retries);
+    m_backoff.saveState(out);
+    out.put(m_successes);
+    out.put(m_collisions);
+    out.put(m_retryDrops);
+}
+
+void DcfContention::loadState(SnapshotReader& in) {
+    in.get(m_params);
+    in.getGenerator(m_generator);
+    in.getVector(m_contentionWindow);
+    in.getVector(m_retries);
+    m_backoff.loadState(in);
+    in.get(m_successes);
+    in.get(m_collisions);
+    in.get(m_retryDrops);
+    if (m_retries.size() != m_contentionWindow.size() || m_backoff.size() != m_contentionWindow.size()) {
+        throw WiFiSimulationException("Corrupt DCF state in simulation snapshot");
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef DCF_H
+#define DCF_H
+
+#include <random>
+#include <vector>
+
+#include "station_table.h"
+#include "random_streams.h"
+#include "timing_wheel.h"
+
+class AccessPoint;
+class SnapshotWriter;
+class SnapshotReader;
+
+// 802.11 DCF timing and backoff parameters (OFDM PHY defaults)
+struct DcfParameters {
+    SimTime slotTime = std::chrono::microseconds(9);
+    SimTime sifs = std::chrono::microseconds(16);
+    SimTime difs = std::chrono::microseconds(34);         // SIFS + 2 slots
+    SimTime ackDuration = std::chrono::microseconds(44);  // ACK at the basic rate, with preamble
+    std::uint16_t cwMin = 15;
+    std::uint16_t cwMax = 1023;
+    std::uint8_t retryLimit = 7;  // Attempts after the first before the packet is dropped
+};
+
+// Outcome of one channel access
+struct DcfAccess {
+    SimTime start = SimTime::zero();  // First frame on the air
+    SimTime end = SimTime::zero();    // Medium idle again (after the ACK or ACK timeout)
+    size_t transmitters = 0;          // 0 = nobody contending, 1 = success, >1 = collision
+};
+
+// Distributed coordination function shared by every backlogged station of a
+// table. Backoff counters are timers on a wheel whose clock counts only
+// idle backoff slots: counters freeze while the medium is busy simply
+// because the clock does not move. Each access jumps straight to the
+// earliest expiry, so arming a backoff is O(1) and no work is done per
+// idle slot. Stations expiring on the same slot collide; each doubles its
+// contention window and retries, up to the retry limit.
+class DcfContention {
+private:
+    DcfParameters m_params;
+    std::mt19937 m_generator;
+
+    // Per-station contention state
+    std::vector<std::uint16_t> m_contentionWindow;
+    std::vector<std::uint8_t> m_retries;
+    TimingWheel m_backoff;             // One timer per contending station, in idle slots
+    std::vector<StationId> m_winners;  // Scratch space reused by every access
+
+    std::uint64_t m_successes;
+    std::uint64_t m_collisions;
+    std::uint64_t m_retryDrops;
+
+    void drawBackoff(StationId station);
+
+public:
+    explicit DcfContention(const DcfParameters& params = DcfParameters(),
+                           std::uint64_t seed = DEFAULT_SIMULATION_SEED);
+
+    // Size the per-station state. Stations may be added at any time;
+    // removing them is only allowed while nobody is contending.
+    void resize(size_t stations);
+
+    // Start contending for a station that just became backlogged (no-op if it already is)
+    void activate(StationId station);
+
+    size_t size() const { return m_contentionWindow.size(); }
+    bool hasContenders() const { return !m_backoff.empty(); }
+
+    // Resolve the next access on a medium that is idle from `idleSince`:
+    // deliver the winner's head packet, or collide every station whose
+    // backoff expires on the same slot
+    DcfAccess access(StationTable& stations, const AccessPoint& accessPoint, SimTime idleSince);
+
+    // The two halves of access() for a medium whose contenders are not the
+    // stations of one table (e.g. co-channel access points). contend()
+    // skips to the next expiry and fills in start and transmitters (end is
+    // left to the caller); the contenders are getWinners(). The caller
+    // then finish()es each winner, which resets its window on success or
+    // doubles it on a collision, and activate()s those with more to send.
+    DcfAccess contend(SimTime idleSince);
+    const std::vector<StationId>& getWinners() const { return m_winners; }
+
+    // Returns true if the frame reached the retry limit and must be dropped
+    bool finish(StationId contender, bool collided);
+
+    const DcfParameters& getParameters() const { return m_params; }
+    std::uint16_t getContentionWindow(StationId station) const { return m_contentionWindow[station]; }
+    std::uint64_t getSuccesses() const { return m_successes; }
+    std::uint64_t getCollisions() const { return m_collisions; }
+    std::uint64_t getRetryDrops() const { return m_retryDrops; }
+
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+};
+
+#endif // DCF_H
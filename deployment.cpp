@@ -0,0 +1,491 @@
+#include "deployment.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+// Shared medium of one interference domain: its access points contend for
+// the channel with DCF on one backoff wheel, each serving its backlogged
+// stations round robin. Access points whose backoffs expire on the same
+// slot collide, double their contention windows and retry the same frame,
+// which is dropped at the retry limit.
+class MediumDomain : public EventHandler {
+private:
+    Deployment& m_deployment;
+    const std::vector<size_t>& m_members;
+    EventScheduler m_scheduler;
+    std::uint16_t m_handlerId;
+    DcfContention m_dcf;               // Contender = member index within the domain
+    std::vector<StationId> m_cursor;   // Round-robin position per member cell
+    std::vector<StationId> m_frame;    // Station whose frame a member is retrying, or NO_STATION
+    std::vector<StationId> m_transmitters;  // Winners of the current access with a frame to send
+    bool m_idle;                       // No contender and no access pending
+
+    enum EventType : std::uint16_t {
+        MEDIUM_IDLE = 0  // The medium is idle from event.time
+    };
+
+    StationId nextBackloggedStation(Cell& cell, std::uint32_t member) {
+        StationId station = cell.stations.nextBacklogged(m_cursor[member]);
+        if (station == NO_STATION) {
+            station = cell.stations.nextBacklogged(0);
+        }
+        m_cursor[member] = station + 1;
+        return station;
+    }
+
+    // Station a winning member transmits to: the frame it is retrying, or
+    // the next backlogged one (NO_STATION if a handoff emptied the cell)
+    StationId frameOf(Cell& cell, std::uint32_t member) {
+        StationId station = m_frame[member];
+        if (station == NO_STATION || !cell.stations.hasPackets(station)) {
+            station = cell.stations.getQueuedPackets() > 0 ? nextBackloggedStation(cell, member) : NO_STATION;
+        }
+        m_frame[member] = station;
+        return station;
+    }
+
+    // Contend for every member with packets; schedule an access if the medium was left idle
+    void wake(SimTime now) {
+        for (std::uint32_t member = 0; member < m_members.size(); ++member) {
+            if (m_deployment.getCell(m_members[member]).stations.getQueuedPackets() > 0) m_dcf.activate(member);
+        }
+        if (m_idle && m_dcf.hasContenders()) {
+            m_idle = false;
+            m_scheduler.schedule(now, m_handlerId, MEDIUM_IDLE, 0);
+        }
+    }
+
+public:
+    MediumDomain(Deployment& deployment, const std::vector<size_t>& members,
+                 const DcfParameters& params, std::uint64_t seed)
+        : m_deployment(deployment),
+          m_members(members),
+          m_handlerId(m_scheduler.registerHandler(this)),
+          m_dcf(params, seed),
+          m_cursor(members.size(), 0),
+          m_frame(members.size(), NO_STATION),
+          m_idle(true) {
+        m_dcf.resize(members.size());
+    }
+
+    void start() { wake(SimTime::zero()); }
+
+    void run() {
+        start();
+        m_scheduler.run();
+    }
+
+    // Run up to `endTime`, first waking cells that gained stations by handoff
+    void runUntil(SimTime endTime) {
+        wake(m_scheduler.now());
+        m_scheduler.runUntil(endTime);
+    }
+
+    void handleEvent(const SimulationEvent& event) override {
+        if (event.type != MEDIUM_IDLE) return;
+
+        DcfAccess access = m_dcf.contend(event.time);
+        if (access.transmitters == 0) {
+            m_idle = true;
+            return;
+        }
+
+        // Winners whose cell a handoff emptied send nothing
+        m_transmitters.clear();
+        for (StationId member : m_dcf.getWinners()) {
+            if (frameOf(m_deployment.getCell(m_members[member]), member) != NO_STATION) {
+                m_transmitters.push_back(member);
+            } else {
+                m_dcf.finish(member, false);
+            }
+        }
+
+        const DcfParameters& params = m_dcf.getParameters();
+        const bool collided = m_transmitters.size() > 1;
+        SimTime longest = SimTime::zero();
+        SimTime end = access.start;
+        for (StationId member : m_transmitters) {
+            Cell& cell = m_deployment.getCell(m_members[member]);
+            StationId station = m_frame[member];
+            std::uint32_t size = cell.stations.peekPacket(station).sizeBytes;
+            SimTime airtime = cell.accessPoint.getTransmissionDuration(cell.stations, station, size);
+            longest = std::max(longest, airtime);
+
+            if (!collided) {
+                // Data, SIFS, ACK
+                PacketDescriptor packet;
+                cell.stations.tryDequeue(station, packet);
+                cell.stations.trace(TraceEventType::TX_START, station, access.start, packet.sizeBytes);
+                cell.stations.recordDelivery(station, packet, access.start + airtime);
+                cell.stations.admitBacklog(station, access.start);
+                m_frame[member] = NO_STATION;
+                m_dcf.finish(member, false);
+                end = access.start + airtime + params.sifs + params.ackDuration;
+            } else {
+                cell.stations.trace(TraceEventType::COLLISION, station, access.start, size);
+                ++cell.collisions;
+                if (m_dcf.finish(member, true)) {
+                    cell.stations.dropHead(station, access.start);
+                    cell.stations.admitBacklog(station, access.start);
+                    m_frame[member] = NO_STATION;
+                }
+            }
+        }
+        if (collided) {
+            // The medium stays busy for the longest frame plus the ACK timeout
+            end = access.start + longest + params.sifs + params.ackDuration + params.slotTime;
+        }
+
+        for (StationId member : m_dcf.getWinners()) {
+            Cell& cell = m_deployment.getCell(m_members[member]);
+            cell.accessPoint.getChannel().occupy(end);
+            if (cell.stations.getQueuedPackets() > 0) m_dcf.activate(member);
+        }
+        m_scheduler.schedule(end, m_handlerId, MEDIUM_IDLE, 0);
+    }
+};
+
+size_t findRoot(std::vector<size_t>& parent, size_t index) {
+    while (parent[index] != index) {
+        parent[index] = parent[parent[index]];
+        index = parent[index];
+    }
+    return index;
+}
+
+} // namespace
+
+Deployment::Deployment(const DeploymentConfig& config, std::uint64_t seed)
+    : m_config(config),
+      m_seed(seed),
+      m_mobilityHandler(*this),
+      m_mobilityHandlerId(m_mobilityEvents.registerHandler(&m_mobilityHandler)),
+      m_mobilityUpdates(0),
+      m_handoffs(0) {
+    if (config.accessPoints == 0 || config.channels <= 0 || config.apSpacing <= 0.0 ||
+        config.interferenceRange < 0.0 || config.packetsPerStation < 0 ||
+        config.mobilityEpoch <= SimTime::zero()) {
+        throw WiFiSimulationException("Invalid deployment configuration");
+    }
+
+    placeAccessPoints();
+    associateStations();
+    buildInterferenceDomains();
+    selectRates();
+}
+
+void Deployment::placeAccessPoints() {
+    // Square grid; channel (column + 2 * row) mod channels keeps direct
+    // neighbours on different channels when at least three are available
+    size_t columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(m_config.accessPoints))));
+    LinkConfig link = m_config.link;
+    link.maxWidthMHz = m_config.phy.channelWidth;
+    m_cells.reserve(m_config.accessPoints);
+    for (size_t index = 0; index < m_config.accessPoints; ++index) {
+        size_t row = index / columns;
+        size_t column = index % columns;
+        int channel = static_cast<int>((column + 2 * row) % m_config.channels);
+
+        auto cell = std::make_unique<Cell>("AP" + std::to_string(index + 1),
+                                           deriveStreamSeed(m_seed, 1 + index), m_config.phy, link, channel);
+        cell->accessPoint.setPosition({(column + 0.5) * m_config.apSpacing,
+                                       (row + 0.5) * m_config.apSpacing});
+        m_cells.push_back(std::move(cell));
+    }
+}
+
+void Deployment::associateStations() {
+    size_t columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(m_cells.size()))));
+    size_t rows = (m_cells.size() + columns - 1) / columns;
+
+    // Uniformly random positions over the floor covered by the AP grid
+    std::mt19937 generator;
+    seedGenerator(generator, deriveStreamSeed(m_seed, 0));
+    m_floorEnd = Position{columns * m_config.apSpacing, rows * m_config.apSpacing};
+    std::uniform_real_distribution<> xDistribution(0.0, m_floorEnd.x);
+    std::uniform_real_distribution<> yDistribution(0.0, m_floorEnd.y);
+
+    m_apIndex.reset({0.0, 0.0}, m_floorEnd, m_config.apSpacing);
+    for (const auto& cell : m_cells) m_apIndex.insert(cell->accessPoint.getPosition());
+
+    m_stationPositions.resize(m_config.stations);
+    m_servingCell.resize(m_config.stations);
+    m_localId.resize(m_config.stations);
+    std::vector<size_t> cellSizes(m_cells.size(), 0);
+    for (std::uint32_t station = 0; station < m_config.stations; ++station) {
+        Position position{xDistribution(generator), yDistribution(generator)};
+        m_stationPositions[station] = position;
+
+        // Associate with the nearest AP
+        std::uint32_t best = m_apIndex.nearest(position);
+        m_servingCell[station] = best;
+        ++cellSizes[best];
+    }
+
+    for (size_t index = 0; index < m_cells.size(); ++index) {
+        Cell& cell = *m_cells[index];
+        cell.stations.setQueueCapacity(std::max<size_t>(StationTable::DEFAULT_QUEUE_CAPACITY,
+                                                        m_config.packetsPerStation));
+        cell.stations.addStations(cellSizes[index]);
+        cell.stations.reservePackets(cellSizes[index] * m_config.packetsPerStation);
+        cell.stationIds.reserve(cellSizes[index]);
+    }
+
+    PacketDescriptor packet;  // 1 KB best-effort data, no payload
+    for (std::uint32_t station = 0; station < m_config.stations; ++station) {
+        Cell& cell = *m_cells[m_servingCell[station]];
+        StationId local = static_cast<StationId>(cell.stationIds.size());
+        cell.stationIds.push_back(station);
+        cell.accessPoint.addUser(local);
+        cell.stations.setPosition(local, m_stationPositions[station]);
+        m_localId[station] = local;
+
+        packet.flowId = station;
+        for (int j = 0; j < m_config.packetsPerStation; ++j) {
+            cell.stations.enqueue(local, packet);
+        }
+    }
+}
+
+void Deployment::selectRates() {
+    for (size_t index = 0; index < m_cells.size(); ++index) {
+        Cell& cell = *m_cells[index];
+        cell.links.resize(cell.stations.size());
+        for (StationId local = 0; local < cell.stationIds.size(); ++local) {
+            const Position& position = m_stationPositions[cell.stationIds[local]];
+            cell.links.setDistance(local, distanceBetween(position, cell.accessPoint.getPosition()));
+            cell.links.setInterference(local, interferenceDbm(position, index));
+        }
+        cell.links.update(cell.stations, cell.accessPoint.calculateMaxThroughput());
+    }
+}
+
+void Deployment::updateLink(std::uint32_t station) {
+    size_t serving = m_servingCell[station];
+    Cell& cell = *m_cells[serving];
+    StationId local = m_localId[station];
+    const Position& position = m_stationPositions[station];
+    cell.stations.setPosition(local, position);
+    cell.links.setDistance(local, distanceBetween(position, cell.accessPoint.getPosition()));
+    cell.links.setInterference(local, interferenceDbm(position, serving));
+    cell.links.updateStation(cell.stations, local, cell.accessPoint.calculateMaxThroughput());
+}
+
+void Deployment::buildInterferenceDomains() {
+    // Co-channel APs within range hear each other; domains are the
+    // connected components of that graph
+    std::vector<size_t> parent(m_cells.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    std::vector<std::uint32_t> nearby;
+    for (size_t a = 0; a < m_cells.size(); ++a) {
+        m_apIndex.query(m_cells[a]->accessPoint.getPosition(), m_config.interferenceRange, nearby);
+        for (std::uint32_t b : nearby) {
+            if (b == a || m_cells[a]->channel != m_cells[b]->channel) continue;
+            m_cells[a]->interferers.push_back(b);
+            parent[findRoot(parent, a)] = findRoot(parent, b);
+        }
+    }
+
+    // Number domains in order of their lowest cell index
+    std::vector<size_t> domainOfRoot(m_cells.size(), SIZE_MAX);
+    for (size_t index = 0; index < m_cells.size(); ++index) {
+        size_t root = findRoot(parent, index);
+        if (domainOfRoot[root] == SIZE_MAX) {
+            domainOfRoot[root] = m_domains.size();
+            m_domains.emplace_back();
+        }
+        m_cells[index]->domain = domainOfRoot[root];
+        m_domains[domainOfRoot[root]].push_back(index);
+    }
+}
+
+double Deployment::interferenceDbm(const Position& receiver, size_t serving) const {
+    // APs the serving AP hears defer to it on the shared backoff wheel
+    const Cell& own = *m_cells[serving];
+    double totalMw = 0.0;
+    m_apIndex.forEachWithin(receiver, m_config.interferenceRange, [&](std::uint32_t cell, double distance) {
+        if (cell == serving || m_cells[cell]->channel != own.channel ||
+            std::find(own.interferers.begin(), own.interferers.end(), cell) != own.interferers.end()) {
+            return;
+        }
+        totalMw += std::pow(10.0, (m_config.link.txPowerDbm - pathLossDb(distance, m_config.link.carrierGHz)) / 10.0);
+    });
+    return totalMw > 0.0 ? 10.0 * std::log10(totalMw) : -std::numeric_limits<double>::infinity();
+}
+
+void Deployment::moveStation(std::uint32_t station, SimTime time) {
+    SimTime next;
+    Position position = m_mobility->advance(station, time, next);
+    m_stationPositions[station] = position;
+    ++m_mobilityUpdates;
+
+    // Roam when the nearest AP beats the serving one by the margin
+    size_t serving = m_servingCell[station];
+    size_t nearest = m_apIndex.nearest(position);
+    const double carrier = m_config.link.carrierGHz;
+    if (nearest != serving &&
+        pathLossDb(distanceBetween(position, m_cells[serving]->accessPoint.getPosition()), carrier) -
+        pathLossDb(distanceBetween(position, m_cells[nearest]->accessPoint.getPosition()), carrier) >=
+        m_config.handoffMarginDb) {
+        handoff(station, nearest);
+    }
+
+    updateLink(station);
+
+    if (next != MobilityModel::NEVER) {
+        m_mobilityEvents.schedule(next, m_mobilityHandlerId, 0, station);
+    }
+}
+
+void Deployment::handoff(std::uint32_t station, size_t target) {
+    Cell& from = *m_cells[m_servingCell[station]];
+    Cell& to = *m_cells[target];
+    StationId oldLocal = m_localId[station];
+
+    // The station joins the target cell under a new local id; its old slot
+    // stays behind, empty, with the statistics gathered there
+    StationId newLocal = to.stations.addStations(1);
+    to.stationIds.push_back(station);
+    to.accessPoint.addUser(newLocal);
+    to.links.resize(to.stations.size());
+    from.accessPoint.removeUser(oldLocal);
+
+    PacketDescriptor packet;
+    while (from.stations.tryDequeue(oldLocal, packet)) {
+        to.stations.enqueue(newLocal, packet);
+    }
+
+    m_servingCell[station] = static_cast<std::uint32_t>(target);
+    m_localId[station] = newLocal;
+    ++m_handoffs;
+}
+
+std::uint64_t Deployment::domainSeed(size_t domain) const {
+    // Cells use substreams 1..cells of the deployment seed
+    return deriveStreamSeed(m_seed, 1 + m_cells.size() + domain);
+}
+
+void Deployment::runDomain(size_t domain) {
+    MediumDomain medium(*this, m_domains[domain], m_config.dcf, domainSeed(domain));
+    medium.run();
+}
+
+DeploymentResult Deployment::runMobile(size_t threadCount) {
+    m_mobilityEvents.reset();
+    m_mobilityUpdates = 0;
+    m_handoffs = 0;
+    for (std::uint32_t station = 0; station < m_stationPositions.size(); ++station) {
+        SimTime first = m_mobility->start(station, m_stationPositions[station]);
+        if (first != MobilityModel::NEVER) {
+            m_mobilityEvents.schedule(first, m_mobilityHandlerId, 0, station);
+        }
+    }
+
+    std::vector<std::unique_ptr<MediumDomain>> media;
+    for (size_t domain = 0; domain < m_domains.size(); ++domain) {
+        media.push_back(std::make_unique<MediumDomain>(*this, m_domains[domain], m_config.dcf, domainSeed(domain)));
+        media.back()->start();
+    }
+    auto queuedPackets = [this]() {
+        size_t queued = 0;
+        for (const auto& cell : m_cells) queued += cell->stations.getQueuedPackets();
+        return queued;
+    };
+
+    // Position updates at time t take effect at the first barrier at or after t
+    ThreadPool pool(std::min(threadCount, m_domains.size()));
+    std::vector<std::future<void>> futures;
+    for (SimTime epochEnd = SimTime::zero(); queuedPackets() > 0;) {
+        m_mobilityEvents.runUntil(epochEnd);
+        epochEnd += m_config.mobilityEpoch;
+        futures.clear();
+        for (auto& medium : media) {
+            MediumDomain* domain = medium.get();
+            futures.push_back(pool.submit([domain, epochEnd]() { domain->runUntil(epochEnd); }));
+        }
+        for (auto& future : futures) {
+            future.get();
+        }
+    }
+
+    DeploymentResult result;
+    result.mobilityUpdates = m_mobilityUpdates;
+    result.handoffs = m_handoffs;
+    return result;
+}
+
+DeploymentResult Deployment::run(size_t threadCount) {
+    auto start = std::chrono::steady_clock::now();
+    DeploymentResult result;
+    if (m_mobility) {
+        result = runMobile(threadCount);
+    } else {
+        // Largest domains first so the long poles start early
+        std::vector<size_t> order(m_domains.size());
+        std::iota(order.begin(), order.end(), 0);
+        auto domainLoad = [this](size_t domain) {
+            size_t load = 0;
+            for (size_t cell : m_domains[domain]) load += m_cells[cell]->stations.getQueuedPackets();
+            return load;
+        };
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return domainLoad(a) > domainLoad(b);
+        });
+
+        ThreadPool pool(std::min(threadCount, m_domains.size()));
+        std::vector<std::future<void>> futures;
+        futures.reserve(order.size());
+        for (size_t domain : order) {
+            futures.push_back(pool.submit([this, domain]() { runDomain(domain); }));
+        }
+        for (auto& future : futures) {
+            future.get();
+        }
+    }
+
+    result.domains = m_domains.size();
+    result.cells.reserve(m_cells.size());
+    for (const auto& cell : m_cells) {
+        result.cells.push_back(collectStationMetrics(cell->stations));
+        result.cells.back().collisions = cell->collisions;
+        mergeMetrics(result.total, result.cells.back());
+    }
+    result.wallTimeMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void printDeploymentResult(const Deployment& deployment, const DeploymentResult& result,
+                           std::ostream& out) {
+    out << "Deployment with " << deployment.getCellCount() << " APs, "
+        << deployment.getStationCount() << " Users, " << result.domains
+        << " interference domains:\n";
+    for (size_t index = 0; index < result.cells.size(); ++index) {
+        const Cell& cell = deployment.getCell(index);
+        const SimulationMetrics& metrics = result.cells[index];
+        const std::vector<StationId>& users = cell.accessPoint.getConnectedUsers();
+        double linkRate = 0.0;
+        for (StationId station : users) linkRate += cell.links.getRate(station);
+        if (!users.empty()) linkRate /= users.size();
+        out << cell.accessPoint.getId() << " (channel " << cell.channel << ", "
+            << users.size() << " Users, " << cell.interferers.size() << " interferers, "
+            << linkRate << " Mbps mean link rate): "
+            << metrics.throughputMbps << " Mbps, average latency "
+            << metrics.avgLatencyUs << " microseconds\n";
+    }
+    if (result.mobilityUpdates > 0) {
+        out << "Mobility: " << result.mobilityUpdates << " position updates, "
+            << result.handoffs << " handoffs\n";
+    }
+    out << "Collisions: " << result.total.collisions << " (" << result.total.droppedPackets
+        << " packets dropped at the retry limit)\n";
+    out << "Aggregate Throughput: " << result.total.throughputMbps << " Mbps\n";
+    out << "Average Latency: " << result.total.avgLatencyUs << " microseconds\n";
+    out << "Max Latency: " << result.total.maxLatencyUs << " microseconds\n";
+    printLatencyPercentiles(result.total.latency, out);
+    out << "Wall time: " << result.wallTimeMs << " ms\n";
+}
@@ -0,0 +1,155 @@
+#ifndef DEPLOYMENT_H
+#define DEPLOYMENT_H
+
+#include <memory>
+#include <vector>
+
+#include "WiFiSimulation.h"
+#include "dcf.h"
+#include "link_adaptation.h"
+#include "spatial_index.h"
+#include "mobility.h"
+#include "event_scheduler.h"
+
+// Floor-level deployment parameters
+struct DeploymentConfig {
+    size_t accessPoints = 16;
+    size_t stations = 1000;
+    double apSpacing = 25.0;          // m; APs sit on a square grid
+    int channels = 3;                 // Non-overlapping channels reused across the grid
+    double interferenceRange = 50.0;  // m; co-channel APs closer than this share the medium
+                                      // (over apSpacing * sqrt(2), the nearest reuse distance)
+    int packetsPerStation = 10;
+    PhyConfig phy;
+    DcfParameters dcf;                // Channel access of the APs
+    LinkConfig link;                  // Per-station rate selection; the width limit is phy.channelWidth
+    SimTime mobilityEpoch = std::chrono::milliseconds(10);  // Movement is applied at these barriers
+    double handoffMarginDb = 3.0;     // Roam once another AP's path loss is this much lower
+};
+
+// One BSS: an access point and the stations associated with it
+struct Cell {
+    AccessPoint accessPoint;
+    int channel;
+    StationTable stations;
+    std::vector<std::uint32_t> stationIds;  // Deployment-wide ids, by local StationId (including departed ones)
+    LinkAdaptation links;                   // PHY mode of each station
+    std::vector<size_t> interferers;        // Co-channel cells within interference range
+    size_t domain;                          // Interference domain the cell belongs to
+    std::uint64_t collisions;               // Frames of this AP that collided
+
+    Cell(const std::string& id, std::uint64_t seed, const PhyConfig& phy,
+         const LinkConfig& link, int channel)
+        : accessPoint(id, seed, phy), channel(channel), links(link), domain(0), collisions(0) {}
+};
+
+struct DeploymentResult {
+    std::vector<SimulationMetrics> cells;  // By cell index
+    SimulationMetrics total;
+    size_t domains = 0;
+    size_t mobilityUpdates = 0;            // Station position updates applied
+    size_t handoffs = 0;
+    double wallTimeMs = 0.0;
+};
+
+// Many access points on one floor. Stations are placed at random and
+// associate with the nearest AP. Co-channel APs within interference range
+// are coupled only through the shared medium. Coupled cells form an
+// interference domain, whose APs contend with DCF on one backoff wheel
+// (dcf.h) and collide when their backoffs expire on the same slot.
+// Co-channel APs the serving AP cannot hear transmit regardless of its
+// backoff, so their power at a station is interference in its SINR. AP
+// positions are kept in a spatial grid, so association and neighbour
+// queries scale with the floor size. Each domain runs on its own
+// event scheduler; domains never interact, so they run in parallel and the
+// result does not depend on the thread count.
+//
+// With a mobility model, domains advance in lockstep epochs. Position
+// updates are events on a separate scheduler, applied between epochs:
+// each moves one station, re-selects only that station's link mode
+// (with its interference), and hands it off (with its queue) when another AP's
+// path loss is lower by the handoff margin.
+class Deployment {
+private:
+    DeploymentConfig m_config;
+    std::uint64_t m_seed;
+    std::vector<std::unique_ptr<Cell>> m_cells;
+    std::vector<Position> m_stationPositions;
+    std::vector<std::uint32_t> m_servingCell;     // By deployment-wide station id
+    std::vector<std::vector<size_t>> m_domains;   // Cell indices per domain
+    SpatialGrid m_apIndex;                        // Entry = cell index
+    Position m_floorEnd;
+    std::vector<StationId> m_localId;             // Id within the serving cell, by station
+
+    // Applies mobility events to the deployment
+    class MobilityHandler : public EventHandler {
+    private:
+        Deployment& m_deployment;
+    public:
+        explicit MobilityHandler(Deployment& deployment) : m_deployment(deployment) {}
+        void handleEvent(const SimulationEvent& event) override {
+            m_deployment.moveStation(event.target, event.time);
+        }
+    };
+
+    std::unique_ptr<MobilityModel> m_mobility;
+    EventScheduler m_mobilityEvents;
+    MobilityHandler m_mobilityHandler;
+    std::uint16_t m_mobilityHandlerId;
+    size_t m_mobilityUpdates;
+    size_t m_handoffs;
+
+    void placeAccessPoints();
+    void associateStations();
+    void selectRates();
+    void updateLink(std::uint32_t station);
+    void moveStation(std::uint32_t station, SimTime time);
+    void handoff(std::uint32_t station, size_t target);
+    DeploymentResult runMobile(size_t threadCount);
+    void buildInterferenceDomains();
+    std::uint64_t domainSeed(size_t domain) const;
+
+public:
+    explicit Deployment(const DeploymentConfig& config = DeploymentConfig(),
+                        std::uint64_t seed = DEFAULT_SIMULATION_SEED);
+    Deployment(const Deployment&) = delete;
+    Deployment& operator=(const Deployment&) = delete;
+
+    // Run one interference domain to completion on the calling thread
+    void runDomain(size_t domain);
+
+    // Run every domain, in parallel on `threadCount` threads (0 = all cores)
+    DeploymentResult run(size_t threadCount = 0);
+
+    // Move stations with `model` from the next run() on (nullptr = static)
+    void setMobility(std::unique_ptr<MobilityModel> model) { m_mobility = std::move(model); }
+
+    // Corner of the floor opposite the origin
+    const Position& getFloorEnd() const { return m_floorEnd; }
+
+    const DeploymentConfig& getConfig() const { return m_config; }
+    size_t getCellCount() const { return m_cells.size(); }
+    Cell& getCell(size_t index) { return *m_cells[index]; }
+    const Cell& getCell(size_t index) const { return *m_cells[index]; }
+
+    size_t getDomainCount() const { return m_domains.size(); }
+    const std::vector<size_t>& getDomain(size_t domain) const { return m_domains[domain]; }
+
+    size_t getStationCount() const { return m_stationPositions.size(); }
+    const Position& getStationPosition(std::uint32_t station) const { return m_stationPositions[station]; }
+    std::uint32_t getServingCell(std::uint32_t station) const { return m_servingCell[station]; }
+
+    StationId getLocalId(std::uint32_t station) const { return m_localId[station]; }
+
+    // Power in dBm received at `receiver` from the APs on cell `serving`'s
+    // channel that it cannot hear (hidden APs), all transmitting. APs beyond
+    // interference range are below the power cutoff and skipped; -infinity
+    // if none is in range.
+    double interferenceDbm(const Position& receiver, size_t serving) const;
+};
+
+// Per-cell and aggregate summary
+void printDeploymentResult(const Deployment& deployment, const DeploymentResult& result,
+                           std::ostream& out = std::cout);
+
+#endif // DEPLOYMENT_H
@@ -0,0 +1,42 @@
+#include "deployment.h"
+#include <cstdlib>
+
+int main(int argc, char* argv[]) {
+    try {
+        // Usage: deploy [access points] [users] [interference range (m)] [threads] [seed] [speed (m/s)]
+        DeploymentConfig config;
+        config.accessPoints = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 36;
+        config.stations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 3000;
+        config.interferenceRange = argc > 3 ? std::strtod(argv[3], nullptr) : config.interferenceRange;
+        size_t threads = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 0;
+        std::uint64_t seed = argc > 5 ? std::strtoull(argv[5], nullptr, 10) : DEFAULT_SIMULATION_SEED;
+        double speed = argc > 6 ? std::strtod(argv[6], nullptr) : 0.0;
+
+        Deployment deployment(config, seed);
+        if (deployment.getCellCount() > 1 && deployment.getDomainCount() == deployment.getCellCount()) {
+            std::cerr << "Note: no co-channel APs within " << config.interferenceRange
+                      << " m of each other; every AP has the medium to itself\n";
+        }
+        if (speed > 0.0) {
+            // Random waypoint over the floor at half to full `speed`
+            RandomWaypointConfig mobility;
+            mobility.high = deployment.getFloorEnd();
+            mobility.minSpeed = speed / 2.0;
+            mobility.maxSpeed = speed;
+            mobility.maxPause = SimTime::zero();
+            mobility.updateInterval = config.mobilityEpoch;
+            deployment.setMobility(std::make_unique<RandomWaypointMobility>(mobility, deriveStreamSeed(seed, 1000)));
+        }
+        DeploymentResult result = deployment.run(threads);
+        printDeploymentResult(deployment, result);
+        return 0;
+    }
+    catch (const WiFiSimulationException& e) {
+        std::cerr << "Simulation Error: " << e.what() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Unexpected Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
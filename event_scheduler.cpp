@@ -0,0 +1,92 @@
+#include "event_scheduler.h"
+#include "WiFiSimulation.h"
+#include "snapshot.h"
+
+EventScheduler::EventScheduler()
+    : m_now(SimTime::zero()),
+      m_nextSequence(0),
+      m_processedEvents(0) {}
+
+std::uint16_t EventScheduler::registerHandler(EventHandler* handler) {
+    if (m_handlers.size() >= UINT16_MAX) {
+        throw WiFiSimulationException("Too many event handlers");
+    }
+    m_handlers.push_back(handler);
+    return static_cast<std::uint16_t>(m_handlers.size() - 1);
+}
+
+void EventScheduler::setHandler(std::uint16_t id, EventHandler* handler) {
+    if (id >= m_handlers.size()) {
+        throw WiFiSimulationException("Unknown event handler");
+    }
+    m_handlers[id] = handler;
+}
+
+void EventScheduler::schedule(SimTime time, std::uint16_t handler, std::uint16_t type, std::uint32_t target) {
+    if (time < m_now) {
+        throw WiFiSimulationException("Cannot schedule an event in the past");
+    }
+    if (handler >= m_handlers.size()) {
+        throw WiFiSimulationException("Unknown event handler");
+    }
+    m_events.push(SimulationEvent{time, m_nextSequence++, handler, type, target});
+}
+
+bool EventScheduler::step() {
+    if (m_events.empty()) return false;
+
+    SimulationEvent event = m_events.top();
+    m_events.pop();
+
+    // Jump the clock straight to the next event; idle time costs nothing
+    m_now = event.time;
+    ++m_processedEvents;
+    m_handlers[event.handler]->handleEvent(event);
+    return true;
+}
+
+void EventScheduler::run() {
+    while (step()) {}
+}
+
+void EventScheduler::runUntil(SimTime endTime) {
+    while (!m_events.empty() && m_events.top().time <= endTime) {
+        step();
+    }
+    if (m_now < endTime) m_now = endTime;
+}
+
+void EventScheduler::reset() {
+    m_events = decltype(m_events)();
+    m_now = SimTime::zero();
+    m_nextSequence = 0;
+    m_processedEvents = 0;
+}
+
+void EventScheduler::saveState(SnapshotWriter& out) const {
+    // Earliest first, so loading pushes them back in heap order cheaply
+    std::vector<SimulationEvent> events;
+    events.reserve(m_events.size());
+    for (auto pending = m_events; !pending.empty(); pending.pop()) {
+        events.push_back(pending.top());
+    }
+    out.putVector(events);
+    out.put(m_now);
+    out.put(m_nextSequence);
+    out.put(m_processedEvents);
+}
+
+void EventScheduler::loadState(SnapshotReader& in) {
+    std::vector<SimulationEvent> events;
+    in.getVector(events);
+    m_events = decltype(m_events)();
+    in.get(m_now);
+    in.get(m_nextSequence);
+    in.get(m_processedEvents);
+    for (const SimulationEvent& event : events) {
+        if (event.handler >= m_handlers.size() || event.time < m_now || event.sequence >= m_nextSequence) {
+            throw WiFiSimulationException("Corrupt event queue in simulation snapshot");
+        }
+        m_events.push(event);
+    }
+}
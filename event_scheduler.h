@@ -0,0 +1,90 @@
+#ifndef EVENT_SCHEDULER_H
+#define EVENT_SCHEDULER_H
+
+#include <chrono>
+#include <cstdint>
+#include <queue>
+#include <vector>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// Simulated time. All simulations advance this virtual clock instead of
+// reading std::chrono::steady_clock, so results do not depend on host speed.
+using SimTime = std::chrono::nanoseconds;
+
+// A discrete event. Events carry plain data only (no closures) so queueing
+// one never allocates beyond the heap storage itself.
+struct SimulationEvent {
+    SimTime time;
+    std::uint64_t sequence;  // FIFO tie-break for events at the same instant
+    std::uint16_t handler;   // Id returned by EventScheduler::registerHandler
+    std::uint16_t type;      // Handler-defined event kind
+    std::uint32_t target;    // Handler-defined argument (user index, iteration, ...)
+};
+
+// Interface for anything that consumes events from the scheduler
+class EventHandler {
+public:
+    virtual ~EventHandler() = default;
+    virtual void handleEvent(const SimulationEvent& event) = 0;
+};
+
+// Discrete-event core: a simulated-time priority queue
+class EventScheduler {
+private:
+    struct LaterEvent {
+        bool operator()(const SimulationEvent& a, const SimulationEvent& b) const {
+            if (a.time != b.time) return a.time > b.time;
+            return a.sequence > b.sequence;
+        }
+    };
+
+    std::priority_queue<SimulationEvent, std::vector<SimulationEvent>, LaterEvent> m_events;
+    std::vector<EventHandler*> m_handlers;
+    SimTime m_now;
+    std::uint64_t m_nextSequence;
+    std::uint64_t m_processedEvents;
+
+public:
+    EventScheduler();
+
+    // Register an event consumer; the returned id is used when scheduling
+    std::uint16_t registerHandler(EventHandler* handler);
+
+    // Point a registered id at another consumer (e.g. the copy of a
+    // simulation, whose copied events still carry the original's id)
+    void setHandler(std::uint16_t id, EventHandler* handler);
+
+    // Schedule an event at an absolute simulated time (must not be in the past)
+    void schedule(SimTime time, std::uint16_t handler, std::uint16_t type, std::uint32_t target = 0);
+
+    // Schedule an event relative to the current simulated time
+    void scheduleAfter(SimTime delay, std::uint16_t handler, std::uint16_t type, std::uint32_t target = 0) {
+        schedule(m_now + delay, handler, type, target);
+    }
+
+    // Dispatch the earliest pending event; returns false when the queue is empty
+    bool step();
+
+    // Run until no events remain
+    void run();
+
+    // Run all events with time <= endTime, then advance the clock to endTime
+    void runUntil(SimTime endTime);
+
+    // Drop all pending events and rewind the clock to zero
+    void reset();
+
+    SimTime now() const { return m_now; }
+    bool empty() const { return m_events.empty(); }
+    size_t pendingEvents() const { return m_events.size(); }
+    std::uint64_t processedEvents() const { return m_processedEvents; }
+
+    // Pending events and the clock. Handlers are not saved: the loading
+    // side registers its own under the same ids.
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+};
+
+#endif // EVENT_SCHEDULER_H
@@ -0,0 +1,135 @@
+#include "latency_histogram.h"
+#include "snapshot.h"
+#include <algorithm>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram()
+    : m_totalCount(0),
+      m_sum(0),
+      m_min(UINT64_MAX),
+      m_max(0) {}
+
+size_t LatencyHistogram::bucketIndex(std::uint64_t value) {
+    if (value < SUB_BUCKET_COUNT) {
+        return static_cast<size_t>(value);
+    }
+
+    // Keep the top SUB_BUCKET_BITS - 1 significant bits below the leading one
+    std::uint32_t msb = 63 - __builtin_clzll(value);
+    std::uint32_t shift = msb - (SUB_BUCKET_BITS - 1);
+    std::uint64_t top = value >> shift;  // In [SUB_BUCKET_HALF, SUB_BUCKET_COUNT)
+    return static_cast<size_t>(SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_HALF +
+                               (top - SUB_BUCKET_HALF));
+}
+
+std::uint64_t LatencyHistogram::bucketHighestValue(size_t index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+
+    std::uint64_t offset = index - SUB_BUCKET_COUNT;
+    std::uint32_t shift = static_cast<std::uint32_t>(offset / SUB_BUCKET_HALF) + 1;
+    std::uint64_t top = offset % SUB_BUCKET_HALF + SUB_BUCKET_HALF;
+    return (top << shift) + ((1ull << shift) - 1);
+}
+
+void LatencyHistogram::record(SimTime latency) {
+    recordNanoseconds(latency.count() > 0 ? static_cast<std::uint64_t>(latency.count()) : 0);
+}
+
+void LatencyHistogram::recordNanoseconds(std::uint64_t nanoseconds) {
+    size_t index = bucketIndex(std::min(nanoseconds, MAX_TRACKABLE_NS));
+    if (index >= m_counts.size()) {
+        m_counts.resize(index + 1, 0);
+    }
+    ++m_counts[index];
+
+    ++m_totalCount;
+    m_sum += nanoseconds;
+    m_min = std::min(m_min, nanoseconds);
+    m_max = std::max(m_max, nanoseconds);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.m_counts.size() > m_counts.size()) {
+        m_counts.resize(other.m_counts.size(), 0);
+    }
+    for (size_t i = 0; i < other.m_counts.size(); ++i) {
+        m_counts[i] += other.m_counts[i];
+    }
+
+    m_totalCount += other.m_totalCount;
+    m_sum += other.m_sum;
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+}
+
+void LatencyHistogram::reset() {
+    std::fill(m_counts.begin(), m_counts.end(), 0);
+    m_totalCount = 0;
+    m_sum = 0;
+    m_min = UINT64_MAX;
+    m_max = 0;
+}
+
+void LatencyHistogram::subtract(const LatencyHistogram& earlier) {
+    for (size_t i = 0; i < earlier.m_counts.size() && i < m_counts.size(); ++i) {
+        m_counts[i] -= std::min(m_counts[i], earlier.m_counts[i]);
+    }
+    m_totalCount -= std::min(m_totalCount, earlier.m_totalCount);
+    m_sum -= std::min(m_sum, earlier.m_sum);
+
+    m_min = UINT64_MAX;
+    std::uint64_t highest = 0;
+    for (size_t i = 0; i < m_counts.size(); ++i) {
+        if (m_counts[i] == 0) continue;
+        if (m_min == UINT64_MAX) m_min = i > 0 ? bucketHighestValue(i - 1) + 1 : 0;
+        highest = bucketHighestValue(i);
+    }
+    m_max = m_totalCount ? std::min(highest, m_max) : 0;
+}
+
+double LatencyHistogram::meanMicroseconds() const {
+    if (m_totalCount == 0) return 0.0;
+    return static_cast<double>(m_sum) / m_totalCount / 1000.0;
+}
+
+SimTime LatencyHistogram::valueAtPercentile(double percentile) const {
+    if (m_totalCount == 0) return SimTime::zero();
+
+    double clamped = std::min(std::max(percentile, 0.0), 100.0);
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(clamped / 100.0 * m_totalCount));
+    rank = std::max<std::uint64_t>(rank, 1);
+
+    // Report the top of the bucket holding the rank-th sample, as HdrHistogram
+    // does, but never outside the exactly tracked range
+    std::uint64_t seen = 0;
+    for (size_t i = 0; i < m_counts.size(); ++i) {
+        seen += m_counts[i];
+        if (seen >= rank) {
+            std::uint64_t value = std::min(bucketHighestValue(i), m_max);
+            return SimTime(static_cast<SimTime::rep>(std::max(value, m_min)));
+        }
+    }
+    return SimTime(static_cast<SimTime::rep>(m_max));
+}
+
+double LatencyHistogram::percentileMicroseconds(double percentile) const {
+    return std::chrono::duration<double, std::micro>(valueAtPercentile(percentile)).count();
+}
+
+void LatencyHistogram::saveState(SnapshotWriter& out) const {
+    out.putVector(m_counts);
+    out.put(m_totalCount);
+    out.put(m_sum);
+    out.put(m_min);
+    out.put(m_max);
+}
+
+void LatencyHistogram::loadState(SnapshotReader& in) {
+    in.getVector(m_counts);
+    in.get(m_totalCount);
+    in.get(m_sum);
+    in.get(m_min);
+    in.get(m_max);
+}
@@ -0,0 +1,67 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <cstdint>
+#include <vector>
+
+#include "event_scheduler.h"
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// Streaming latency recorder in the style of HdrHistogram. Values (in ns) are
+// counted in log-linear buckets: exact below 256 ns, then 128 linear
+// sub-buckets per power of two, so any reported percentile is within 0.8% of
+// the true value. Count, sum, min and max are tracked exactly. Buckets are
+// only allocated up to the largest value seen, so memory is bounded by the
+// value range (at most ~38 KB) and not by the number of samples.
+// Histograms merge losslessly across stations, threads and replications.
+class LatencyHistogram {
+private:
+    static constexpr std::uint32_t SUB_BUCKET_BITS = 8;
+    static constexpr std::uint64_t SUB_BUCKET_COUNT = 1ull << SUB_BUCKET_BITS;
+    static constexpr std::uint64_t SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+
+    std::vector<std::uint64_t> m_counts;
+    std::uint64_t m_totalCount;
+    std::uint64_t m_sum;  // ns
+    std::uint64_t m_min;
+    std::uint64_t m_max;
+
+    static size_t bucketIndex(std::uint64_t value);
+    static std::uint64_t bucketHighestValue(size_t index);
+
+public:
+    // Values above this are counted in the last bucket (max stays exact)
+    static constexpr std::uint64_t MAX_TRACKABLE_NS = (1ull << 44) - 1;  // ~4.9 hours
+
+    LatencyHistogram();
+
+    void record(SimTime latency);
+    void recordNanoseconds(std::uint64_t nanoseconds);
+    void merge(const LatencyHistogram& other);
+    void reset();
+
+    // Remove the samples of `earlier`, an older copy of this histogram, to
+    // keep only those recorded since. Min and max become the bounds of the
+    // lowest and highest buckets left.
+    void subtract(const LatencyHistogram& earlier);
+
+    std::uint64_t count() const { return m_totalCount; }
+    bool empty() const { return m_totalCount == 0; }
+    SimTime sum() const { return SimTime(m_sum); }
+    SimTime min() const { return SimTime(m_totalCount ? m_min : 0); }
+    SimTime max() const { return SimTime(m_max); }
+    double meanMicroseconds() const;
+
+    // Latency at or below which `percentile` percent of samples fall (0-100)
+    SimTime valueAtPercentile(double percentile) const;
+    double percentileMicroseconds(double percentile) const;
+
+    size_t getMemoryBytes() const { return m_counts.capacity() * sizeof(std::uint64_t); }
+
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+};
+
+#endif // LATENCY_HISTOGRAM_H
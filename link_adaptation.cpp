@@ -0,0 +1,226 @@
+#include "link_adaptation.h"
+#include "WiFiSimulation.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+const char* toString(PhyGeneration generation) {
+    switch (generation) {
+    case PhyGeneration::HT:  return "802.11n";
+    case PhyGeneration::VHT: return "802.11ac";
+    case PhyGeneration::HE:  return "802.11ax";
+    }
+    return "Unknown";
+}
+
+double pathLossDb(double distanceMeters, double carrierGHz) {
+    const double BREAKPOINT = 5.0;
+    auto freeSpace = [carrierGHz](double d) {
+        return 20.0 * std::log10(d) + 20.0 * std::log10(carrierGHz) + 32.45;
+    };
+    double d = std::max(distanceMeters, 1.0);
+    if (d <= BREAKPOINT) return freeSpace(d);
+    return freeSpace(BREAKPOINT) + 35.0 * std::log10(d / BREAKPOINT);
+}
+
+namespace {
+
+// Distances beyond which the next longer guard interval is used
+constexpr double GI_DISTANCE[2] = {10.0, 30.0};
+
+// Mode codes pack MCS + 1, streams and width one byte each; 0 = no mode found
+std::int32_t encodeMode(unsigned mcs, unsigned nss, unsigned width) {
+    return static_cast<std::int32_t>((mcs + 1) | (nss << 8) | (width << 16));
+}
+
+} // namespace
+
+LinkAdaptation::LinkAdaptation(const LinkConfig& config)
+    : m_stations(0) {
+    setConfig(config);
+}
+
+void LinkAdaptation::setConfig(const LinkConfig& config) {
+    if (config.maxWidthMHz < 20.0 || config.apStreams == 0 || config.stationStreams == 0 ||
+        config.carrierGHz <= 0.0) {
+        throw WiFiSimulationException("Invalid link configuration");
+    }
+    m_config = config;
+    buildTables();
+}
+
+void LinkAdaptation::buildTables() {
+    const PhyGeneration generation = m_config.generation;
+    m_widths = 1;
+    while (m_widths < phy::widthCount(generation) && phy::WIDTH_MHZ[m_widths] <= m_config.maxWidthMHz) {
+        ++m_widths;
+    }
+    m_streamLimit = std::min({m_config.apStreams, m_config.stationStreams,
+                              generation == PhyGeneration::HT ? 4u : phy::MAX_STREAMS});
+
+    m_rateTable.assign(phy::GI_COUNT * phy::WIDTH_COUNT * phy::MAX_STREAMS * phy::MCS_COUNT, 0.0f);
+    m_mcsTable.assign(m_rateTable.size(), 0);
+    for (unsigned gi = 0; gi < phy::giCount(generation); ++gi) {
+        for (unsigned width = 0; width < m_widths; ++width) {
+            for (unsigned nss = 1; nss <= m_streamLimit; ++nss) {
+                unsigned effective = 0;
+                for (unsigned mcs = 0; mcs < phy::mcsCount(generation); ++mcs) {
+                    if (phy::isValid(generation, width, nss, mcs)) effective = mcs;
+                    size_t index = tableIndex(gi, width, nss, mcs);
+                    m_rateTable[index] = static_cast<float>(phy::dataRateMbps(generation, width, nss, effective, gi));
+                    m_mcsTable[index] = static_cast<std::uint8_t>(effective);
+                }
+            }
+        }
+    }
+
+    for (unsigned step = 0; step < 2; ++step) {
+        m_giLoss[step] = static_cast<float>(pathLossDb(GI_DISTANCE[step], m_config.carrierGHz));
+    }
+    for (unsigned nss = 1; nss <= phy::MAX_STREAMS; ++nss) {
+        m_streamPenalty[nss - 1] = static_cast<float>(10.0 * std::log10(nss));  // Power split over streams
+    }
+    for (unsigned width = 0; width < phy::WIDTH_COUNT; ++width) {
+        m_noiseDbm[width] = static_cast<float>(-174.0 + 10.0 * std::log10(phy::WIDTH_MHZ[width] * 1e6) +
+                                               m_config.noiseFigureDb);
+        m_noiseMw[width] = static_cast<float>(std::pow(10.0, m_noiseDbm[width] / 10.0));
+    }
+}
+
+void LinkAdaptation::setInterference(StationId station, double dbm) {
+    m_interference[station] = std::isfinite(dbm) ? static_cast<float>(std::pow(10.0, dbm / 10.0)) : 0.0f;
+}
+
+double LinkAdaptation::getInterferenceDbm(StationId station) const {
+    return m_interference[station] > 0.0f ? 10.0 * std::log10(m_interference[station])
+                                          : -std::numeric_limits<double>::infinity();
+}
+
+float LinkAdaptation::noiseRiseDb(size_t k, unsigned width) const {
+    return m_interference[k] > 0.0f ? 10.0f * std::log10(1.0f + m_interference[k] / m_noiseMw[width]) : 0.0f;
+}
+
+void LinkAdaptation::resize(size_t stations) {
+    size_t padded = (stations + 3) & ~static_cast<size_t>(3);
+    m_stations = stations;
+    m_pathLoss.resize(padded, 0.0f);
+    m_interference.resize(padded, 0.0f);
+    m_mcs.resize(padded, 0);
+    m_streams.resize(padded, 1);
+    m_width.resize(padded, 0);
+    m_gi.resize(padded, 0);
+    m_rate.resize(padded, 0.0f);
+}
+
+void LinkAdaptation::storeMode(size_t k, unsigned gi, std::int32_t code) {
+    unsigned mcs = code == 0 ? 0 : (code & 0xff) - 1;
+    unsigned nss = code == 0 ? 1 : (code >> 8) & 0xff;
+    unsigned width = (code >> 16) & 0xff;
+    size_t index = tableIndex(gi, width, nss, mcs);
+    m_mcs[k] = m_mcsTable[index];
+    m_streams[k] = static_cast<std::uint8_t>(nss);
+    m_width[k] = static_cast<std::uint8_t>(width);
+    m_gi[k] = static_cast<std::uint8_t>(gi);
+    m_rate[k] = m_rateTable[index];
+}
+
+void LinkAdaptation::selectMode(size_t k) {
+    const unsigned mcsCount = phy::mcsCount(m_config.generation);
+    const unsigned giSteps = phy::giCount(m_config.generation) - 1;
+    const float txPower = static_cast<float>(m_config.txPowerDbm);
+    const float loss = m_pathLoss[k];
+    unsigned gi = 0;
+    for (unsigned step = 0; step < giSteps; ++step) gi += loss >= m_giLoss[step];
+
+    float best = 0.0f;
+    std::int32_t bestCode = 0;
+    for (unsigned width = 0; width < m_widths; ++width) {
+        const float received = txPower - m_noiseDbm[width] - loss - noiseRiseDb(k, width);
+        for (unsigned nss = 1; nss <= m_streamLimit; ++nss) {
+            const float snr = received - m_streamPenalty[nss - 1];
+            unsigned reached = 0;
+            for (unsigned mcs = 0; mcs < mcsCount; ++mcs) reached += snr >= phy::MCS_TABLE[mcs].minSnrDb;
+            float rate = reached == 0 ? 0.0f : m_rateTable[tableIndex(gi, width, nss, reached - 1)];
+            if (rate > best) {
+                best = rate;
+                bestCode = encodeMode(reached - 1, nss, width);
+            }
+        }
+    }
+    storeMode(k, gi, bestCode);
+}
+
+void LinkAdaptation::update(StationTable& stations, double referenceRateMbps) {
+    if (stations.size() < m_stations || !(referenceRateMbps > 0.0)) {
+        throw WiFiSimulationException("Invalid link adaptation update");
+    }
+
+#ifdef WIFI_SIMD
+    using simd::Float4;
+    using simd::Int4;
+    using simd::broadcast;
+
+    const unsigned mcsCount = phy::mcsCount(m_config.generation);
+    const unsigned giSteps = phy::giCount(m_config.generation) - 1;
+    const float txPower = static_cast<float>(m_config.txPowerDbm);
+    for (size_t k = 0; k < m_rate.size(); k += 4) {
+        const Float4 loss = simd::load(&m_pathLoss[k]);
+        Int4 gi = broadcast(0);
+        for (unsigned step = 0; step < giSteps; ++step) gi -= loss >= broadcast(m_giLoss[step]);
+
+        Float4 best = broadcast(0.0f);
+        Int4 bestCode = broadcast(0);
+        for (unsigned width = 0; width < m_widths; ++width) {
+            Float4 rise;
+            for (unsigned lane = 0; lane < 4; ++lane) rise[lane] = noiseRiseDb(k + lane, width);
+            const Float4 received = broadcast(txPower - m_noiseDbm[width]) - loss - rise;
+            for (unsigned nss = 1; nss <= m_streamLimit; ++nss) {
+                const Float4 snr = received - broadcast(m_streamPenalty[nss - 1]);
+                Int4 reached = broadcast(0);
+                for (unsigned mcs = 0; mcs < mcsCount; ++mcs) {
+                    reached -= snr >= broadcast(phy::MCS_TABLE[mcs].minSnrDb);
+                }
+
+                // Gather the rate of each lane's highest reached MCS
+                Float4 rate;
+                for (unsigned lane = 0; lane < 4; ++lane) {
+                    rate[lane] = reached[lane] == 0 ? 0.0f :
+                        m_rateTable[tableIndex(gi[lane], width, nss, reached[lane] - 1)];
+                }
+                const Int4 better = rate > best;
+                const Int4 code = (reached - broadcast(1)) + broadcast(encodeMode(0, nss, width));
+                best = better ? rate : best;
+                bestCode = better ? code : bestCode;
+            }
+        }
+
+        for (unsigned lane = 0; lane < 4; ++lane) storeMode(k + lane, gi[lane], bestCode[lane]);
+    }
+#else
+    for (size_t k = 0; k < m_rate.size(); ++k) selectMode(k);
+#endif
+
+    const float scale = static_cast<float>(1.0 / referenceRateMbps);
+    for (StationId station = 0; station < m_stations; ++station) {
+        stations.setLinkEfficiency(station, m_rate[station] * scale);
+    }
+}
+
+void LinkAdaptation::updateStation(StationTable& stations, StationId station, double referenceRateMbps) {
+    if (station >= m_stations || station >= stations.size() || !(referenceRateMbps > 0.0)) {
+        throw WiFiSimulationException("Invalid link adaptation update");
+    }
+    selectMode(station);
+    stations.setLinkEfficiency(station, static_cast<float>(m_rate[station] / referenceRateMbps));
+}
+
+PhyMode LinkAdaptation::getMode(StationId station) const {
+    PhyMode mode;
+    mode.mcs = m_mcs[station];
+    mode.streams = m_streams[station];
+    mode.widthMHz = phy::WIDTH_MHZ[m_width[station]];
+    mode.guardIntervalUs = phy::guardIntervalUs(m_config.generation, m_gi[station]);
+    mode.rateMbps = m_rate[station];
+    return mode;
+}
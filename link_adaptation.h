@@ -0,0 +1,186 @@
+#ifndef LINK_ADAPTATION_H
+#define LINK_ADAPTATION_H
+
+#include <cstdint>
+#include <vector>
+
+#include "station_table.h"
+
+// PHY generation whose rate tables apply
+enum class PhyGeneration { HT, VHT, HE };  // 802.11n, 802.11ac, 802.11ax
+
+const char* toString(PhyGeneration generation);
+
+namespace phy {
+
+// MCS index -> modulation and coding. HT uses 0-7 (per stream), VHT 0-9, HE 0-11.
+struct Mcs {
+    std::uint8_t bitsPerSubcarrier;  // log2 of the constellation size
+    std::uint8_t codeNumerator;
+    std::uint8_t codeDenominator;
+    float minSnrDb;                  // Per-stream SNR needed for ~10% PER
+};
+
+constexpr unsigned MCS_COUNT = 12;
+constexpr Mcs MCS_TABLE[MCS_COUNT] = {
+    {1, 1, 2, 2.0f},  {2, 1, 2, 5.0f},  {2, 3, 4, 9.0f},  {4, 1, 2, 11.0f},
+    {4, 3, 4, 15.0f}, {6, 2, 3, 18.0f}, {6, 3, 4, 20.0f}, {6, 5, 6, 25.0f},
+    {8, 3, 4, 29.0f}, {8, 5, 6, 31.0f}, {10, 3, 4, 34.0f}, {10, 5, 6, 37.0f},
+};
+
+// Channel widths 20/40/80/160 MHz, by index
+constexpr unsigned WIDTH_COUNT = 4;
+constexpr std::uint16_t WIDTH_MHZ[WIDTH_COUNT] = {20, 40, 80, 160};
+
+constexpr unsigned MAX_STREAMS = 8;
+constexpr unsigned GI_COUNT = 3;
+
+constexpr unsigned mcsCount(PhyGeneration generation) {
+    return generation == PhyGeneration::HT ? 8 : generation == PhyGeneration::VHT ? 10 : 12;
+}
+
+constexpr unsigned widthCount(PhyGeneration generation) {
+    return generation == PhyGeneration::HT ? 2 : 4;
+}
+
+// Guard intervals: HT/VHT have long (0.8 us) and short (0.4 us); HE has
+// 0.8, 1.6 and 3.2 us. Index 0 is the shortest.
+constexpr unsigned giCount(PhyGeneration generation) {
+    return generation == PhyGeneration::HE ? 3 : 2;
+}
+
+constexpr double guardIntervalUs(PhyGeneration generation, unsigned gi) {
+    return generation == PhyGeneration::HE ? 0.8 * (1u << gi) : (gi == 0 ? 0.4 : 0.8);
+}
+
+// Data subcarriers per OFDM symbol
+constexpr unsigned dataSubcarriers(PhyGeneration generation, unsigned width) {
+    constexpr unsigned VHT_SUBCARRIERS[WIDTH_COUNT] = {52, 108, 234, 468};
+    constexpr unsigned HE_SUBCARRIERS[WIDTH_COUNT] = {234, 468, 980, 1960};
+    return generation == PhyGeneration::HE ? HE_SUBCARRIERS[width] : VHT_SUBCARRIERS[width];
+}
+
+// 802.11ac has no MCS 9 at 20 MHz except with 3 or 6 streams
+constexpr bool isValid(PhyGeneration generation, unsigned width, unsigned nss, unsigned mcs) {
+    return mcs < mcsCount(generation) && width < widthCount(generation) &&
+           !(generation == PhyGeneration::VHT && width == 0 && mcs == 9 && nss != 3 && nss != 6);
+}
+
+// Data rate in Mbps of one (width, streams, MCS, GI) combination
+constexpr double dataRateMbps(PhyGeneration generation, unsigned width, unsigned nss,
+                              unsigned mcs, unsigned gi) {
+    const double symbolUs = (generation == PhyGeneration::HE ? 12.8 : 3.2) + guardIntervalUs(generation, gi);
+    return dataSubcarriers(generation, width) * nss * MCS_TABLE[mcs].bitsPerSubcarrier *
+           MCS_TABLE[mcs].codeNumerator / (MCS_TABLE[mcs].codeDenominator * symbolUs);
+}
+
+static_assert(dataRateMbps(PhyGeneration::HT, 0, 1, 7, 1) == 65.0, "HT MCS 7, 20 MHz, long GI");
+static_assert(dataRateMbps(PhyGeneration::HE, 3, 8, 11, 0) > 9607 &&
+              dataRateMbps(PhyGeneration::HE, 3, 8, 11, 0) < 9608, "HE peak: 9607.8 Mbps");
+
+} // namespace phy
+
+// Link parameters shared by an AP's stations
+struct LinkConfig {
+    PhyGeneration generation = PhyGeneration::HE;
+    double maxWidthMHz = 20.0;     // Widest channel the AP offers
+    unsigned apStreams = 4;
+    unsigned stationStreams = 2;
+    double txPowerDbm = 20.0;
+    double noiseFigureDb = 7.0;
+    double carrierGHz = 5.0;
+};
+
+// Selected PHY mode of one station
+struct PhyMode {
+    unsigned mcs = 0;
+    unsigned streams = 1;
+    double widthMHz = 20.0;
+    double guardIntervalUs = 0.8;
+    double rateMbps = 0.0;
+};
+
+// Indoor path loss in dB (TGax residential model: free space up to a 5 m
+// breakpoint, then 35 dB/decade)
+double pathLossDb(double distanceMeters, double carrierGHz);
+
+// Per-station rate selection. Path losses are kept as a station-indexed
+// array; update() recomputes every station's MCS, stream count, width and
+// guard interval in one pass, four stations per vector operation (see
+// simd.h), picking the combination with the highest data rate whose SNR
+// threshold is met. Wider channels spread the same power over more noise
+// and more streams split it, so the best mode trades them off per station.
+// Interference received by a station (e.g. from co-channel APs) adds to
+// the noise of every width, so thresholds apply to the SINR.
+// The guard interval follows the delay spread, which grows with distance:
+// the shortest GI close to the AP, longer ones further out.
+class LinkAdaptation {
+private:
+    LinkConfig m_config;
+
+    // Per station, padded to a multiple of 4
+    std::vector<float> m_pathLoss;     // dB
+    std::vector<float> m_interference;  // mW; 0 = none
+    std::vector<std::uint8_t> m_mcs;
+    std::vector<std::uint8_t> m_streams;
+    std::vector<std::uint8_t> m_width;  // Index into phy::WIDTH_MHZ
+    std::vector<std::uint8_t> m_gi;
+    std::vector<float> m_rate;          // Mbps
+    size_t m_stations;
+
+    // Precomputed from the config: rate and effective MCS of every
+    // [gi][width][streams - 1][mcs] (MCS invalid for the combination fall
+    // back to the next lower one), the noise floor per width, the path
+    // losses where longer guard intervals start and the SNR cost of
+    // splitting power over streams
+    std::vector<float> m_rateTable;
+    std::vector<std::uint8_t> m_mcsTable;
+    float m_noiseDbm[phy::WIDTH_COUNT];
+    float m_noiseMw[phy::WIDTH_COUNT];
+    float m_giLoss[2];
+    float m_streamPenalty[phy::MAX_STREAMS];
+    unsigned m_widths;
+    unsigned m_streamLimit;
+
+    size_t tableIndex(unsigned gi, unsigned width, unsigned nss, unsigned mcs) const {
+        return ((gi * phy::WIDTH_COUNT + width) * phy::MAX_STREAMS + (nss - 1)) * phy::MCS_COUNT + mcs;
+    }
+    void buildTables();
+    float noiseRiseDb(size_t k, unsigned width) const;
+    void selectMode(size_t k);
+    void storeMode(size_t k, unsigned gi, std::int32_t code);
+
+public:
+    explicit LinkAdaptation(const LinkConfig& config = LinkConfig());
+
+    void setConfig(const LinkConfig& config);
+    const LinkConfig& getConfig() const { return m_config; }
+
+    // Track `stations` stations; new ones start at 0 dB path loss
+    void resize(size_t stations);
+    size_t size() const { return m_stations; }
+
+    void setPathLoss(StationId station, float lossDb) { m_pathLoss[station] = lossDb; }
+    void setDistance(StationId station, double meters) {
+        m_pathLoss[station] = static_cast<float>(pathLossDb(meters, m_config.carrierGHz));
+    }
+    float getPathLoss(StationId station) const { return m_pathLoss[station]; }
+
+    // Interference power at the station in dBm (-infinity = none)
+    void setInterference(StationId station, double dbm);
+    double getInterferenceDbm(StationId station) const;
+
+    // Re-select every station's mode. Stations whose link cannot carry even
+    // MCS 0 keep the most robust mode. Each station's link efficiency in
+    // `stations` becomes its rate over `referenceRateMbps` (the AP's
+    // nominal PHY rate), so airtimes follow the selected mode.
+    void update(StationTable& stations, double referenceRateMbps);
+
+    // Re-select one station's mode (e.g. after it moved or its interference changed)
+    void updateStation(StationTable& stations, StationId station, double referenceRateMbps);
+
+    PhyMode getMode(StationId station) const;
+    float getRate(StationId station) const { return m_rate[station]; }
+};
+
+#endif // LINK_ADAPTATION_H
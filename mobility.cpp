@@ -0,0 +1,125 @@
+#include "mobility.h"
+#include "WiFiSimulation.h"
+#include <algorithm>
+#include <istream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+Position interpolate(const Position& from, const Position& to, double fraction) {
+    return {from.x + (to.x - from.x) * fraction, from.y + (to.y - from.y) * fraction};
+}
+
+double fractionOf(SimTime time, SimTime begin, SimTime end) {
+    return end > begin ? static_cast<double>((time - begin).count()) / (end - begin).count() : 1.0;
+}
+
+} // namespace
+
+RandomWaypointMobility::RandomWaypointMobility(const RandomWaypointConfig& config, std::uint64_t seed)
+    : m_config(config) {
+    if (config.high.x < config.low.x || config.high.y < config.low.y || !(config.minSpeed > 0.0) ||
+        config.maxSpeed < config.minSpeed || config.maxPause < SimTime::zero() ||
+        config.updateInterval <= SimTime::zero()) {
+        throw WiFiSimulationException("Invalid random waypoint configuration");
+    }
+    seedGenerator(m_generator, seed);
+}
+
+void RandomWaypointMobility::nextLeg(Leg& leg, SimTime pausedSince) {
+    std::uniform_real_distribution<> x(m_config.low.x, m_config.high.x);
+    std::uniform_real_distribution<> y(m_config.low.y, m_config.high.y);
+    std::uniform_real_distribution<> speed(m_config.minSpeed, m_config.maxSpeed);
+    std::uniform_int_distribution<SimTime::rep> pause(0, m_config.maxPause.count());
+
+    leg.from = leg.to;
+    leg.departure = pausedSince + SimTime(pause(m_generator));
+    leg.to = Position{x(m_generator), y(m_generator)};
+    leg.arrival = leg.departure + std::chrono::duration_cast<SimTime>(
+        std::chrono::duration<double>(distanceBetween(leg.from, leg.to) / speed(m_generator)));
+}
+
+SimTime RandomWaypointMobility::start(std::uint32_t entity, const Position& position) {
+    if (entity >= m_legs.size()) m_legs.resize(entity + 1);
+    Leg& leg = m_legs[entity];
+    leg.to = position;
+    nextLeg(leg, SimTime::zero());
+    return std::min(leg.departure + m_config.updateInterval, leg.arrival);
+}
+
+Position RandomWaypointMobility::advance(std::uint32_t entity, SimTime time, SimTime& next) {
+    Leg& leg = m_legs[entity];
+    while (time >= leg.arrival) nextLeg(leg, leg.arrival);
+
+    if (time < leg.departure) {
+        // Pausing at the last waypoint
+        next = std::min(leg.departure + m_config.updateInterval, leg.arrival);
+        return leg.from;
+    }
+    next = std::min(time + m_config.updateInterval, leg.arrival);
+    return interpolate(leg.from, leg.to, fractionOf(time, leg.departure, leg.arrival));
+}
+
+void TraceMobility::addWaypoint(std::uint32_t entity, SimTime time, const Position& position) {
+    if (entity >= m_traces.size()) {
+        m_traces.resize(entity + 1);
+        m_cursor.resize(entity + 1, 0);
+    }
+    std::vector<Waypoint>& trace = m_traces[entity];
+    if (time < SimTime::zero() || (!trace.empty() && time <= trace.back().time)) {
+        throw WiFiSimulationException("Mobility trace times must increase");
+    }
+    trace.push_back(Waypoint{time, position});
+}
+
+void TraceMobility::load(std::istream& in) {
+    std::string line;
+    while (std::getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        double seconds;
+        std::uint32_t entity;
+        Position position;
+        if (!(fields >> seconds)) continue;  // Blank or comment
+        if (!(fields >> entity >> position.x >> position.y)) {
+            throw WiFiSimulationException("Malformed mobility trace line: " + line);
+        }
+        addWaypoint(entity, std::chrono::duration_cast<SimTime>(std::chrono::duration<double>(seconds)), position);
+    }
+}
+
+Position TraceMobility::positionAt(std::uint32_t entity, SimTime time) {
+    const std::vector<Waypoint>& trace = m_traces[entity];
+    std::uint32_t& cursor = m_cursor[entity];
+    while (cursor + 1 < trace.size() && trace[cursor + 1].time <= time) ++cursor;
+
+    if (time <= trace[cursor].time || cursor + 1 == trace.size()) return trace[cursor].position;
+    const Waypoint& from = trace[cursor];
+    const Waypoint& to = trace[cursor + 1];
+    return interpolate(from.position, to.position, fractionOf(time, from.time, to.time));
+}
+
+SimTime TraceMobility::nextUpdate(std::uint32_t entity, SimTime time) const {
+    const std::vector<Waypoint>& trace = m_traces[entity];
+    std::uint32_t cursor = m_cursor[entity];
+    if (time < trace[cursor].time) return trace[cursor].time;  // Before the first waypoint
+    if (cursor + 1 == trace.size()) return NEVER;
+
+    const Waypoint& from = trace[cursor];
+    const Waypoint& to = trace[cursor + 1];
+    bool stationary = from.position.x == to.position.x && from.position.y == to.position.y;
+    return stationary ? to.time : std::min(time + m_updateInterval, to.time);
+}
+
+SimTime TraceMobility::start(std::uint32_t entity, const Position&) {
+    if (entity >= m_traces.size() || m_traces[entity].empty()) return NEVER;
+    m_cursor[entity] = 0;
+    return SimTime::zero();  // The trace overrides the placement right away
+}
+
+Position TraceMobility::advance(std::uint32_t entity, SimTime time, SimTime& next) {
+    Position position = positionAt(entity, time);
+    next = nextUpdate(entity, time);
+    return position;
+}
@@ -0,0 +1,95 @@
+#ifndef MOBILITY_H
+#define MOBILITY_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <random>
+#include <vector>
+
+#include "wifi_common.h"
+#include "random_streams.h"
+
+// Where a set of entities are over simulated time. Positions are sampled
+// as events: advance() gives an entity's position at the event time and
+// the time of its next update, so entities at rest generate no events.
+// Each entity's updates come in increasing time order.
+class MobilityModel {
+public:
+    static constexpr SimTime NEVER = SimTime::max();
+
+    virtual ~MobilityModel() = default;
+
+    // Entity `entity` starts at `position` (its placement) at time zero;
+    // returns its first update time
+    virtual SimTime start(std::uint32_t entity, const Position& position) = 0;
+
+    // Position of `entity` at `time`; sets `next` to its next update time
+    virtual Position advance(std::uint32_t entity, SimTime time, SimTime& next) = 0;
+};
+
+struct RandomWaypointConfig {
+    Position low;                    // Area the waypoints are drawn from
+    Position high{100.0, 100.0};
+    double minSpeed = 0.5;           // m/s
+    double maxSpeed = 1.5;
+    SimTime maxPause = std::chrono::seconds(2);
+    SimTime updateInterval = std::chrono::milliseconds(100);  // Sampling while moving
+};
+
+// Random waypoint: pause, walk in a straight line to a uniformly drawn
+// waypoint at a uniformly drawn speed, repeat
+class RandomWaypointMobility : public MobilityModel {
+private:
+    struct Leg {
+        Position from;
+        Position to;
+        SimTime departure;
+        SimTime arrival;
+    };
+
+    RandomWaypointConfig m_config;
+    std::mt19937 m_generator;
+    std::vector<Leg> m_legs;
+
+    void nextLeg(Leg& leg, SimTime pausedSince);
+
+public:
+    explicit RandomWaypointMobility(const RandomWaypointConfig& config,
+                                    std::uint64_t seed = DEFAULT_SIMULATION_SEED);
+
+    SimTime start(std::uint32_t entity, const Position& position) override;
+    Position advance(std::uint32_t entity, SimTime time, SimTime& next) override;
+};
+
+// Trace-driven movement: per-entity waypoints (time, position), linearly
+// interpolated between them. Entities without a trace stay at their
+// placement; before its first waypoint an entity sits at that waypoint.
+class TraceMobility : public MobilityModel {
+private:
+    struct Waypoint {
+        SimTime time;
+        Position position;
+    };
+
+    SimTime m_updateInterval;
+    std::vector<std::vector<Waypoint>> m_traces;
+    std::vector<std::uint32_t> m_cursor;  // Current segment per entity
+
+    Position positionAt(std::uint32_t entity, SimTime time);
+    SimTime nextUpdate(std::uint32_t entity, SimTime time) const;
+
+public:
+    explicit TraceMobility(SimTime updateInterval = std::chrono::milliseconds(100))
+        : m_updateInterval(updateInterval) {}
+
+    // Waypoints of one entity must be added in increasing time order
+    void addWaypoint(std::uint32_t entity, SimTime time, const Position& position);
+
+    // Read "<time (s)> <entity> <x (m)> <y (m)>" lines; '#' starts a comment
+    void load(std::istream& in);
+
+    SimTime start(std::uint32_t entity, const Position& position) override;
+    Position advance(std::uint32_t entity, SimTime time, SimTime& next) override;
+};
+
+#endif // MOBILITY_H
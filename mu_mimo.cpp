@@ -0,0 +1,260 @@
+#include "mu_mimo.h"
+#include "WiFiSimulation.h"
+#include "profiler.h"
+#include "simd.h"
+#include "snapshot.h"
+#include <algorithm>
+#include <cmath>
+
+void ChannelStateMatrix::resize(size_t users, unsigned antennas) {
+    m_users = users;
+    m_stride = (users + 3) & ~static_cast<size_t>(3);
+    m_antennas = antennas;
+    m_real.assign(m_stride * antennas, 0.0f);
+    m_imag.assign(m_stride * antennas, 0.0f);
+}
+
+void ChannelStateMatrix::saveState(SnapshotWriter& out) const {
+    out.put<std::uint64_t>(m_users);
+    out.put(m_antennas);
+    out.putVector(m_real);
+    out.putVector(m_imag);
+}
+
+void ChannelStateMatrix::loadState(SnapshotReader& in) {
+    std::uint64_t users = in.get<std::uint64_t>();
+    unsigned antennas = in.get<unsigned>();
+    if (antennas > 8) throw WiFiSimulationException("Corrupt CSI in simulation snapshot");
+    resize(static_cast<size_t>(users), antennas);
+    const size_t elements = m_real.size();
+    in.getVector(m_real);
+    in.getVector(m_imag);
+    if (m_real.size() != elements || m_imag.size() != elements) {
+        throw WiFiSimulationException("Corrupt CSI in simulation snapshot");
+    }
+}
+
+#ifdef WIFI_SIMD
+
+using simd::Float4;
+using simd::load;
+using simd::store;
+using simd::broadcast;
+
+void mimo::channelNorms(const ChannelStateMatrix& channels, float* norms) {
+    for (size_t k = 0; k < channels.stride(); k += 4) {
+        Float4 sum = broadcast(0.0f);
+        for (unsigned a = 0; a < channels.antennas(); ++a) {
+            Float4 re = load(channels.real(a) + k);
+            Float4 im = load(channels.imag(a) + k);
+            sum += re * re + im * im;
+        }
+        store(norms + k, sum);
+    }
+}
+
+void mimo::correlate(const ChannelStateMatrix& channels, size_t j, float* real, float* imag) {
+    for (size_t k = 0; k < channels.stride(); k += 4) {
+        Float4 sumRe = broadcast(0.0f);
+        Float4 sumIm = broadcast(0.0f);
+        for (unsigned a = 0; a < channels.antennas(); ++a) {
+            // conj(h_j[a]) * h_k[a]
+            Float4 jRe = broadcast(channels.real(a)[j]);
+            Float4 jIm = broadcast(channels.imag(a)[j]);
+            Float4 re = load(channels.real(a) + k);
+            Float4 im = load(channels.imag(a) + k);
+            sumRe += jRe * re + jIm * im;
+            sumIm += jRe * im - jIm * re;
+        }
+        store(real + k, sumRe);
+        store(imag + k, sumIm);
+    }
+}
+
+#else
+
+void mimo::channelNorms(const ChannelStateMatrix& channels, float* norms) {
+    for (size_t k = 0; k < channels.stride(); ++k) {
+        float sum = 0.0f;
+        for (unsigned a = 0; a < channels.antennas(); ++a) {
+            float re = channels.real(a)[k];
+            float im = channels.imag(a)[k];
+            sum += re * re + im * im;
+        }
+        norms[k] = sum;
+    }
+}
+
+void mimo::correlate(const ChannelStateMatrix& channels, size_t j, float* real, float* imag) {
+    for (size_t k = 0; k < channels.stride(); ++k) {
+        float sumRe = 0.0f;
+        float sumIm = 0.0f;
+        for (unsigned a = 0; a < channels.antennas(); ++a) {
+            float jRe = channels.real(a)[j];
+            float jIm = channels.imag(a)[j];
+            float re = channels.real(a)[k];
+            float im = channels.imag(a)[k];
+            sumRe += jRe * re + jIm * im;
+            sumIm += jRe * im - jIm * re;
+        }
+        real[k] = sumRe;
+        imag[k] = sumIm;
+    }
+}
+
+#endif
+
+MuMimoEngine::MuMimoEngine(const MuMimoConfig& config)
+    : m_gaussian(0.0f, std::sqrt(0.5f)) {
+    setConfig(config);
+}
+
+void MuMimoEngine::setConfig(const MuMimoConfig& config) {
+    if (config.antennas == 0 || config.antennas > 8 || config.maxGroupSize == 0 ||
+        config.candidatePool == 0 || !(config.correlationThreshold > 0.0)) {
+        throw WiFiSimulationException("Invalid MU-MIMO configuration");
+    }
+    m_config = config;
+    m_config.maxGroupSize = std::min(config.maxGroupSize, config.antennas);
+}
+
+void MuMimoEngine::sound(size_t users, std::mt19937& generator) {
+    // Unit-power circularly symmetric Gaussian entries: CN(0, 1)
+    m_csi.resize(users, m_config.antennas);
+    for (unsigned a = 0; a < m_config.antennas; ++a) {
+        float* re = m_csi.real(a);
+        float* im = m_csi.imag(a);
+        for (size_t k = 0; k < users; ++k) {
+            re[k] = m_gaussian(generator);
+            im[k] = m_gaussian(generator);
+        }
+    }
+}
+
+void MuMimoEngine::formGroup(const std::vector<StationId>& candidates,
+                             std::vector<StationId>& group, std::vector<float>& sinr) {
+    PROFILE_SCOPE("MuMimoEngine::formGroup");
+    group.clear();
+    sinr.clear();
+    if (candidates.empty()) return;
+
+    // Gather the pool's channels so the kernels run over contiguous lanes
+    const size_t poolSize = std::min<size_t>(candidates.size(), m_config.candidatePool);
+    const unsigned antennas = m_config.antennas;
+    m_pool.resize(poolSize, antennas);
+    for (unsigned a = 0; a < antennas; ++a) {
+        const float* re = m_csi.real(a);
+        const float* im = m_csi.imag(a);
+        float* poolRe = m_pool.real(a);
+        float* poolIm = m_pool.imag(a);
+        for (size_t k = 0; k < poolSize; ++k) {
+            if (candidates[k] >= m_csi.users()) {
+                throw WiFiSimulationException("MU-MIMO candidate has no CSI");
+            }
+            poolRe[k] = re[candidates[k]];
+            poolIm[k] = im[candidates[k]];
+        }
+    }
+
+    const size_t stride = m_pool.stride();
+    m_norms.resize(stride);
+    mimo::channelNorms(m_pool, m_norms.data());
+    m_maxCorrelation.assign(stride, 0.0f);
+    m_correlationReal.resize(stride * m_config.maxGroupSize);
+    m_correlationImag.resize(stride * m_config.maxGroupSize);
+
+    // Greedy near-orthogonal selection in candidate order
+    const float threshold = static_cast<float>(m_config.correlationThreshold * m_config.correlationThreshold);
+    m_members.clear();
+    for (size_t k = 0; k < poolSize && m_members.size() < m_config.maxGroupSize; ++k) {
+        if (!m_members.empty() && m_maxCorrelation[k] >= threshold) continue;
+        if (!(m_norms[k] > 0.0f)) continue;
+
+        float* rowRe = m_correlationReal.data() + m_members.size() * stride;
+        float* rowIm = m_correlationImag.data() + m_members.size() * stride;
+        mimo::correlate(m_pool, k, rowRe, rowIm);
+        m_members.push_back(k);
+
+        // Normalized |h_k^H h_i|^2 / (|h_k|^2 |h_i|^2), worst over the members
+        for (size_t i = 0; i < poolSize; ++i) {
+            float c = (rowRe[i] * rowRe[i] + rowIm[i] * rowIm[i]) / (m_norms[k] * m_norms[i]);
+            m_maxCorrelation[i] = std::max(m_maxCorrelation[i], c);
+        }
+    }
+
+    // Precode; members too weak after zero forcing leave, latest first
+    while (!zeroForce(sinr) && m_members.size() > 1) {
+        m_members.pop_back();
+    }
+    for (size_t member : m_members) {
+        group.push_back(candidates[member]);
+    }
+}
+
+bool MuMimoEngine::zeroForce(std::vector<float>& sinr) {
+    const size_t g = m_members.size();
+    const size_t stride = m_pool.stride();
+    const unsigned antennas = m_config.antennas;
+
+    // Gram matrix G = H H^H from the correlation rows, G[i][l] = conj(h_i^H h_l);
+    // Gauss-Jordan inversion in place alongside an identity
+    m_gram.assign(g * 2 * g, std::complex<float>(0.0f, 0.0f));
+    auto cell = [this, g](size_t row, size_t column) -> std::complex<float>& {
+        return m_gram[row * 2 * g + column];
+    };
+    for (size_t i = 0; i < g; ++i) {
+        for (size_t l = 0; l < g; ++l) {
+            size_t index = i * stride + m_members[l];
+            cell(i, l) = std::complex<float>(m_correlationReal[index], -m_correlationImag[index]);
+        }
+        cell(i, g + i) = 1.0f;
+    }
+    for (size_t pivot = 0; pivot < g; ++pivot) {
+        std::complex<float> scale = cell(pivot, pivot);
+        if (std::abs(scale) < 1e-6f) return false;  // Degenerate group
+        for (size_t column = 0; column < 2 * g; ++column) cell(pivot, column) /= scale;
+        for (size_t row = 0; row < g; ++row) {
+            if (row == pivot) continue;
+            std::complex<float> factor = cell(row, pivot);
+            for (size_t column = 0; column < 2 * g; ++column) {
+                cell(row, column) -= factor * cell(pivot, column);
+            }
+        }
+    }
+
+    // W = H^H G^-1; column k is member k's beam
+    m_precoder.assign(antennas * g, std::complex<float>(0.0f, 0.0f));
+    for (unsigned a = 0; a < antennas; ++a) {
+        for (size_t i = 0; i < g; ++i) {
+            std::complex<float> h = std::conj(m_pool.get(m_members[i], a));
+            for (size_t k = 0; k < g; ++k) {
+                m_precoder[a * g + k] += h * cell(i, g + k);
+            }
+        }
+    }
+
+    // Equal power per stream after normalizing each beam
+    const float snr = static_cast<float>(std::pow(10.0, m_config.snrDb / 10.0));
+    const float minSinr = static_cast<float>(std::pow(10.0, m_config.minSinrDb / 10.0));
+    sinr.assign(g, 0.0f);
+    bool allUsable = true;
+    for (size_t k = 0; k < g; ++k) {
+        float beamPower = 0.0f;
+        for (unsigned a = 0; a < antennas; ++a) beamPower += std::norm(m_precoder[a * g + k]);
+        sinr[k] = snr / (static_cast<float>(g) * beamPower);
+        if (sinr[k] < minSinr) allUsable = false;
+    }
+    return allUsable;
+}
+
+void MuMimoEngine::saveState(SnapshotWriter& out) const {
+    out.put(m_config);
+    m_csi.saveState(out);
+    out.putRandomState(m_gaussian);
+}
+
+void MuMimoEngine::loadState(SnapshotReader& in) {
+    setConfig(in.get<MuMimoConfig>());
+    m_csi.loadState(in);
+    in.getRandomState(m_gaussian);
+}
@@ -0,0 +1,128 @@
+#ifndef MU_MIMO_H
+#define MU_MIMO_H
+
+#include <complex>
+#include <random>
+#include <vector>
+
+#include "station_table.h"
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// Downlink MU-MIMO parameters of an access point
+struct MuMimoConfig {
+    unsigned antennas = 4;               // AP transmit antennas (1-8)
+    unsigned maxGroupSize = 4;           // Users per group (at most `antennas`)
+    double snrDb = 25.0;                 // Per-user receive SNR at full power
+    double correlationThreshold = 0.5;   // Max normalized |h_i^H h_j| within a group
+    double minSinrDb = 0.0;              // Members below this after precoding are dropped
+    unsigned candidatePool = 64;         // Backlogged users considered per group
+};
+
+// Complex channel vectors of a set of users, one per AP antenna, stored
+// antenna-major as separate real and imaginary planes: element (user,
+// antenna) is at [antenna * stride() + user]. Kernels thus walk users with
+// unit stride, several at a time. The stride is padded to a multiple of 4.
+class ChannelStateMatrix {
+private:
+    size_t m_users;
+    size_t m_stride;
+    unsigned m_antennas;
+    std::vector<float> m_real;
+    std::vector<float> m_imag;
+
+public:
+    ChannelStateMatrix() : m_users(0), m_stride(0), m_antennas(0) {}
+
+    // Reshape; contents are unspecified afterwards
+    void resize(size_t users, unsigned antennas);
+
+    size_t users() const { return m_users; }
+    size_t stride() const { return m_stride; }
+    unsigned antennas() const { return m_antennas; }
+
+    float* real(unsigned antenna) { return m_real.data() + antenna * m_stride; }
+    float* imag(unsigned antenna) { return m_imag.data() + antenna * m_stride; }
+    const float* real(unsigned antenna) const { return m_real.data() + antenna * m_stride; }
+    const float* imag(unsigned antenna) const { return m_imag.data() + antenna * m_stride; }
+
+    std::complex<float> get(size_t user, unsigned antenna) const {
+        return {real(antenna)[user], imag(antenna)[user]};
+    }
+    void set(size_t user, unsigned antenna, std::complex<float> value) {
+        real(antenna)[user] = value.real();
+        imag(antenna)[user] = value.imag();
+    }
+
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+};
+
+// Data-parallel kernels over a ChannelStateMatrix, four users per vector
+// operation (see simd.h)
+namespace mimo {
+
+// Squared norm |h_k|^2 of every user's channel
+void channelNorms(const ChannelStateMatrix& channels, float* norms);
+
+// Correlation h_j^H h_k between user `j` and every user k
+void correlate(const ChannelStateMatrix& channels, size_t j, float* real, float* imag);
+
+} // namespace mimo
+
+// MU-MIMO engine of an access point: holds the CSI of the last sounding
+// round, forms near-orthogonal user groups and zero-forcing precodes them.
+//
+// Grouping is greedy: the first candidate anchors the group, and each
+// further candidate joins if its normalized correlation with every member
+// stays under the threshold. Each member adds one correlation pass over
+// the pool, so forming a group costs O(group x pool x antennas),
+// independent of the number of users. Zero forcing then inverts the
+// group's Gram matrix H H^H; the precoder is W = H^H (H H^H)^-1 with power
+// split equally over the streams, so member k gets an SINR of
+// SNR / (group size * ||w_k||^2).
+class MuMimoEngine {
+private:
+    MuMimoConfig m_config;
+    ChannelStateMatrix m_csi;   // Every sounded user
+    ChannelStateMatrix m_pool;  // Candidates of the group being formed
+    std::normal_distribution<float> m_gaussian;
+
+    // Scratch space reused by every group
+    std::vector<float> m_norms;
+    std::vector<float> m_maxCorrelation;
+    std::vector<float> m_correlationReal;  // One pool-wide row per member
+    std::vector<float> m_correlationImag;
+    std::vector<size_t> m_members;           // Pool indices
+    std::vector<std::complex<float>> m_gram;
+    std::vector<std::complex<float>> m_precoder;  // antennas x members, column per member
+
+    bool zeroForce(std::vector<float>& sinr);
+
+public:
+    explicit MuMimoEngine(const MuMimoConfig& config = MuMimoConfig());
+
+    void setConfig(const MuMimoConfig& config);
+    const MuMimoConfig& getConfig() const { return m_config; }
+
+    // New sounding round: draw i.i.d. Rayleigh channels for `users` users
+    void sound(size_t users, std::mt19937& generator);
+    const ChannelStateMatrix& getChannelState() const { return m_csi; }
+
+    // Form one group from `candidates` (sounded stations, first = anchor)
+    // and precode it; fills the members and their linear SINRs
+    void formGroup(const std::vector<StationId>& candidates,
+                   std::vector<StationId>& group, std::vector<float>& sinr);
+
+    // Precoder of the last group: weight of antenna `a` for member `k`
+    std::complex<float> getPrecoderWeight(unsigned antenna, size_t member) const {
+        return m_precoder[antenna * m_members.size() + member];
+    }
+
+    // Configuration, CSI and the channel draw's state (not the last group)
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+};
+
+#endif // MU_MIMO_H
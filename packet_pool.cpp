@@ -0,0 +1,130 @@
+#include "packet_pool.h"
+#include "wifi_common.h"
+#include "snapshot.h"
+#include <cstring>
+
+PacketPool::PacketPool()
+    : m_used(0),
+      m_liveDescriptors(0) {}
+
+PacketPool::PacketPool(const PacketPool& other)
+    : m_used(0),
+      m_liveDescriptors(0) {
+    *this = other;
+}
+
+PacketPool& PacketPool::operator=(const PacketPool& other) {
+    if (this == &other) return *this;
+    m_slabs.clear();
+    m_freeList.clear();
+    for (const std::unique_ptr<Slab>& slab : other.m_slabs) {
+        m_slabs.push_back(std::make_unique<Slab>(*slab));
+    }
+    m_freeList.reserve(getCapacity());
+    m_freeList.insert(m_freeList.end(), other.m_freeList.begin(), other.m_freeList.end());
+    m_used = other.m_used;
+    m_liveDescriptors = other.m_liveDescriptors;
+    m_payloadBytes = other.m_payloadBytes;
+    m_payloadExtents = other.m_payloadExtents;
+    return *this;
+}
+
+void PacketPool::addSlab() {
+    if (m_slabs.size() >= (NO_PACKET >> SLAB_SHIFT)) {
+        throw WiFiSimulationException("Packet pool exhausted");
+    }
+    m_slabs.push_back(std::make_unique<Slab>());
+    m_freeList.reserve(getCapacity());
+}
+
+void PacketPool::reserve(size_t count) {
+    while (getCapacity() < count) {
+        addSlab();
+    }
+}
+
+PacketHandle PacketPool::allocate(const PacketDescriptor& descriptor) {
+    PacketHandle handle;
+    if (!m_freeList.empty()) {
+        handle = m_freeList.back();
+        m_freeList.pop_back();
+    } else {
+        if (m_used == getCapacity()) {
+            addSlab();
+        }
+        handle = m_used++;
+    }
+
+    get(handle) = descriptor;
+    ++m_liveDescriptors;
+    return handle;
+}
+
+void PacketPool::release(PacketHandle handle) {
+    // Capacity was reserved when the slab was added, so this never reallocates
+    m_freeList.push_back(handle);
+    --m_liveDescriptors;
+}
+
+PayloadHandle PacketPool::storePayload(const void* data, size_t length) {
+    if (m_payloadExtents.size() >= NO_PAYLOAD ||
+        m_payloadBytes.size() + length > UINT32_MAX) {
+        throw WiFiSimulationException("Payload arena exhausted");
+    }
+
+    std::uint32_t offset = static_cast<std::uint32_t>(m_payloadBytes.size());
+    m_payloadBytes.resize(m_payloadBytes.size() + length);
+    if (length > 0) {
+        std::memcpy(m_payloadBytes.data() + offset, data, length);
+    }
+    m_payloadExtents.emplace_back(offset, static_cast<std::uint32_t>(length));
+    return static_cast<PayloadHandle>(m_payloadExtents.size() - 1);
+}
+
+std::pair<const std::uint8_t*, size_t> PacketPool::getPayload(PayloadHandle handle) const {
+    if (handle == NO_PAYLOAD || handle >= m_payloadExtents.size()) {
+        return {nullptr, 0};
+    }
+    const auto& extent = m_payloadExtents[handle];
+    return {m_payloadBytes.data() + extent.first, extent.second};
+}
+
+void PacketPool::reset() {
+    m_freeList.clear();
+    m_used = 0;
+    m_liveDescriptors = 0;
+    m_payloadBytes.clear();
+    m_payloadExtents.clear();
+}
+
+void PacketPool::saveState(SnapshotWriter& out) const {
+    out.put(m_used);
+    out.put<std::uint64_t>(m_liveDescriptors);
+    for (std::uint32_t slab = 0; slab * SLAB_SIZE < m_used; ++slab) {
+        const std::uint32_t left = m_used - slab * SLAB_SIZE;
+        const std::uint32_t count = left < SLAB_SIZE ? left : SLAB_SIZE;
+        out.putBytes(m_slabs[slab]->descriptors, count * sizeof(PacketDescriptor));
+    }
+    out.putVector(m_freeList);
+    out.putVector(m_payloadBytes);
+    out.putVector(m_payloadExtents);
+}
+
+void PacketPool::loadState(SnapshotReader& in) {
+    reset();
+    in.get(m_used);
+    m_liveDescriptors = static_cast<size_t>(in.get<std::uint64_t>());
+    reserve(m_used);
+    for (std::uint32_t slab = 0; slab * SLAB_SIZE < m_used; ++slab) {
+        const std::uint32_t left = m_used - slab * SLAB_SIZE;
+        const std::uint32_t count = left < SLAB_SIZE ? left : SLAB_SIZE;
+        in.getBytes(m_slabs[slab]->descriptors, count * sizeof(PacketDescriptor));
+    }
+    in.getVector(m_freeList);
+    in.getVector(m_payloadBytes);
+    in.getVector(m_payloadExtents);
+    if (m_freeList.size() > m_used || m_liveDescriptors != m_used - m_freeList.size()) {
+        throw WiFiSimulationException("Corrupt packet pool in simulation snapshot");
+    }
+    m_freeList.reserve(getCapacity());
+}
@@ -0,0 +1,99 @@
+#ifndef PACKET_POOL_H
+#define PACKET_POOL_H
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "event_scheduler.h"
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// Handles into a PacketPool; stable for the life of the packet
+using PacketHandle = std::uint32_t;
+using PayloadHandle = std::uint32_t;
+const PacketHandle NO_PACKET = UINT32_MAX;
+const PayloadHandle NO_PAYLOAD = UINT32_MAX;
+
+// 802.11e access categories, lowest priority first
+enum class AccessCategory : std::uint8_t {
+    BACKGROUND = 0,
+    BEST_EFFORT = 1,
+    VIDEO = 2,
+    VOICE = 3
+};
+
+// Compact, payload-free packet descriptor (24 bytes). The simulation only
+// needs sizes and timestamps; bytes, if any, live in the pool's payload arena.
+struct PacketDescriptor {
+    SimTime enqueueTime = SimTime::zero();
+    std::uint32_t sizeBytes = 1024;
+    std::uint32_t flowId = 0;
+    PayloadHandle payload = NO_PAYLOAD;
+    AccessCategory accessCategory = AccessCategory::BEST_EFFORT;
+};
+
+// Slab allocator for packet descriptors. Descriptors are carved out of
+// fixed-size slabs and recycled through a free list, so once the pool has
+// grown to the peak number of in-flight packets, allocate/release never touch
+// the system allocator.
+class PacketPool {
+private:
+    static const std::uint32_t SLAB_SHIFT = 12;
+    static const std::uint32_t SLAB_SIZE = 1u << SLAB_SHIFT;  // Descriptors per slab
+
+    struct Slab {
+        PacketDescriptor descriptors[SLAB_SIZE];
+    };
+
+    std::vector<std::unique_ptr<Slab>> m_slabs;
+    std::vector<PacketHandle> m_freeList;
+    std::uint32_t m_used;          // Slots handed out since the last reset
+    size_t m_liveDescriptors;
+
+    // Optional payload bytes, bump-allocated and only reclaimed by reset()
+    std::vector<std::uint8_t> m_payloadBytes;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> m_payloadExtents;  // offset, length
+
+    void addSlab();
+
+public:
+    PacketPool();
+
+    // Copies hold their own slabs with the same handles
+    PacketPool(const PacketPool& other);
+    PacketPool& operator=(const PacketPool& other);
+    PacketPool(PacketPool&&) = default;
+    PacketPool& operator=(PacketPool&&) = default;
+
+    // Make room for `count` live descriptors without further allocation
+    void reserve(size_t count);
+
+    PacketHandle allocate(const PacketDescriptor& descriptor);
+    void release(PacketHandle handle);
+
+    PacketDescriptor& get(PacketHandle handle) {
+        return m_slabs[handle >> SLAB_SHIFT]->descriptors[handle & (SLAB_SIZE - 1)];
+    }
+    const PacketDescriptor& get(PacketHandle handle) const {
+        return m_slabs[handle >> SLAB_SHIFT]->descriptors[handle & (SLAB_SIZE - 1)];
+    }
+
+    // Copy payload bytes into the arena; the handle stays valid until reset()
+    PayloadHandle storePayload(const void* data, size_t length);
+    std::pair<const std::uint8_t*, size_t> getPayload(PayloadHandle handle) const;
+
+    // Invalidate every descriptor and payload at once, keeping the memory
+    void reset();
+
+    size_t getLiveDescriptors() const { return m_liveDescriptors; }
+    size_t getCapacity() const { return m_slabs.size() * SLAB_SIZE; }
+
+    // Slots handed out so far, free list and payloads (see snapshot.h)
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+};
+
+#endif // PACKET_POOL_H
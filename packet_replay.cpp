@@ -0,0 +1,228 @@
+#include "packet_replay.h"
+#include "WiFiSimulation.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char REPLAY_MAGIC[4] = {'W', 'R', 'P', 'L'};
+const std::uint32_t REPLAY_VERSION = 1;
+
+// pcap link types
+const std::uint32_t LINKTYPE_ETHERNET = 1;
+const std::uint32_t LINKTYPE_IEEE802_11 = 105;
+const std::uint32_t LINKTYPE_RADIOTAP = 127;
+
+// Leading bytes of a packet needed to find its addresses
+const size_t PEEK_BYTES = 128;
+
+struct PcapFormat {
+    bool swapped = false;      // Written on a host of the other byte order
+    bool nanoseconds = false;
+    std::uint32_t linkType = 0;
+};
+
+std::uint32_t toHost(std::uint32_t value, bool swapped) {
+    if (!swapped) return value;
+    return (value >> 24) | ((value >> 8) & 0xff00) | ((value << 8) & 0xff0000) | (value << 24);
+}
+
+std::uint64_t readMac(const std::uint8_t* bytes) {
+    std::uint64_t mac = 0;
+    for (int i = 0; i < 6; ++i) mac = (mac << 8) | bytes[i];
+    return mac;
+}
+
+PcapFormat readPcapHeader(std::istream& in) {
+    std::uint32_t header[6];
+    if (!in.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        throw WiFiSimulationException("Truncated pcap header");
+    }
+    PcapFormat format;
+    switch (header[0]) {
+    case 0xa1b2c3d4: break;
+    case 0xd4c3b2a1: format.swapped = true; break;
+    case 0xa1b23c4d: format.nanoseconds = true; break;
+    case 0x4d3cb2a1: format.swapped = true; format.nanoseconds = true; break;
+    default: throw WiFiSimulationException("Not a pcap file (pcapng is not supported)");
+    }
+    format.linkType = toHost(header[5], format.swapped) & 0xffff;
+    if (format.linkType != LINKTYPE_ETHERNET && format.linkType != LINKTYPE_IEEE802_11 &&
+        format.linkType != LINKTYPE_RADIOTAP) {
+        throw WiFiSimulationException("Unsupported pcap link type " + std::to_string(format.linkType));
+    }
+    return format;
+}
+
+// Station MAC and payload length of one packet; false if it carries no data
+bool parsePacket(const PcapFormat& format, const std::uint8_t* bytes, size_t captured,
+                 std::uint32_t wireLength, bool byDestination, std::uint64_t& mac, std::uint32_t& size) {
+    if (format.linkType == LINKTYPE_ETHERNET) {
+        if (captured < 12) return false;
+        mac = readMac(bytes + (byDestination ? 0 : 6));
+        size = wireLength;
+        return true;
+    }
+
+    size_t offset = 0;
+    if (format.linkType == LINKTYPE_RADIOTAP) {
+        if (captured < 4) return false;
+        offset = bytes[2] | (bytes[3] << 8);  // Radiotap length is always little endian
+    }
+    // 802.11 data frames only: frame control, duration, addr1 (receiver), addr2 (transmitter)
+    if (captured < offset + 16 || wireLength < offset) return false;
+    const std::uint8_t frameType = (bytes[offset] >> 2) & 0x3;
+    if (frameType != 2) return false;
+    mac = readMac(bytes + offset + (byDestination ? 4 : 10));
+    size = static_cast<std::uint32_t>(wireLength - offset);
+    return true;
+}
+
+} // namespace
+
+PcapConvertResult convertPcap(const std::string& pcapPath, const std::string& replayPath,
+                              const PcapConvertOptions& options) {
+    std::ifstream in(pcapPath, std::ios::binary);
+    if (!in) throw WiFiSimulationException("Cannot open capture " + pcapPath);
+    std::ofstream out(replayPath, std::ios::binary | std::ios::trunc);
+    if (!out) throw WiFiSimulationException("Cannot create replay file " + replayPath);
+
+    const PcapFormat format = readPcapHeader(in);
+
+    ReplayHeader header;
+    std::memcpy(header.magic, REPLAY_MAGIC, 4);
+    header.version = REPLAY_VERSION;
+    header.recordSize = sizeof(ReplayRecord);
+    header.stations = 0;  // Patched once known
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    PcapConvertResult result;
+    std::unordered_map<std::uint64_t, std::uint32_t> stationOf;
+    std::vector<ReplayRecord> pending;
+    pending.reserve(4096);
+    std::vector<std::uint8_t> bytes(PEEK_BYTES);
+    std::int64_t firstTime = 0;
+    std::int64_t lastTime = 0;
+    std::uint32_t maxStation = 0;
+
+    std::uint32_t record[4];  // ts_sec, ts_frac, captured length, wire length
+    while (in.read(reinterpret_cast<char*>(record), sizeof(record))) {
+        const std::int64_t seconds = toHost(record[0], format.swapped);
+        const std::int64_t fraction = toHost(record[1], format.swapped);
+        const std::uint32_t captured = toHost(record[2], format.swapped);
+        const std::uint32_t wireLength = toHost(record[3], format.swapped);
+
+        const size_t peek = std::min<size_t>(captured, PEEK_BYTES);
+        if (!in.read(reinterpret_cast<char*>(bytes.data()), peek) ||
+            !in.ignore(captured - peek) || in.gcount() != static_cast<std::streamsize>(captured - peek)) {
+            throw WiFiSimulationException("Truncated packet in " + pcapPath);
+        }
+
+        std::uint64_t mac;
+        std::uint32_t size;
+        if (!parsePacket(format, bytes.data(), peek, wireLength, options.byDestination, mac, size)) {
+            ++result.skipped;
+            continue;
+        }
+
+        std::int64_t time = seconds * 1000000000 + fraction * (format.nanoseconds ? 1 : 1000);
+        if (result.packets == 0) firstTime = time;
+        time -= firstTime;
+        if (time < lastTime) throw WiFiSimulationException("Capture timestamps go backwards in " + pcapPath);
+        lastTime = time;
+
+        auto found = stationOf.emplace(mac, static_cast<std::uint32_t>(stationOf.size()));
+        std::uint32_t station = found.first->second;
+        if (options.stations > 0) station %= options.stations;
+        maxStation = std::max(maxStation, station);
+
+        pending.push_back(ReplayRecord{time, station, size});
+        ++result.packets;
+        if (pending.size() == pending.capacity()) {
+            out.write(reinterpret_cast<const char*>(pending.data()), pending.size() * sizeof(ReplayRecord));
+            pending.clear();
+        }
+    }
+    out.write(reinterpret_cast<const char*>(pending.data()), pending.size() * sizeof(ReplayRecord));
+
+    result.stations = result.packets > 0 ? maxStation + 1 : 0;
+    header.stations = result.stations;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out) throw WiFiSimulationException("Failed to write replay file " + replayPath);
+    return result;
+}
+
+ReplaySource::ReplaySource(const std::string& path)
+    : m_header(nullptr), m_records(nullptr), m_count(0), m_mappedBytes(0) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw WiFiSimulationException("Cannot open replay file " + path);
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(ReplayHeader)) {
+        ::close(fd);
+        throw WiFiSimulationException("Not a replay file: " + path);
+    }
+    m_mappedBytes = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, m_mappedBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping keeps the file open
+    if (mapping == MAP_FAILED) throw WiFiSimulationException("Cannot map replay file " + path);
+    ::madvise(mapping, m_mappedBytes, MADV_SEQUENTIAL);
+
+    m_header = static_cast<const ReplayHeader*>(mapping);
+    m_records = reinterpret_cast<const ReplayRecord*>(m_header + 1);
+    m_count = (m_mappedBytes - sizeof(ReplayHeader)) / sizeof(ReplayRecord);
+    if (std::memcmp(m_header->magic, REPLAY_MAGIC, 4) != 0 || m_header->version != REPLAY_VERSION ||
+        m_header->recordSize != sizeof(ReplayRecord) ||
+        (m_mappedBytes - sizeof(ReplayHeader)) % sizeof(ReplayRecord) != 0) {
+        unmap();
+        throw WiFiSimulationException("Not a replay file: " + path);
+    }
+}
+
+ReplaySource::~ReplaySource() {
+    unmap();
+}
+
+ReplaySource::ReplaySource(ReplaySource&& other) noexcept
+    : m_header(other.m_header), m_records(other.m_records),
+      m_count(other.m_count), m_mappedBytes(other.m_mappedBytes) {
+    other.m_header = nullptr;
+    other.m_mappedBytes = 0;
+}
+
+ReplaySource& ReplaySource::operator=(ReplaySource&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        m_header = other.m_header;
+        m_records = other.m_records;
+        m_count = other.m_count;
+        m_mappedBytes = other.m_mappedBytes;
+        other.m_header = nullptr;
+        other.m_mappedBytes = 0;
+    }
+    return *this;
+}
+
+void ReplaySource::release(std::uint64_t record) const {
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t bytes = sizeof(ReplayHeader) + std::min(record, m_count) * sizeof(ReplayRecord);
+    const size_t whole = bytes / page * page;
+    if (whole > 0) ::madvise(const_cast<ReplayHeader*>(m_header), whole, MADV_DONTNEED);
+}
+
+void ReplaySource::unmap() {
+    if (m_header) ::munmap(const_cast<ReplayHeader*>(m_header), m_mappedBytes);
+    m_header = nullptr;
+    m_records = nullptr;
+    m_count = 0;
+}
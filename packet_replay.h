@@ -0,0 +1,81 @@
+#ifndef PACKET_REPLAY_H
+#define PACKET_REPLAY_H
+
+#include <cstdint>
+#include <string>
+
+// One packet of a replay file: arrival time since the start of the
+// capture, the station it belongs to and its length. Records are sorted by
+// time, so a replay is one sequential pass.
+struct ReplayRecord {
+    std::int64_t timeNs;
+    std::uint32_t station;
+    std::uint32_t sizeBytes;
+};
+static_assert(sizeof(ReplayRecord) == 16, "Replay records are 16 bytes on disk");
+
+// Replay file layout (little endian): "WRPL", a u32 version, a u32 record
+// size, a u32 station count (highest station id + 1), then the records.
+struct ReplayHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t recordSize;
+    std::uint32_t stations;
+};
+static_assert(sizeof(ReplayHeader) == 16, "Replay records start 16-byte aligned");
+
+// How pcap packets are turned into replay records
+struct PcapConvertOptions {
+    bool byDestination = false;  // Key stations on the destination MAC (downlink) instead of the source
+    std::uint32_t stations = 0;  // Fold station ids into this many stations (0 = one per MAC)
+};
+
+// Counts of a finished conversion
+struct PcapConvertResult {
+    std::uint64_t packets = 0;   // Records written
+    std::uint64_t skipped = 0;   // Non-data 802.11 frames and truncated headers
+    std::uint32_t stations = 0;  // Distinct stations in the output
+};
+
+// Convert a classic pcap capture (Ethernet, raw 802.11 or radiotap 802.11
+// link types; microsecond or nanosecond timestamps, either byte order) to a
+// replay file. Each distinct MAC becomes a station, numbered in order of
+// first appearance; times are relative to the first packet and must not go
+// backwards. Streams the capture, so file sizes are not limited by memory.
+PcapConvertResult convertPcap(const std::string& pcapPath, const std::string& replayPath,
+                              const PcapConvertOptions& options = PcapConvertOptions());
+
+// Read-only memory mapping of a replay file. Records are used in place:
+// the kernel pages them in as a replay walks forward, so multi-GB files
+// replay in bounded memory. Move-only; unmapped on destruction.
+class ReplaySource {
+private:
+    const ReplayHeader* m_header;
+    const ReplayRecord* m_records;
+    std::uint64_t m_count;
+    size_t m_mappedBytes;
+
+    void unmap();
+
+public:
+    explicit ReplaySource(const std::string& path);
+    ~ReplaySource();
+
+    ReplaySource(ReplaySource&& other) noexcept;
+    ReplaySource& operator=(ReplaySource&& other) noexcept;
+    ReplaySource(const ReplaySource&) = delete;
+    ReplaySource& operator=(const ReplaySource&) = delete;
+
+    std::uint64_t size() const { return m_count; }
+    std::uint32_t getStationCount() const { return m_header->stations; }
+    const ReplayRecord& operator[](std::uint64_t index) const { return m_records[index]; }
+    const ReplayRecord* begin() const { return m_records; }
+    const ReplayRecord* end() const { return m_records + m_count; }
+
+    // Drop the resident pages of records before `record`; they are read
+    // back from the file if used again. Keeps a long replay's footprint to
+    // the pages in use.
+    void release(std::uint64_t record) const;
+};
+
+#endif // PACKET_REPLAY_H
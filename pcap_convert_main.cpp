@@ -0,0 +1,30 @@
+#include "packet_replay.h"
+#include "WiFiSimulation.h"
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char* argv[]) {
+    try {
+        // Usage: pcapconvert <capture.pcap> <replay file> [stations] [src|dst]
+        if (argc < 3) {
+            std::cerr << "Usage: pcapconvert <capture.pcap> <replay file> [stations] [src|dst]\n";
+            return 1;
+        }
+        PcapConvertOptions options;
+        if (argc > 3) options.stations = static_cast<std::uint32_t>(std::strtoul(argv[3], nullptr, 10));
+        if (argc > 4) options.byDestination = std::strcmp(argv[4], "dst") == 0;
+
+        PcapConvertResult result = convertPcap(argv[1], argv[2], options);
+        std::cout << result.packets << " packets from " << result.stations << " stations written to "
+                  << argv[2] << " (" << result.skipped << " non-data frames skipped)\n";
+        return 0;
+    }
+    catch (const WiFiSimulationException& e) {
+        std::cerr << "Simulation Error: " << e.what() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Unexpected Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
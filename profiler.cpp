@@ -0,0 +1,258 @@
+#include "profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+
+#ifdef WIFI_PROFILE
+
+// Count every heap allocation, per thread
+void* operator new(std::size_t size) {
+    profiler::noteAllocation();
+    if (void* p = std::malloc(size > 0 ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace profiler {
+
+thread_local std::uint64_t t_allocations = 0;
+
+namespace {
+
+const size_t DEFAULT_TRACE_EVENTS = 1000000;
+
+void writeAtExit();
+
+// Every thread's profile. Profiles are kept after their thread exits, so
+// pool workers still show up in the report written at exit.
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadProfile>> threads;
+    size_t traceEvents;
+    std::uint64_t startTicks;
+    std::chrono::steady_clock::time_point startTime;
+
+    Registry() : traceEvents(0) {
+        if (std::getenv("WIFI_PROFILE_TRACE")) {
+            const char* limit = std::getenv("WIFI_PROFILE_TRACE_EVENTS");
+            traceEvents = limit ? static_cast<size_t>(std::strtoull(limit, nullptr, 10)) : DEFAULT_TRACE_EVENTS;
+        }
+        startTime = std::chrono::steady_clock::now();
+        startTicks = readTicks();
+        std::atexit(writeAtExit);
+    }
+};
+
+// Never destroyed, so it outlives the threads and statics that still use it at exit
+Registry& registry() {
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+// Nanoseconds per tick, measured against steady_clock since the first
+// profiled scope (at least 10 ms)
+double nanosecondsPerTick() {
+#if defined(__x86_64__) || defined(__i386__)
+    const Registry& state = registry();
+    std::chrono::steady_clock::duration elapsed;
+    std::uint64_t ticks;
+    do {
+        elapsed = std::chrono::steady_clock::now() - state.startTime;
+        ticks = readTicks() - state.startTicks;
+    } while (elapsed < std::chrono::milliseconds(10));
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(ticks);
+#else
+    return 1.0;
+#endif
+}
+
+// "outer;inner" path of a node
+std::string stackOf(const ThreadProfile& thread, std::uint32_t node) {
+    std::string path = thread.nodes[node].name;
+    for (node = thread.nodes[node].parent; node != 0; node = thread.nodes[node].parent) {
+        path = std::string(thread.nodes[node].name) + ";" + path;
+    }
+    return path;
+}
+
+void writeFile(const char* variable, void (*write)(std::ostream&)) {
+    const char* path = std::getenv(variable);
+    if (!path) return;
+    std::ofstream out(path, std::ios::trunc);
+    if (out) write(out);
+    if (!out) std::cerr << "Cannot write profile to " << path << "\n";
+}
+
+void writeAtExit() {
+    writeReport(std::cerr);
+    writeFile("WIFI_PROFILE_FOLDED", writeFoldedStacks);
+    writeFile("WIFI_PROFILE_TRACE", writeChromeTrace);
+}
+
+} // namespace
+
+ThreadProfile::ThreadProfile(std::uint32_t threadId, size_t traceEvents)
+    : id(threadId), current(0), maxEvents(traceEvents), droppedEvents(0) {
+    nodes.push_back(ProfileNode{"", 0, {}});
+}
+
+void ThreadProfile::addChild(const char* name) {
+    const std::uint64_t allocated = t_allocations;
+    const std::uint32_t child = static_cast<std::uint32_t>(nodes.size());
+    nodes.push_back(ProfileNode{name, current, {}});
+    nodes[current].children.push_back(child);
+    current = child;
+    t_allocations = allocated;
+}
+
+ThreadProfile& registerThread() {
+    Registry& state = registry();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    const std::uint32_t id = static_cast<std::uint32_t>(state.threads.size());
+    state.threads.push_back(std::make_unique<ThreadProfile>(id, state.traceEvents));
+    return *state.threads.back();
+}
+
+std::vector<PhaseSummary> summarize() {
+    Registry& state = registry();
+    const double scale = nanosecondsPerTick();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    std::map<std::string, PhaseSummary> phases;
+    for (const auto& thread : state.threads) {
+        for (size_t node = 1; node < thread->nodes.size(); ++node) {
+            const ProfileNode& profile = thread->nodes[node];
+            PhaseSummary& phase = phases.emplace(profile.name, PhaseSummary{profile.name}).first->second;
+            phase.calls += profile.calls;
+            phase.totalNs += profile.ticks * scale;
+            phase.maxNs = std::max(phase.maxNs, profile.maxTicks * scale);
+            phase.allocations += profile.allocations;
+        }
+    }
+
+    std::vector<PhaseSummary> result;
+    for (const auto& entry : phases) {
+        if (entry.second.calls > 0) result.push_back(entry.second);
+    }
+    std::sort(result.begin(), result.end(),
+              [](const PhaseSummary& a, const PhaseSummary& b) { return a.totalNs > b.totalNs; });
+    return result;
+}
+
+void writeReport(std::ostream& out) {
+    const std::vector<PhaseSummary> phases = summarize();
+    size_t threads;
+    {
+        Registry& state = registry();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        threads = state.threads.size();
+    }
+    out << "Phase profile (" << threads << " thread" << (threads == 1 ? "" : "s") << "):\n";
+    if (phases.empty()) {
+        out << "  no profiled scopes ran\n";
+        return;
+    }
+
+    size_t width = 5;
+    for (const PhaseSummary& phase : phases) width = std::max(width, std::string(phase.name).size());
+    const std::ios::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(3);
+    out << "  " << std::left << std::setw(static_cast<int>(width)) << "phase" << std::right
+        << std::setw(12) << "calls" << std::setw(14) << "total ms" << std::setw(12) << "mean us"
+        << std::setw(12) << "max us" << std::setw(12) << "allocs" << "\n";
+    for (const PhaseSummary& phase : phases) {
+        out << "  " << std::left << std::setw(static_cast<int>(width)) << phase.name << std::right
+            << std::setw(12) << phase.calls << std::setw(14) << phase.totalNs / 1e6
+            << std::setw(12) << phase.meanNs() / 1e3 << std::setw(12) << phase.maxNs / 1e3
+            << std::setw(12) << phase.allocations << "\n";
+    }
+    out.flags(flags);
+}
+
+void writeFoldedStacks(std::ostream& out) {
+    Registry& state = registry();
+    const double scale = nanosecondsPerTick();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    // Self time of each stack, summed over threads
+    std::map<std::string, double> stacks;
+    for (const auto& thread : state.threads) {
+        for (size_t node = 1; node < thread->nodes.size(); ++node) {
+            const ProfileNode& profile = thread->nodes[node];
+            if (profile.calls == 0) continue;
+            std::uint64_t self = profile.ticks;
+            for (std::uint32_t child : profile.children) {
+                self -= std::min(self, thread->nodes[child].ticks);
+            }
+            stacks[stackOf(*thread, static_cast<std::uint32_t>(node))] += self * scale;
+        }
+    }
+    for (const auto& stack : stacks) {
+        out << stack.first << " " << std::llround(stack.second) << "\n";
+    }
+}
+
+void writeChromeTrace(std::ostream& out) {
+    Registry& state = registry();
+    const double scale = nanosecondsPerTick();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    // Complete ("X") events in microseconds since the first profiled scope
+    const std::ios::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\":[";
+    const char* separator = "\n";
+    std::uint64_t dropped = 0;
+    for (const auto& thread : state.threads) {
+        for (const TraceEvent& event : thread->events) {
+            const double start = static_cast<double>(event.start - state.startTicks) * scale / 1e3;
+            out << separator << "{\"name\":\"" << thread->nodes[event.node].name
+                << "\",\"cat\":\"phase\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->id
+                << ",\"ts\":" << start << ",\"dur\":" << event.ticks * scale / 1e3 << "}";
+            separator = ",\n";
+        }
+        dropped += thread->droppedEvents;
+    }
+    out << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedEvents\":" << dropped << "}}\n";
+    out.flags(flags);
+}
+
+void reset() {
+    Registry& state = registry();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    for (const auto& thread : state.threads) {
+        for (ProfileNode& node : thread->nodes) {
+            node.calls = 0;
+            node.ticks = 0;
+            node.maxTicks = 0;
+            node.allocations = 0;
+        }
+        thread->events.clear();
+        thread->droppedEvents = 0;
+    }
+}
+
+} // namespace profiler
+
+#else
+
+namespace profiler {
+
+void writeReport(std::ostream&) {}
+void writeFoldedStacks(std::ostream&) {}
+void writeChromeTrace(std::ostream&) {}
+std::vector<PhaseSummary> summarize() { return std::vector<PhaseSummary>(); }
+void reset() {}
+
+} // namespace profiler
+
+#endif // WIFI_PROFILE
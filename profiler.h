@@ -0,0 +1,178 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#ifdef WIFI_PROFILE
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+// Phase profiler. PROFILE_SCOPE("name") times the rest of the enclosing
+// block with the CPU's time-stamp counter and counts the heap allocations
+// made inside it. Each thread records into its own call tree, so nested
+// scopes give stacks (e.g. Simulator::run;WiFi6AccessPoint::performOFDMA;
+// WiFi6AccessPoint::allocateSubChannels) and threads never share a counter.
+//
+// Built in only with -DWIFI_PROFILE (make PROFILE=1); otherwise the macro
+// is empty and the report functions write nothing. When built in, a
+// report goes to stderr at exit, with a folded-stack file for
+// flamegraph.pl and a Chrome trace (chrome://tracing, Perfetto) when the
+// WIFI_PROFILE_FOLDED / WIFI_PROFILE_TRACE environment variables name
+// files. Reports read every thread's tree, so they are written while no
+// instrumented thread is running.
+
+namespace profiler {
+
+// Per-phase totals, summed over threads and call sites
+struct PhaseSummary {
+    const char* name;
+    std::uint64_t calls = 0;
+    double totalNs = 0.0;
+    double maxNs = 0.0;
+    std::uint64_t allocations = 0;
+
+    double meanNs() const { return calls ? totalNs / calls : 0.0; }
+};
+
+// Table of call counts, total/mean/max time and allocations per phase
+void writeReport(std::ostream& out);
+
+// One line per distinct stack: "outer;inner self-time-ns"
+void writeFoldedStacks(std::ostream& out);
+
+// Chrome trace event JSON; one complete event per scope, up to
+// WIFI_PROFILE_TRACE_EVENTS (default 1000000) per thread
+void writeChromeTrace(std::ostream& out);
+
+// Phases by total time, largest first
+std::vector<PhaseSummary> summarize();
+
+// Zero every count and drop the trace events recorded so far (e.g. after
+// a warm-up); the stacks seen stay known
+void reset();
+
+#ifdef WIFI_PROFILE
+
+// Allocations made by this thread; counted by the profiler's operator new
+extern thread_local std::uint64_t t_allocations;
+inline void noteAllocation() { ++t_allocations; }
+
+// Time-stamp counter; steady_clock nanoseconds where there is none
+inline std::uint64_t readTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+struct ProfileNode {
+    const char* name;
+    std::uint32_t parent;
+    std::vector<std::uint32_t> children;
+    std::uint64_t calls = 0;
+    std::uint64_t ticks = 0;
+    std::uint64_t maxTicks = 0;
+    std::uint64_t allocations = 0;
+};
+
+struct TraceEvent {
+    std::uint32_t node;
+    std::uint64_t start;
+    std::uint64_t ticks;
+};
+
+// Call tree of one thread; node 0 is the root
+class ThreadProfile {
+public:
+    std::uint32_t id;
+    std::vector<ProfileNode> nodes;
+    std::uint32_t current;
+    std::vector<TraceEvent> events;
+    size_t maxEvents;           // 0 = no trace capture
+    std::uint64_t droppedEvents;
+
+    ThreadProfile(std::uint32_t threadId, size_t traceEvents);
+
+    void enter(const char* name) {
+        for (std::uint32_t child : nodes[current].children) {
+            if (nodes[child].name == name) {
+                current = child;
+                return;
+            }
+        }
+        addChild(name);
+    }
+
+    void leave(std::uint64_t start, std::uint64_t end, std::uint64_t allocations) {
+        ProfileNode& node = nodes[current];
+        const std::uint64_t ticks = end - start;
+        ++node.calls;
+        node.ticks += ticks;
+        if (ticks > node.maxTicks) node.maxTicks = ticks;
+        node.allocations += allocations;
+        if (events.size() < maxEvents) {
+            // The profiler's own allocations are not charged to the phases
+            const std::uint64_t allocated = t_allocations;
+            events.push_back(TraceEvent{current, start, ticks});
+            t_allocations = allocated;
+        } else if (maxEvents > 0) {
+            ++droppedEvents;
+        }
+        current = node.parent;
+    }
+
+private:
+    void addChild(const char* name);
+};
+
+// This thread's profile, registered on first use
+ThreadProfile& registerThread();
+
+inline ThreadProfile& threadProfile() {
+    thread_local ThreadProfile* profile = nullptr;
+    if (!profile) profile = &registerThread();
+    return *profile;
+}
+
+class Scope {
+private:
+    ThreadProfile& m_thread;
+    std::uint64_t m_allocations;
+    std::uint64_t m_start;
+
+public:
+    explicit Scope(const char* name) : m_thread(threadProfile()) {
+        m_thread.enter(name);
+        m_allocations = t_allocations;
+        m_start = readTicks();
+    }
+    ~Scope() {
+        const std::uint64_t end = readTicks();
+        m_thread.leave(m_start, end, t_allocations - m_allocations);
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) ::profiler::Scope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+
+#else
+
+inline void noteAllocation() {}
+
+#define PROFILE_SCOPE(name) ((void)0)
+
+#endif // WIFI_PROFILE
+
+} // namespace profiler
+
+#endif // PROFILER_H
@@ -0,0 +1,33 @@
+#ifndef RANDOM_STREAMS_H
+#define RANDOM_STREAMS_H
+
+#include <cstdint>
+#include <random>
+
+// Seed used when the caller does not ask for a specific stream
+const std::uint64_t DEFAULT_SIMULATION_SEED = 5489u;
+
+// SplitMix64 finalizer: turns nearby inputs into well separated outputs
+inline std::uint64_t splitMix64(std::uint64_t value) {
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+// Derive an independent, reproducible substream seed from a master seed.
+// Replication i of a run with master seed s always gets the same stream.
+inline std::uint64_t deriveStreamSeed(std::uint64_t masterSeed, std::uint64_t streamIndex) {
+    return splitMix64(masterSeed ^ splitMix64(streamIndex + 1));
+}
+
+// Seed a Mersenne Twister from all 64 bits of a stream seed
+inline void seedGenerator(std::mt19937& generator, std::uint64_t seed) {
+    std::seed_seq sequence{
+        static_cast<std::uint32_t>(seed),
+        static_cast<std::uint32_t>(seed >> 32)
+    };
+    generator.seed(sequence);
+}
+
+#endif // RANDOM_STREAMS_H
@@ -0,0 +1,39 @@
+#include "replication_runner.h"
+#include "command_line.h"
+
+int main(int argc, char* argv[]) {
+    try {
+        size_t replications = 30;
+        std::uint64_t masterSeed = DEFAULT_SIMULATION_SEED;
+        if (argc > 3 || (argc > 1 && !parseCount(argv[1], replications)) ||
+            (argc > 2 && !parseUnsigned(argv[2], masterSeed))) {
+            std::cerr << "Usage: replicate [replications] [master seed]\n";
+            return 1;
+        }
+
+        ReplicationRunner runner(masterSeed);
+        std::cout << "Running on " << runner.getThreadCount() << " threads, master seed "
+                  << masterSeed << "\n\n";
+
+        for (WiFiStandard standard : {WiFiStandard::WIFI4, WiFiStandard::WIFI5, WiFiStandard::WIFI6}) {
+            for (size_t users : {1, 10, 100}) {
+                ReplicationScenario scenario;
+                scenario.standard = standard;
+                scenario.userCount = users;
+                scenario.iterations = getDefaultIterations(standard);
+
+                printReplicationResult(runner.run(scenario, replications));
+                std::cout << "\n---\n";
+            }
+        }
+        return 0;
+    }
+    catch (const WiFiSimulationException& e) {
+        std::cerr << "Simulation Error: " << e.what() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Unexpected Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,73 @@
+#include "replication_runner.h"
+
+ReplicationRunner::ReplicationRunner(std::uint64_t masterSeed, size_t threadCount, double confidence)
+    : m_masterSeed(masterSeed),
+      m_confidence(confidence),
+      m_pool(threadCount) {}
+
+SimulationMetrics ReplicationRunner::runReplication(const ReplicationScenario& scenario,
+                                                    size_t replicationIndex) const {
+    auto simulation = createSimulation(scenario.standard, scenario.userCount,
+                                       deriveStreamSeed(m_masterSeed, replicationIndex),
+                                       scenario.phy, scenario.traffic);
+    simulation->setMaxIterations(scenario.iterations);
+    simulation->runSimulation();
+    return simulation->collectMetrics();
+}
+
+std::vector<SimulationMetrics> ReplicationRunner::runReplications(const ReplicationScenario& scenario,
+                                                                  size_t first, size_t count) {
+    std::vector<std::future<SimulationMetrics>> pending;
+    pending.reserve(count);
+    for (size_t i = first; i < first + count; ++i) {
+        pending.push_back(m_pool.submit([this, scenario, i]() {
+            return runReplication(scenario, i);
+        }));
+    }
+
+    // Collect in index order so the merge does not depend on scheduling
+    std::vector<SimulationMetrics> results;
+    results.reserve(count);
+    for (auto& future : pending) {
+        results.push_back(future.get());
+    }
+    return results;
+}
+
+ReplicationResult ReplicationRunner::run(const ReplicationScenario& scenario, size_t replications) {
+    return merge(scenario, runReplications(scenario, 0, replications));
+}
+
+ReplicationResult ReplicationRunner::merge(const ReplicationScenario& scenario,
+                                           std::vector<SimulationMetrics> replications) const {
+    RunningStatistics throughput, avgLatency, maxLatency;
+    for (const auto& metrics : replications) {
+        throughput.add(metrics.throughputMbps);
+        avgLatency.add(metrics.avgLatencyUs);
+        maxLatency.add(metrics.maxLatencyUs);
+    }
+
+    ReplicationResult result;
+    for (const auto& metrics : replications) {
+        result.latency.merge(metrics.latency);
+    }
+    result.scenario = scenario;
+    result.replications = std::move(replications);
+    result.throughputMbps = computeConfidenceInterval(throughput, m_confidence);
+    result.avgLatencyUs = computeConfidenceInterval(avgLatency, m_confidence);
+    result.maxLatencyUs = computeConfidenceInterval(maxLatency, m_confidence);
+    return result;
+}
+
+void printReplicationResult(const ReplicationResult& result, std::ostream& out) {
+    out << toString(result.scenario.standard) << " with " << result.scenario.userCount
+        << " Users, " << result.replications.size() << " replications:\n";
+    out << "Throughput: " << result.throughputMbps.mean << " +/- "
+        << result.throughputMbps.halfWidth << " Mbps\n";
+    out << "Average Latency: " << result.avgLatencyUs.mean << " +/- "
+        << result.avgLatencyUs.halfWidth << " microseconds\n";
+    out << "Max Latency: " << result.maxLatencyUs.mean << " +/- "
+        << result.maxLatencyUs.halfWidth << " microseconds\n";
+    out << "Pooled ";
+    printLatencyPercentiles(result.latency, out);
+}
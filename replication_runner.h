@@ -0,0 +1,61 @@
+#ifndef REPLICATION_RUNNER_H
+#define REPLICATION_RUNNER_H
+
+#include "simulation_factory.h"
+#include "statistics.h"
+#include "thread_pool.h"
+
+// One simulation configuration to replicate
+struct ReplicationScenario {
+    WiFiStandard standard = WiFiStandard::WIFI4;
+    size_t userCount = 1;
+    int iterations = 100;
+    PhyConfig phy;
+    TrafficConfig traffic;
+};
+
+// Merged results of N independent replications of a scenario
+struct ReplicationResult {
+    ReplicationScenario scenario;
+    std::vector<SimulationMetrics> replications;  // In replication-index order
+    ConfidenceInterval throughputMbps;
+    ConfidenceInterval avgLatencyUs;
+    ConfidenceInterval maxLatencyUs;
+    LatencyHistogram latency;  // Per-packet latencies pooled over all replications
+};
+
+// Runs independent Monte-Carlo replications of a scenario across a thread pool.
+// Replication i always uses substream deriveStreamSeed(masterSeed, i), so the
+// merged result is identical regardless of thread count or completion order.
+class ReplicationRunner {
+private:
+    std::uint64_t m_masterSeed;
+    double m_confidence;
+    ThreadPool m_pool;
+
+public:
+    // threadCount == 0 uses every hardware thread
+    ReplicationRunner(std::uint64_t masterSeed, size_t threadCount = 0, double confidence = 0.95);
+
+    // Run a single replication on the calling thread
+    SimulationMetrics runReplication(const ReplicationScenario& scenario, size_t replicationIndex) const;
+
+    // Run replications first .. first + count - 1 in parallel, in index order
+    std::vector<SimulationMetrics> runReplications(const ReplicationScenario& scenario,
+                                                   size_t first, size_t count);
+
+    // Run `replications` replications in parallel and merge them
+    ReplicationResult run(const ReplicationScenario& scenario, size_t replications);
+
+    // Merge already computed replications into confidence intervals
+    ReplicationResult merge(const ReplicationScenario& scenario,
+                            std::vector<SimulationMetrics> replications) const;
+
+    std::uint64_t getMasterSeed() const { return m_masterSeed; }
+    size_t getThreadCount() const { return m_pool.getThreadCount(); }
+};
+
+// Print a merged result as "mean +/- half-width" lines
+void printReplicationResult(const ReplicationResult& result, std::ostream& out = std::cout);
+
+#endif // REPLICATION_RUNNER_H
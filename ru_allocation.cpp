@@ -0,0 +1,106 @@
+#include "ru_allocation.h"
+#include "WiFiSimulation.h"
+#include "snapshot.h"
+#include <algorithm>
+
+template <std::size_t N>
+static RuLayout makeLayout(const std::array<ResourceUnit, N>& units, double widthMHz) {
+    RuLayout layout;
+    layout.units = units.data();
+    layout.count = units.size();
+    layout.widthMHz = widthMHz;
+    layout.fullBandTones = units.back().tones;
+
+    // Units are grouped by size, smallest first
+    std::size_t index = 0;
+    for (unsigned sizeClass = 0; sizeClass < RU_SIZE_CLASSES; ++sizeClass) {
+        layout.sizeBegin[sizeClass] = static_cast<std::uint8_t>(index);
+        while (index < units.size() && units[index].tones == RU_TONES[sizeClass]) ++index;
+    }
+    layout.sizeBegin[RU_SIZE_CLASSES] = static_cast<std::uint8_t>(index);
+    return layout;
+}
+
+const RuLayout& ruLayoutFor(double widthMHz) {
+    static const RuLayout LAYOUT_20 = makeLayout(RU_LAYOUT_20MHZ, 20.0);
+    static const RuLayout LAYOUT_40 = makeLayout(RU_LAYOUT_40MHZ, 40.0);
+    static const RuLayout LAYOUT_80 = makeLayout(RU_LAYOUT_80MHZ, 80.0);
+    static const RuLayout LAYOUT_160 = makeLayout(RU_LAYOUT_160MHZ, 160.0);
+
+    if (widthMHz >= 160.0) return LAYOUT_160;
+    if (widthMHz >= 80.0) return LAYOUT_80;
+    if (widthMHz >= 40.0) return LAYOUT_40;
+    return LAYOUT_20;
+}
+
+std::uint32_t largestRuWithin(std::uint32_t tones) {
+    std::uint32_t size = RU_TONES[0];
+    for (std::uint16_t candidate : RU_TONES) {
+        if (candidate <= tones) size = candidate;
+    }
+    return size;
+}
+
+RuAllocator::RuAllocator(const RuLayout& layout)
+    : m_layout(&layout) {}
+
+void RuAllocator::setLayout(const RuLayout& layout) {
+    m_layout = &layout;
+    clear();
+}
+
+bool RuAllocator::isFull() const {
+    // Full once no 26-tone RU is free
+    return findFree(0) == NO_RU;
+}
+
+int RuAllocator::findFree(unsigned sizeClass) const {
+    for (std::size_t index = m_layout->sizeBegin[sizeClass]; index < m_layout->sizeBegin[sizeClass + 1]; ++index) {
+        if (!m_layout->units[index].mask.overlaps(m_occupied)) return static_cast<int>(index);
+    }
+    return NO_RU;
+}
+
+int RuAllocator::allocate(std::uint32_t tones) {
+    // Smallest size class that carries the demand, if the layout has one
+    unsigned wanted = 0;
+    while (wanted + 1 < RU_SIZE_CLASSES && RU_TONES[wanted] < tones) ++wanted;
+
+    // A free larger RU implies a free smaller one inside it, so only the
+    // wanted size and, failing that, smaller sizes need looking at
+    int unit = findFree(wanted);
+    for (unsigned sizeClass = wanted; sizeClass-- > 0 && unit == NO_RU;) {
+        unit = findFree(sizeClass);
+    }
+    if (unit != NO_RU) {
+        m_occupied |= m_layout->units[unit].mask;
+    }
+    return unit;
+}
+
+size_t RuAllocator::allocate(const std::vector<std::uint32_t>& demands, std::vector<int>& assignments) {
+    m_order.resize(demands.size());
+    for (std::uint32_t i = 0; i < demands.size(); ++i) m_order[i] = i;
+    std::sort(m_order.begin(), m_order.end(), [&demands](std::uint32_t a, std::uint32_t b) {
+        return demands[a] != demands[b] ? demands[a] > demands[b] : a < b;
+    });
+
+    assignments.assign(demands.size(), NO_RU);
+    size_t assigned = 0;
+    for (std::uint32_t user : m_order) {
+        if (isFull()) break;
+        assignments[user] = allocate(demands[user]);
+        if (assignments[user] != NO_RU) ++assigned;
+    }
+    return assigned;
+}
+
+void RuAllocator::saveState(SnapshotWriter& out) const {
+    out.put(m_layout->widthMHz);
+    out.put(m_occupied);
+}
+
+void RuAllocator::loadState(SnapshotReader& in) {
+    m_layout = &ruLayoutFor(in.get<double>());
+    in.get(m_occupied);
+}
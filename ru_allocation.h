@@ -0,0 +1,179 @@
+#ifndef RU_ALLOCATION_H
+#define RU_ALLOCATION_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// Set of 26-tone RU positions. The widest layout (160 MHz) has 74 of
+// them, so two words cover every channel width.
+struct RuMask {
+    std::uint64_t low = 0;
+    std::uint64_t high = 0;
+
+    constexpr bool overlaps(const RuMask& other) const {
+        return ((low & other.low) | (high & other.high)) != 0;
+    }
+    constexpr RuMask& operator|=(const RuMask& other) {
+        low |= other.low;
+        high |= other.high;
+        return *this;
+    }
+};
+
+// Mask of `span` consecutive 26-tone positions starting at `first`
+constexpr RuMask ruMask(unsigned first, unsigned span) {
+    RuMask mask;
+    for (unsigned position = first; position < first + span; ++position) {
+        if (position < 64) {
+            mask.low |= std::uint64_t(1) << position;
+        } else {
+            mask.high |= std::uint64_t(1) << (position - 64);
+        }
+    }
+    return mask;
+}
+
+// One 802.11ax resource unit of a channel layout
+struct ResourceUnit {
+    std::uint16_t tones = 0;   // 26, 52, 106, 242, 484, 996 or 1992 (2x996)
+    std::uint8_t first = 0;    // First 26-tone position covered
+    std::uint8_t span = 0;     // 26-tone positions covered
+    RuMask mask;
+};
+
+// RU sizes, smallest first
+constexpr unsigned RU_SIZE_CLASSES = 7;
+constexpr std::uint16_t RU_TONES[RU_SIZE_CLASSES] = {26, 52, 106, 242, 484, 996, 1992};
+
+namespace ru_detail {
+
+// 26-tone positions in a layout of `blocks` 20 MHz blocks: 9 per block,
+// plus the centre 26-tone RU of every 80 MHz segment
+constexpr std::size_t smallUnits(std::size_t blocks) {
+    return 9 * blocks + blocks / 4;
+}
+
+// RUs in a layout of `blocks` 20 MHz blocks (blocks = 1, 2, 4 or 8)
+constexpr std::size_t unitCount(std::size_t blocks) {
+    return smallUnits(blocks) + 4 * blocks + 2 * blocks + blocks +
+           blocks / 2 + blocks / 4 + blocks / 8;
+}
+
+// First 26-tone position of 20 MHz block `block`; from 80 MHz on, each
+// 80 MHz segment has its centre 26-tone RU between its two 40 MHz halves
+constexpr unsigned blockBase(std::size_t blocks, unsigned block) {
+    if (blocks < 4) return 9 * block;
+    unsigned segment = block / 4;
+    unsigned within = block % 4;
+    return segment * 37 + within * 9 + (within >= 2 ? 1 : 0);
+}
+
+template <std::size_t Blocks>
+constexpr std::array<ResourceUnit, unitCount(Blocks)> buildLayout() {
+    std::array<ResourceUnit, unitCount(Blocks)> units{};
+    std::size_t count = 0;
+    auto add = [&units, &count](std::uint16_t tones, unsigned first, unsigned span) {
+        ResourceUnit& unit = units[count++];
+        unit.tones = tones;
+        unit.first = static_cast<std::uint8_t>(first);
+        unit.span = static_cast<std::uint8_t>(span);
+        unit.mask = ruMask(first, span);
+    };
+
+    // Grouped by size, smallest first, each group in frequency order
+    for (unsigned block = 0; block < Blocks; ++block) {
+        for (unsigned k = 0; k < 9; ++k) add(26, blockBase(Blocks, block) + k, 1);
+        if (Blocks >= 4 && block % 4 == 1) add(26, (block / 4) * 37 + 18, 1);
+    }
+    for (unsigned block = 0; block < Blocks; ++block) {
+        for (unsigned offset : {0u, 2u, 5u, 7u}) add(52, blockBase(Blocks, block) + offset, 2);
+    }
+    for (unsigned block = 0; block < Blocks; ++block) {
+        for (unsigned offset : {0u, 5u}) add(106, blockBase(Blocks, block) + offset, 4);
+    }
+    for (unsigned block = 0; block < Blocks; ++block) {
+        add(242, blockBase(Blocks, block), 9);
+    }
+    for (unsigned block = 0; block + 1 < Blocks; block += 2) {
+        add(484, blockBase(Blocks, block), 18);
+    }
+    for (unsigned block = 0; block + 3 < Blocks; block += 4) {
+        add(996, blockBase(Blocks, block), 37);
+    }
+    if (Blocks == 8) add(1992, 0, 74);
+    return units;
+}
+
+} // namespace ru_detail
+
+// RU layouts of 20/40/80/160 MHz channels, built at compile time
+constexpr auto RU_LAYOUT_20MHZ = ru_detail::buildLayout<1>();
+constexpr auto RU_LAYOUT_40MHZ = ru_detail::buildLayout<2>();
+constexpr auto RU_LAYOUT_80MHZ = ru_detail::buildLayout<4>();
+constexpr auto RU_LAYOUT_160MHZ = ru_detail::buildLayout<8>();
+
+static_assert(RU_LAYOUT_20MHZ.size() == 16, "9x26 + 4x52 + 2x106 + 242");
+static_assert(RU_LAYOUT_80MHZ[36].first == 36 && RU_LAYOUT_80MHZ.back().tones == 996,
+              "80 MHz: 37 26-tone RUs, widest is 996");
+static_assert(RU_LAYOUT_160MHZ.back().span == 74, "160 MHz: 2x996 covers all 74 positions");
+
+// A channel's layout, with the index range of each RU size
+struct RuLayout {
+    const ResourceUnit* units = nullptr;
+    std::size_t count = 0;
+    double widthMHz = 0.0;
+    std::uint16_t fullBandTones = 0;          // Tones of the widest RU
+    std::uint8_t sizeBegin[RU_SIZE_CLASSES + 1] = {};  // Units of class c: [sizeBegin[c], sizeBegin[c + 1])
+
+    std::size_t maxUsers() const { return sizeBegin[1]; }  // One per 26-tone RU
+};
+
+// Layout of the widest standard channel (20, 40, 80 or 160 MHz) that fits
+// in `widthMHz`; narrower channels use the 20 MHz layout
+const RuLayout& ruLayoutFor(double widthMHz);
+
+// Largest RU size that fits in `tones` (at least 26)
+std::uint32_t largestRuWithin(std::uint32_t tones);
+
+// Picks non-overlapping RUs from a layout with a mask of the occupied
+// 26-tone positions; every candidate test is two word ANDs.
+class RuAllocator {
+private:
+    const RuLayout* m_layout;
+    RuMask m_occupied;
+    std::vector<std::uint32_t> m_order;  // Scratch space for allocate()
+
+    int findFree(unsigned sizeClass) const;
+
+public:
+    static constexpr int NO_RU = -1;
+
+    explicit RuAllocator(const RuLayout& layout = ruLayoutFor(20.0));
+
+    void setLayout(const RuLayout& layout);
+    const RuLayout& getLayout() const { return *m_layout; }
+
+    // Free every RU
+    void clear() { m_occupied = RuMask(); }
+    bool isFull() const;
+
+    // Take the smallest free RU of at least `tones`, or failing that the
+    // largest free RU; returns its index into the layout or NO_RU
+    int allocate(std::uint32_t tones);
+
+    // Serve a demand vector (tones per user), largest demand first so big
+    // RUs are placed before small ones fragment the band. assignments[i]
+    // is the RU index for demands[i], or NO_RU. Returns the RUs assigned.
+    size_t allocate(const std::vector<std::uint32_t>& demands, std::vector<int>& assignments);
+
+    // Layout width and the occupied positions
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+};
+
+#endif // RU_ALLOCATION_H
@@ -0,0 +1,269 @@
+#include "ru_scheduler.h"
+#include "WiFiSimulation.h"
+#include "snapshot.h"
+#include <chrono>
+
+const char* toString(RuSchedulingPolicy policy) {
+    switch (policy) {
+    case RuSchedulingPolicy::ROUND_ROBIN:       return "RoundRobin";
+    case RuSchedulingPolicy::MAX_THROUGHPUT:    return "MaxThroughput";
+    case RuSchedulingPolicy::PROPORTIONAL_FAIR: return "ProportionalFair";
+    case RuSchedulingPolicy::DEADLINE:          return "Deadline";
+    }
+    return "Unknown";
+}
+
+void RuScheduler::resize(size_t stations) {
+    if (stations >= m_position.size()) {
+        m_position.resize(stations, NOT_QUEUED);
+        return;
+    }
+    m_heap.clear();
+    m_position.assign(stations, NOT_QUEUED);
+}
+
+void RuScheduler::saveState(SnapshotWriter& out) const {
+    out.putVector(m_heap);
+    out.putVector(m_position);
+}
+
+void RuScheduler::loadState(SnapshotReader& in) {
+    in.getVector(m_heap);
+    in.getVector(m_position);
+    for (std::uint32_t index = 0; index < m_heap.size(); ++index) {
+        if (m_heap[index].station >= m_position.size() || m_position[m_heap[index].station] != index) {
+            throw WiFiSimulationException("Corrupt RU scheduler in simulation snapshot");
+        }
+    }
+}
+
+void RuScheduler::place(std::uint32_t index, const Entry& entry) {
+    m_heap[index] = entry;
+    m_position[entry.station] = index;
+}
+
+void RuScheduler::siftUp(std::uint32_t index) {
+    Entry entry = m_heap[index];
+    while (index > 0) {
+        std::uint32_t parent = (index - 1) / 2;
+        if (!before(entry, m_heap[parent])) break;
+        place(index, m_heap[parent]);
+        index = parent;
+    }
+    place(index, entry);
+}
+
+void RuScheduler::siftDown(std::uint32_t index) {
+    Entry entry = m_heap[index];
+    const std::uint32_t size = static_cast<std::uint32_t>(m_heap.size());
+    while (true) {
+        std::uint32_t child = 2 * index + 1;
+        if (child >= size) break;
+        if (child + 1 < size && before(m_heap[child + 1], m_heap[child])) ++child;
+        if (!before(m_heap[child], entry)) break;
+        place(index, m_heap[child]);
+        index = child;
+    }
+    place(index, entry);
+}
+
+void RuScheduler::push(StationId station, double priority) {
+    m_heap.push_back(Entry{priority, station});
+    siftUp(static_cast<std::uint32_t>(m_heap.size() - 1));
+}
+
+StationId RuScheduler::pop() {
+    StationId station = m_heap.front().station;
+    m_position[station] = NOT_QUEUED;
+    Entry last = m_heap.back();
+    m_heap.pop_back();
+    if (!m_heap.empty()) {
+        place(0, last);
+        siftDown(0);
+    }
+    return station;
+}
+
+void RuScheduler::refreshPriorities(const StationTable& stations) {
+    for (Entry& entry : m_heap) {
+        entry.priority = priority(stations, entry.station);
+    }
+    for (std::uint32_t index = static_cast<std::uint32_t>(m_heap.size() / 2); index-- > 0;) {
+        siftDown(index);
+    }
+}
+
+void RuScheduler::activate(const StationTable& stations, StationId station) {
+    if (station >= m_position.size()) {
+        throw WiFiSimulationException("Unknown station for RU scheduling");
+    }
+    if (m_position[station] != NOT_QUEUED) return;
+    onActivated(station);
+    push(station, priority(stations, station));
+}
+
+void RuScheduler::selectUsers(const StationTable& stations, size_t count,
+                              std::vector<StationId>& selected) {
+    while (count > 0 && !m_heap.empty()) {
+        StationId station = pop();
+        if (!stations.hasPackets(station)) continue;  // Drained elsewhere
+        selected.push_back(station);
+        --count;
+    }
+}
+
+void RuScheduler::complete(const StationTable& stations, StationId station, std::uint64_t bytes) {
+    if (bytes > 0) onServed(stations, station, bytes);
+    if (stations.hasPackets(station) && m_position[station] == NOT_QUEUED) {
+        push(station, priority(stations, station));
+    }
+}
+
+namespace {
+
+// Least recently served (or activated) first: a FIFO expressed as priorities
+class RoundRobinScheduler : public RuScheduler {
+private:
+    std::vector<std::uint64_t> m_lastTurn;
+    std::uint64_t m_turn = 0;
+
+protected:
+    double priority(const StationTable&, StationId station) override {
+        return -static_cast<double>(m_lastTurn[station]);
+    }
+    void onActivated(StationId station) override { m_lastTurn[station] = ++m_turn; }
+    void onServed(const StationTable&, StationId station, std::uint64_t) override {
+        m_lastTurn[station] = ++m_turn;
+    }
+
+public:
+    RuSchedulingPolicy getPolicy() const override { return RuSchedulingPolicy::ROUND_ROBIN; }
+    std::unique_ptr<RuScheduler> clone() const override { return std::make_unique<RoundRobinScheduler>(*this); }
+    void resize(size_t stations) override {
+        if (stations < m_lastTurn.size()) m_lastTurn.clear();
+        RuScheduler::resize(stations);
+        m_lastTurn.resize(stations, 0);
+    }
+    void saveState(SnapshotWriter& out) const override {
+        RuScheduler::saveState(out);
+        out.putVector(m_lastTurn);
+        out.put(m_turn);
+    }
+    void loadState(SnapshotReader& in) override {
+        RuScheduler::loadState(in);
+        in.getVector(m_lastTurn);
+        in.get(m_turn);
+        if (m_lastTurn.size() != size()) throw WiFiSimulationException("Corrupt RU scheduler in simulation snapshot");
+    }
+};
+
+// Best link first; stations on poor links wait until the good ones drain
+class MaxThroughputScheduler : public RuScheduler {
+protected:
+    double priority(const StationTable& stations, StationId station) override {
+        return stations.getLinkEfficiency(station);
+    }
+
+public:
+    RuSchedulingPolicy getPolicy() const override { return RuSchedulingPolicy::MAX_THROUGHPUT; }
+    std::unique_ptr<RuScheduler> clone() const override { return std::make_unique<MaxThroughputScheduler>(*this); }
+};
+
+// Link rate over an exponentially weighted average of delivered bytes per
+// window. Rather than decaying every station's average each window, the
+// averages are stored divided by a shared scale that decays instead; the
+// ratio between stations, and so the heap order, is unaffected, and only
+// served stations change key. The scale is folded back into the averages
+// before it underflows.
+class ProportionalFairScheduler : public RuScheduler {
+private:
+    static constexpr double TIME_CONSTANT = 100.0;  // Windows
+    static constexpr double UNSERVED_PRIORITY = 1e300;
+    static constexpr double MIN_SCALE = 1e-200;
+
+    std::vector<double> m_scaledAverage;
+    double m_scale = 1.0;
+
+protected:
+    double priority(const StationTable& stations, StationId station) override {
+        double rate = stations.getLinkEfficiency(station);
+        double average = m_scaledAverage[station];
+        return average > 0.0 ? rate / average : UNSERVED_PRIORITY * rate;
+    }
+    void onServed(const StationTable&, StationId station, std::uint64_t bytes) override {
+        m_scaledAverage[station] += bytes / (TIME_CONSTANT * m_scale);
+    }
+
+public:
+    RuSchedulingPolicy getPolicy() const override { return RuSchedulingPolicy::PROPORTIONAL_FAIR; }
+    std::unique_ptr<RuScheduler> clone() const override {
+        return std::make_unique<ProportionalFairScheduler>(*this);
+    }
+    void resize(size_t stations) override {
+        if (stations < m_scaledAverage.size()) {
+            m_scaledAverage.clear();
+            m_scale = 1.0;
+        }
+        RuScheduler::resize(stations);
+        m_scaledAverage.resize(stations, 0.0);
+    }
+    void saveState(SnapshotWriter& out) const override {
+        RuScheduler::saveState(out);
+        out.putVector(m_scaledAverage);
+        out.put(m_scale);
+    }
+    void loadState(SnapshotReader& in) override {
+        RuScheduler::loadState(in);
+        in.getVector(m_scaledAverage);
+        in.get(m_scale);
+        if (m_scaledAverage.size() != size()) {
+            throw WiFiSimulationException("Corrupt RU scheduler in simulation snapshot");
+        }
+    }
+    void endWindow(const StationTable& stations) override {
+        m_scale *= 1.0 - 1.0 / TIME_CONSTANT;
+        if (m_scale < MIN_SCALE) {
+            for (double& average : m_scaledAverage) average *= m_scale;
+            m_scale = 1.0;
+            refreshPriorities(stations);
+        }
+    }
+};
+
+// Earliest deadline first, where a packet's deadline is its enqueue time
+// plus the delay budget of its access category. Only the head of line
+// matters, so the key changes only when a station is served.
+class DeadlineScheduler : public RuScheduler {
+private:
+    static SimTime delayBudget(AccessCategory category) {
+        switch (category) {
+        case AccessCategory::VOICE:       return std::chrono::milliseconds(20);
+        case AccessCategory::VIDEO:       return std::chrono::milliseconds(100);
+        case AccessCategory::BEST_EFFORT: return std::chrono::milliseconds(300);
+        case AccessCategory::BACKGROUND:  return std::chrono::milliseconds(1000);
+        }
+        return std::chrono::milliseconds(300);
+    }
+
+protected:
+    double priority(const StationTable& stations, StationId station) override {
+        const PacketDescriptor& head = stations.peekPacket(station);
+        return -static_cast<double>((head.enqueueTime + delayBudget(head.accessCategory)).count());
+    }
+
+public:
+    RuSchedulingPolicy getPolicy() const override { return RuSchedulingPolicy::DEADLINE; }
+    std::unique_ptr<RuScheduler> clone() const override { return std::make_unique<DeadlineScheduler>(*this); }
+};
+
+} // namespace
+
+std::unique_ptr<RuScheduler> createRuScheduler(RuSchedulingPolicy policy) {
+    switch (policy) {
+    case RuSchedulingPolicy::ROUND_ROBIN:       return std::make_unique<RoundRobinScheduler>();
+    case RuSchedulingPolicy::MAX_THROUGHPUT:    return std::make_unique<MaxThroughputScheduler>();
+    case RuSchedulingPolicy::PROPORTIONAL_FAIR: return std::make_unique<ProportionalFairScheduler>();
+    case RuSchedulingPolicy::DEADLINE:          return std::make_unique<DeadlineScheduler>();
+    }
+    throw WiFiSimulationException("Unknown RU scheduling policy");
+}
@@ -0,0 +1,101 @@
+#ifndef RU_SCHEDULER_H
+#define RU_SCHEDULER_H
+
+#include <memory>
+#include <vector>
+
+#include "station_table.h"
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// How an OFDMA access point picks the users served in each window
+enum class RuSchedulingPolicy {
+    ROUND_ROBIN,        // Least recently served first
+    MAX_THROUGHPUT,     // Best link first
+    PROPORTIONAL_FAIR,  // Best link relative to the user's average throughput
+    DEADLINE            // Earliest head-of-line deadline first
+};
+
+const char* toString(RuSchedulingPolicy policy);
+
+// Picks the users mapped to resource units in each OFDMA window. Every
+// backlogged station sits in an indexed binary max-heap keyed by the
+// policy's priority; only stations that are served (or newly backlogged)
+// change key, so a window costs O(k log n) for k RUs, never a scan of
+// the table. Selected stations leave the heap until complete() puts them
+// back with their updated priority.
+class RuScheduler {
+private:
+    struct Entry {
+        double priority;
+        StationId station;
+    };
+
+    std::vector<Entry> m_heap;
+    std::vector<std::uint32_t> m_position;  // Heap index per station, or NOT_QUEUED
+    static constexpr std::uint32_t NOT_QUEUED = UINT32_MAX;
+
+    static bool before(const Entry& a, const Entry& b) {
+        if (a.priority != b.priority) return a.priority > b.priority;
+        return a.station < b.station;
+    }
+    void place(std::uint32_t index, const Entry& entry);
+    void siftUp(std::uint32_t index);
+    void siftDown(std::uint32_t index);
+    void push(StationId station, double priority);
+    StationId pop();
+
+protected:
+    // Priority of a backlogged station; higher is served first
+    virtual double priority(const StationTable& stations, StationId station) = 0;
+
+    // Called when a station enters the heap for the first time since draining
+    virtual void onActivated(StationId station) { (void)station; }
+
+    // Account `bytes` delivered to a station in the current window
+    virtual void onServed(const StationTable& stations, StationId station, std::uint64_t bytes) {
+        (void)stations; (void)station; (void)bytes;
+    }
+
+    // Recompute every queued priority and restore the heap, O(n)
+    void refreshPriorities(const StationTable& stations);
+
+public:
+    virtual ~RuScheduler() = default;
+    virtual RuSchedulingPolicy getPolicy() const = 0;
+
+    // Independent copy, queued stations and priorities included
+    virtual std::unique_ptr<RuScheduler> clone() const = 0;
+
+    // Size the per-station state. Growing keeps the queued stations;
+    // shrinking drops every one of them.
+    virtual void resize(size_t stations);
+
+    // Queue a station whose queue just became non-empty (no-op if queued)
+    void activate(const StationTable& stations, StationId station);
+
+    // Move up to `count` of the highest-priority backlogged stations into
+    // `selected`, best first
+    void selectUsers(const StationTable& stations, size_t count, std::vector<StationId>& selected);
+
+    // Return a selected station after its window, with `bytes` delivered;
+    // it is queued again if it still has packets. A station that got no
+    // RU (bytes = 0) keeps its priority.
+    void complete(const StationTable& stations, StationId station, std::uint64_t bytes);
+
+    // Close the current window (e.g. age average throughputs)
+    virtual void endWindow(const StationTable& stations) { (void)stations; }
+
+    size_t size() const { return m_position.size(); }
+    size_t queuedStations() const { return m_heap.size(); }
+
+    // The heap and the policy's per-station state
+    virtual void saveState(SnapshotWriter& out) const;
+    virtual void loadState(SnapshotReader& in);
+};
+
+// Create a scheduler for `policy`
+std::unique_ptr<RuScheduler> createRuScheduler(RuSchedulingPolicy policy);
+
+#endif // RU_SCHEDULER_H
@@ -0,0 +1,54 @@
+#include "sequential_runner.h"
+#include "command_line.h"
+
+int main(int argc, char* argv[]) {
+    try {
+        PrecisionTarget target;
+        std::uint64_t masterSeed = DEFAULT_SIMULATION_SEED;
+        double offeredLoadMbps = 20.0;
+        if (argc > 4 ||
+            (argc > 1 && (!parseNumber(argv[1], target.relativeHalfWidth) || target.relativeHalfWidth <= 0.0)) ||
+            (argc > 2 && !parseUnsigned(argv[2], masterSeed)) ||
+            (argc > 3 && (!parseNumber(argv[3], offeredLoadMbps) || offeredLoadMbps < 0.0))) {
+            std::cerr << "Usage: converge [relative half-width] [master seed] [offered load (Mbps)]\n";
+            return 1;
+        }
+
+        SequentialRunner runner(masterSeed, target);
+        std::cout << "Running on " << runner.getThreadCount() << " threads, master seed " << masterSeed
+                  << ", target +/- " << target.relativeHalfWidth * 100.0 << "% at "
+                  << target.confidence * 100.0 << "% confidence\n\n";
+
+        // The default backlog (replications) and a Poisson load (batch means)
+        for (TrafficModel model : {TrafficModel::BACKLOG, TrafficModel::POISSON}) {
+            for (WiFiStandard standard : {WiFiStandard::WIFI4, WiFiStandard::WIFI5, WiFiStandard::WIFI6}) {
+                for (size_t users : {1, 10, 100}) {
+                    ReplicationScenario scenario;
+                    scenario.standard = standard;
+                    scenario.userCount = users;
+                    scenario.iterations = getDefaultIterations(standard);
+                    scenario.traffic.model = model;
+                    scenario.traffic.packetsPerSecond = packetRateForLoad(offeredLoadMbps, users,
+                                                                          scenario.traffic.packetSize);
+
+                    auto start = std::chrono::steady_clock::now();
+                    SequentialResult result = runner.run(scenario);
+                    double wallMs = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start).count();
+
+                    printSequentialResult(result);
+                    std::cout << "Wall Time: " << wallMs << " ms\n\n---\n";
+                }
+            }
+        }
+        return 0;
+    }
+    catch (const WiFiSimulationException& e) {
+        std::cerr << "Simulation Error: " << e.what() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Unexpected Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,199 @@
+#include "sequential_runner.h"
+
+namespace {
+
+// One batch of a steady-state run
+struct Batch {
+    double throughputMbps;
+    LatencyHistogram latency;  // Deliveries during the batch
+};
+
+// Lag-1 autocorrelation; 0 for a constant series
+double lagOneCorrelation(const std::vector<double>& series) {
+    if (series.size() < 3) return 0.0;
+    double mean = 0.0;
+    for (double value : series) mean += value;
+    mean /= series.size();
+
+    double lagged = 0.0;
+    double squared = 0.0;
+    for (size_t i = 0; i < series.size(); ++i) {
+        double deviation = series[i] - mean;
+        squared += deviation * deviation;
+        if (i + 1 < series.size()) lagged += deviation * (series[i + 1] - mean);
+    }
+    return squared > 0.0 ? lagged / squared : 0.0;
+}
+
+// Throughput and p99 of consecutive groups of `size` batches, starting at `first`
+void groupBatches(const std::vector<Batch>& batches, size_t first, size_t size,
+                  std::vector<double>& throughput, std::vector<double>& p99) {
+    throughput.clear();
+    p99.clear();
+    for (size_t start = first; start + size <= batches.size(); start += size) {
+        double sum = 0.0;
+        LatencyHistogram latency;
+        for (size_t i = start; i < start + size; ++i) {
+            sum += batches[i].throughputMbps;
+            latency.merge(batches[i].latency);
+        }
+        throughput.push_back(sum / size);
+        p99.push_back(latency.percentileMicroseconds(99.0));
+    }
+}
+
+ConfidenceInterval interval(const std::vector<double>& samples, double confidence) {
+    RunningStatistics statistics;
+    for (double value : samples) statistics.add(value);
+    return computeConfidenceInterval(statistics, confidence);
+}
+
+bool endless(TrafficModel model) {
+    return model != TrafficModel::BACKLOG && model != TrafficModel::REPLAY;
+}
+
+} // namespace
+
+size_t mserTruncation(const std::vector<double>& series) {
+    // Suffix sums give every candidate's statistic in one pass
+    const size_t n = series.size();
+    double sum = 0.0;
+    double squares = 0.0;
+    std::vector<double> statistic(n, 0.0);
+    for (size_t d = n; d-- > 0;) {
+        sum += series[d];
+        squares += series[d] * series[d];
+        const double kept = static_cast<double>(n - d);
+        statistic[d] = std::max(squares - sum * sum / kept, 0.0) / (kept * kept);
+    }
+
+    size_t best = 0;
+    for (size_t d = 1; d <= n / 2; ++d) {
+        if (statistic[d] < statistic[best]) best = d;
+    }
+    return best;
+}
+
+SequentialRunner::SequentialRunner(std::uint64_t masterSeed, const PrecisionTarget& target, size_t threadCount)
+    : m_replications(masterSeed, threadCount),
+      m_target(target) {
+    if (!(m_target.relativeHalfWidth > 0.0) || !(m_target.confidence > 0.0 && m_target.confidence < 1.0) ||
+        m_target.maxSamples < 2 || m_target.batchDuration <= SimTime::zero()) {
+        throw WiFiSimulationException("Invalid precision target");
+    }
+    m_target.minSamples = std::min(std::max<size_t>(m_target.minSamples, 2), m_target.maxSamples);
+}
+
+SequentialResult SequentialRunner::run(const ReplicationScenario& scenario) {
+    return endless(scenario.traffic.model) ? runBatches(scenario) : runReplications(scenario);
+}
+
+SequentialResult SequentialRunner::runBatches(const ReplicationScenario& scenario) {
+    const SimTime batchDuration = m_target.batchDuration;
+    const double batchUs = std::chrono::duration<double, std::micro>(batchDuration).count();
+
+    // Arrivals last as long as the longest run allowed
+    TrafficConfig traffic = scenario.traffic;
+    traffic.duration = batchDuration * static_cast<SimTime::rep>(m_target.maxSamples + 1);
+    auto simulation = createSimulation(scenario.standard, scenario.userCount,
+                                       deriveStreamSeed(m_replications.getMasterSeed(), 0),
+                                       scenario.phy, traffic);
+    simulation->setMaxIterations(0);
+    simulation->start();
+
+    SequentialResult result;
+    result.scenario = scenario;
+    result.steadyState = true;
+
+    std::vector<Batch> batches;
+    std::vector<double> throughput, p99;
+    SimulationMetrics previous;
+    while (batches.size() < m_target.maxSamples) {
+        simulation->runUntil(batchDuration * static_cast<SimTime::rep>(batches.size() + 1));
+        SimulationMetrics metrics = simulation->collectMetrics();
+        Batch batch;
+        batch.throughputMbps = (metrics.deliveredBytes - previous.deliveredBytes) * 8.0 / batchUs;
+        batch.latency = metrics.latency;
+        batch.latency.subtract(previous.latency);
+        batches.push_back(std::move(batch));
+        previous = std::move(metrics);
+
+        // Drop the warm-up, then merge neighbours while they stay correlated
+        throughput.clear();
+        p99.clear();
+        for (const Batch& each : batches) {
+            throughput.push_back(each.throughputMbps);
+            p99.push_back(each.latency.percentileMicroseconds(99.0));
+        }
+        const size_t warmup = std::max(mserTruncation(throughput), mserTruncation(p99));
+        if (batches.size() - warmup < m_target.minSamples) continue;
+
+        size_t groupSize = 1;
+        groupBatches(batches, warmup, groupSize, throughput, p99);
+        while (throughput.size() / 2 >= m_target.minSamples &&
+               std::max(lagOneCorrelation(throughput), lagOneCorrelation(p99)) > 0.2) {
+            groupSize *= 2;
+            groupBatches(batches, warmup, groupSize, throughput, p99);
+        }
+
+        result.samples = throughput.size();
+        result.batches = batches.size();
+        result.warmupBatches = warmup;
+        result.warmup = batchDuration * static_cast<SimTime::rep>(warmup);
+        result.throughputMbps = interval(throughput, m_target.confidence);
+        result.p99LatencyUs = interval(p99, m_target.confidence);
+        result.converged = result.throughputMbps.relativeHalfWidth() <= m_target.relativeHalfWidth &&
+                           result.p99LatencyUs.relativeHalfWidth() <= m_target.relativeHalfWidth;
+        if (result.converged) break;
+    }
+    result.batches = batches.size();
+    result.simulatedTime = simulation->getSimulatedTime();
+    return result;
+}
+
+SequentialResult SequentialRunner::runReplications(const ReplicationScenario& scenario) {
+    SequentialResult result;
+    result.scenario = scenario;
+
+    // Waves run in parallel, but the stopping rule is applied replication by
+    // replication in index order, so the thread count never changes the result
+    std::vector<double> throughput, p99;
+    while (throughput.size() < m_target.maxSamples && !result.converged) {
+        size_t wave = std::max(getThreadCount(), m_target.minSamples - std::min(m_target.minSamples, throughput.size()));
+        wave = std::min(wave, m_target.maxSamples - throughput.size());
+        for (const SimulationMetrics& metrics : m_replications.runReplications(scenario, throughput.size(), wave)) {
+            throughput.push_back(metrics.throughputMbps);
+            p99.push_back(metrics.latency.percentileMicroseconds(99.0));
+            result.simulatedTime += metrics.lastDelivery;
+            if (throughput.size() < m_target.minSamples) continue;
+
+            result.throughputMbps = interval(throughput, m_target.confidence);
+            result.p99LatencyUs = interval(p99, m_target.confidence);
+            result.converged = result.throughputMbps.relativeHalfWidth() <= m_target.relativeHalfWidth &&
+                               result.p99LatencyUs.relativeHalfWidth() <= m_target.relativeHalfWidth;
+            if (result.converged) break;
+        }
+    }
+    result.samples = throughput.size();
+    return result;
+}
+
+void printSequentialResult(const SequentialResult& result, std::ostream& out) {
+    out << toString(result.scenario.standard) << " with " << result.scenario.userCount << " Users, "
+        << toString(result.scenario.traffic.model) << " traffic: ";
+    if (result.steadyState) {
+        out << result.samples << " batch means from " << result.batches << " batches";
+    } else {
+        out << result.samples << " replications";
+    }
+    out << (result.converged ? "" : " (target not reached)") << "\n";
+    if (result.steadyState) {
+        out << "Warm-up: " << result.warmupBatches << " batches ("
+            << std::chrono::duration<double, std::milli>(result.warmup).count() << " ms) dropped\n";
+    }
+    out << "Simulated Time: " << std::chrono::duration<double, std::milli>(result.simulatedTime).count() << " ms\n";
+    out << "Throughput: " << result.throughputMbps.mean << " +/- "
+        << result.throughputMbps.halfWidth << " Mbps\n";
+    out << "p99 Latency: " << result.p99LatencyUs.mean << " +/- "
+        << result.p99LatencyUs.halfWidth << " microseconds\n";
+}
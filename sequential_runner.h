@@ -0,0 +1,71 @@
+#ifndef SEQUENTIAL_RUNNER_H
+#define SEQUENTIAL_RUNNER_H
+
+#include "replication_runner.h"
+
+// When to stop sampling a scenario
+struct PrecisionTarget {
+    double relativeHalfWidth = 0.05;  // On both throughput and p99 latency
+    double confidence = 0.95;
+    size_t minSamples = 10;           // Batches or replications
+    size_t maxSamples = 200;          // Most batches or replications to run
+    SimTime batchDuration = std::chrono::milliseconds(100);  // Steady state: simulated time per batch
+};
+
+// Outcome of a sequential run: the intervals and what it took to reach them
+struct SequentialResult {
+    ReplicationScenario scenario;
+    bool steadyState = false;    // Batch means over one run; otherwise replications
+    bool converged = false;      // Both intervals met the target before maxSamples
+    size_t samples = 0;          // Batch groups or replications behind the intervals
+    size_t batches = 0;          // Steady state: batches simulated, warm-up included
+    size_t warmupBatches = 0;    // Steady state: batches dropped as warm-up
+    SimTime warmup = SimTime::zero();
+    SimTime simulatedTime = SimTime::zero();  // Summed over replications
+    ConfidenceInterval throughputMbps;
+    ConfidenceInterval p99LatencyUs;
+};
+
+// Runs a scenario only until its throughput and p99 latency are known to
+// a relative confidence-interval half-width, instead of for a fixed number
+// of rounds or replications.
+//
+// Traffic that never ends (saturated, Poisson, CBR, on/off) is one long
+// run, advanced one batch of PrecisionTarget::batchDuration at a time.
+// The warm-up is the MSER-5 truncation point of the batch series (the
+// larger of throughput's and p99's), and the batches after it give the
+// intervals; adjacent batches are merged while they are still correlated.
+// The scenario's iteration limit and traffic duration are ignored.
+//
+// Finite workloads (backlog, replay) start from the same empty cell each
+// time, so they have no steady state: whole replications are added, a
+// wave of one per thread at a time, with the same seeds as
+// ReplicationRunner.
+class SequentialRunner {
+private:
+    ReplicationRunner m_replications;
+    PrecisionTarget m_target;
+
+    SequentialResult runBatches(const ReplicationScenario& scenario);
+    SequentialResult runReplications(const ReplicationScenario& scenario);
+
+public:
+    // threadCount == 0 uses every hardware thread
+    SequentialRunner(std::uint64_t masterSeed, const PrecisionTarget& target = PrecisionTarget(),
+                     size_t threadCount = 0);
+
+    SequentialResult run(const ReplicationScenario& scenario);
+
+    const PrecisionTarget& getTarget() const { return m_target; }
+    size_t getThreadCount() const { return m_replications.getThreadCount(); }
+};
+
+// Truncation point minimizing the MSER statistic of `series`: the number
+// of leading values to drop, at most half of them
+size_t mserTruncation(const std::vector<double>& series);
+
+// Print a sequential result as "mean +/- half-width" lines with the
+// samples it needed
+void printSequentialResult(const SequentialResult& result, std::ostream& out = std::cout);
+
+#endif // SEQUENTIAL_RUNNER_H
@@ -0,0 +1,29 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstdint>
+
+// Portable 4-wide vectors for the data-parallel kernels. GCC and Clang
+// vector extensions lower them to SSE on x86 and NEON on ARM; kernels
+// guard their vector paths with WIFI_SIMD and keep a scalar fallback.
+#if defined(__GNUC__) || defined(__clang__)
+#define WIFI_SIMD 1
+
+namespace simd {
+
+typedef float Float4 __attribute__((vector_size(16)));
+typedef std::int32_t Int4 __attribute__((vector_size(16)));
+
+// Unaligned aliases for loading and storing straight from float arrays
+typedef float Float4Unaligned __attribute__((vector_size(16), aligned(4), may_alias));
+
+inline Float4 load(const float* p) { return *reinterpret_cast<const Float4Unaligned*>(p); }
+inline void store(float* p, Float4 value) { *reinterpret_cast<Float4Unaligned*>(p) = value; }
+inline Float4 broadcast(float value) { return Float4{value, value, value, value}; }
+inline Int4 broadcast(std::int32_t value) { return Int4{value, value, value, value}; }
+
+} // namespace simd
+
+#endif
+
+#endif // SIMD_H
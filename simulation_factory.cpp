@@ -0,0 +1,32 @@
+#include "simulation_factory.h"
+
+std::unique_ptr<WiFiSimulation> createSimulation(WiFiStandard standard, size_t userCount,
+                                                 std::uint64_t seed, const PhyConfig& phy,
+                                                 const TrafficConfig& traffic) {
+    std::unique_ptr<WiFiSimulation> simulation;
+    switch (standard) {
+    case WiFiStandard::WIFI4:
+        simulation = createWiFi4Simulation(userCount, seed);
+        break;
+    case WiFiStandard::WIFI5:
+        simulation = createWiFi5Simulation(userCount, seed);
+        break;
+    case WiFiStandard::WIFI6:
+        simulation = createWiFi6Simulation(userCount, seed);
+        break;
+    default:
+        throw WiFiSimulationException("Unknown WiFi standard");
+    }
+    simulation->setPhyConfig(phy);
+    simulation->setTrafficConfig(traffic);
+    return simulation;
+}
+
+int getDefaultIterations(WiFiStandard standard) {
+    switch (standard) {
+    case WiFiStandard::WIFI4: return DcfMac::DEFAULT_ITERATIONS;
+    case WiFiStandard::WIFI5: return MuMimoMac::DEFAULT_ITERATIONS;
+    case WiFiStandard::WIFI6: return OfdmaMac::DEFAULT_ITERATIONS;
+    }
+    throw WiFiSimulationException("Unknown WiFi standard");
+}
@@ -0,0 +1,17 @@
+#ifndef SIMULATION_FACTORY_H
+#define SIMULATION_FACTORY_H
+
+#include "wifi4_simulation.h"
+#include "wifi5_simulation.h"
+#include "wifi6_simulation.h"
+
+// Factory method to create a simulation of any standard behind the common interface
+std::unique_ptr<WiFiSimulation> createSimulation(WiFiStandard standard, size_t userCount,
+                                                 std::uint64_t seed = DEFAULT_SIMULATION_SEED,
+                                                 const PhyConfig& phy = PhyConfig(),
+                                                 const TrafficConfig& traffic = TrafficConfig());
+
+// MAX_ITERATIONS the standard's simulation uses unless told otherwise
+int getDefaultIterations(WiFiStandard standard);
+
+#endif // SIMULATION_FACTORY_H
@@ -0,0 +1,107 @@
+#include "simulation_snapshot.h"
+#include "snapshot.h"
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+const char SNAPSHOT_MAGIC[4] = {'W', 'S', 'N', 'P'};
+const std::uint32_t SNAPSHOT_VERSION = 3;
+
+struct SnapshotHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t standard;
+    std::uint32_t reserved;
+    std::uint64_t stations;
+    std::uint64_t bodyBytes;
+};
+
+} // namespace
+
+SimulationSnapshot::SimulationSnapshot(const WiFiSimulation& simulation)
+    : m_standard(simulation.getStandard()),
+      m_state(simulation.fork()) {}
+
+std::unique_ptr<WiFiSimulation> SimulationSnapshot::fork() const {
+    return m_state->fork();
+}
+
+std::vector<SimulationMetrics> SimulationSnapshot::runBranches(
+    const std::vector<std::function<void(WiFiSimulation&)>>& branches, ThreadPool& pool) const {
+    std::vector<std::future<SimulationMetrics>> pending;
+    pending.reserve(branches.size());
+    for (const auto& branch : branches) {
+        pending.push_back(pool.submit([this, &branch]() {
+            std::unique_ptr<WiFiSimulation> child = fork();
+            if (branch) branch(*child);
+            child->runSimulation();
+            return child->collectMetrics();
+        }));
+    }
+
+    std::vector<SimulationMetrics> results;
+    results.reserve(branches.size());
+    for (auto& future : pending) {
+        results.push_back(future.get());
+    }
+    return results;
+}
+
+void SimulationSnapshot::save(std::ostream& out) const {
+    std::vector<std::uint8_t> body;
+    SnapshotWriter writer(body);
+    m_state->saveState(writer);
+
+    SnapshotHeader header;
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, 4);
+    header.version = SNAPSHOT_VERSION;
+    header.standard = static_cast<std::uint32_t>(m_standard);
+    header.reserved = 0;
+    header.stations = getUserCount();
+    header.bodyBytes = body.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(body.data()), static_cast<std::streamsize>(body.size()));
+    if (!out) throw WiFiSimulationException("Failed to write simulation snapshot");
+}
+
+void SimulationSnapshot::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw WiFiSimulationException("Cannot create snapshot file " + path);
+    save(out);
+}
+
+SimulationSnapshot SimulationSnapshot::load(std::istream& in) {
+    SnapshotHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, SNAPSHOT_MAGIC, 4) != 0) {
+        throw WiFiSimulationException("Not a simulation snapshot");
+    }
+    if (header.version != SNAPSHOT_VERSION) {
+        throw WiFiSimulationException("Unsupported snapshot version " + std::to_string(header.version));
+    }
+    if (header.standard > static_cast<std::uint32_t>(WiFiStandard::WIFI6)) {
+        throw WiFiSimulationException("Unknown WiFi standard in simulation snapshot");
+    }
+
+    std::vector<std::uint8_t> body(static_cast<size_t>(header.bodyBytes));
+    if (!in.read(reinterpret_cast<char*>(body.data()), static_cast<std::streamsize>(body.size()))) {
+        throw WiFiSimulationException("Truncated simulation snapshot");
+    }
+
+    // Build the standard's object graph, then overwrite all of its state
+    const WiFiStandard standard = static_cast<WiFiStandard>(header.standard);
+    std::shared_ptr<WiFiSimulation> simulation = createSimulation(standard, static_cast<size_t>(header.stations));
+    SnapshotReader reader(body.data(), body.size());
+    simulation->loadState(reader);
+    if (!reader.atEnd() || simulation->getStations().size() != header.stations) {
+        throw WiFiSimulationException("Corrupt simulation snapshot");
+    }
+    return SimulationSnapshot(standard, std::move(simulation));
+}
+
+SimulationSnapshot SimulationSnapshot::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw WiFiSimulationException("Cannot open snapshot file " + path);
+    return load(in);
+}
@@ -0,0 +1,54 @@
+#ifndef SIMULATION_SNAPSHOT_H
+#define SIMULATION_SNAPSHOT_H
+
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "simulation_factory.h"
+#include "thread_pool.h"
+
+// Frozen state of a running simulation, the branch point of what-if
+// studies: run the shared warm-up once, capture it, then fork any number
+// of children, change each one (add users, traffic, PHY) and run it on.
+// The captured copy is never run, so fork() may be called from many
+// threads at once; children share its station columns copy-on-write.
+//
+// Snapshot file layout (host byte order): "WSNP", a u32 format version, a
+// u32 standard, a u64 station count, a u64 body length, then the body
+// written by the simulation's saveState(). Files are read back by the
+// same build; replay traffic reopens its file from the saved path.
+class SimulationSnapshot {
+private:
+    WiFiStandard m_standard;
+    std::shared_ptr<const WiFiSimulation> m_state;
+
+    SimulationSnapshot(WiFiStandard standard, std::shared_ptr<const WiFiSimulation> state)
+        : m_standard(standard), m_state(std::move(state)) {}
+
+public:
+    // Capture `simulation` as it is now; it may go on running afterwards
+    explicit SimulationSnapshot(const WiFiSimulation& simulation);
+
+    WiFiStandard getStandard() const { return m_standard; }
+    SimTime getSimulatedTime() const { return m_state->getSimulatedTime(); }
+    size_t getUserCount() const { return m_state->getStations().size(); }
+
+    // New simulation continuing from the captured state
+    std::unique_ptr<WiFiSimulation> fork() const;
+
+    // Fork one child per branch on `pool`, apply the branch to it, run it
+    // to completion and collect its metrics (in branch order). An empty
+    // branch continues the captured run unchanged.
+    std::vector<SimulationMetrics> runBranches(
+        const std::vector<std::function<void(WiFiSimulation&)>>& branches, ThreadPool& pool) const;
+
+    void save(std::ostream& out) const;
+    void save(const std::string& path) const;
+    static SimulationSnapshot load(std::istream& in);
+    static SimulationSnapshot load(const std::string& path);
+};
+
+#endif // SIMULATION_SNAPSHOT_H
@@ -0,0 +1,323 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "WiFiSimulation.h"
+#include "profiler.h"
+#include "snapshot.h"
+
+// Discrete-event simulation of one cell, composed at compile time from
+//
+//   MacPolicy        channel access: the events of one round and when the
+//                    next round may start (DcfMac, MuMimoMac, OfdmaMac)
+//   PhyPolicy        the access point model, its random stream, its peak
+//                    throughput and the standard it stands for (HtPhy,
+//                    VhtPhy, HePhy)
+//   SchedulerPolicy  per-station access state of the backlogged stations
+//                    (DcfBackoff, BacklogPolling, RuQueue)
+//
+// The standards are the compositions WiFi4Simulation, WiFi5Simulation and
+// WiFi6Simulation. Only handleEvent() is reached through a virtual call
+// (from the event scheduler); the policies and the access point below it
+// are called directly and inline into the event loop.
+//
+// A MacPolicy is a friend: its startRound(sim, time, round) schedules the
+// round's first event, and its handleEvent(sim, event) runs the round's
+// events and ends the round with sim.continueAccess().
+template <typename MacPolicy, typename PhyPolicy, typename SchedulerPolicy>
+class Simulator final : public EventHandler {
+public:
+    using AccessPointType = typename PhyPolicy::AccessPointType;
+    static constexpr WiFiStandard STANDARD = PhyPolicy::STANDARD;
+
+private:
+    friend MacPolicy;
+
+    enum EventType : std::uint16_t {
+        TRAFFIC_ARRIVAL = 4  // target = station (0-3 are the MAC policies' rounds)
+    };
+
+    StationTable m_stations;
+    AccessPointType m_accessPoint;
+
+    // Discrete-event core
+    EventScheduler m_scheduler;
+    std::uint16_t m_handlerId;
+    int m_maxIterations;
+
+    // Traffic sources and the MAC's idle/busy state. The MAC goes idle when
+    // every queue is empty and is woken by the next arrival.
+    TrafficGenerator m_traffic;
+    bool m_accessActive;
+    std::uint32_t m_nextRound;
+    SimTime m_resumeTime;  // Earliest time the next round may start
+    bool m_started;        // Traffic sources running
+
+    SchedulerPolicy m_userScheduler;
+    MacPolicy m_mac;
+
+    // A station's queue just went from empty to non-empty
+    void activateStation(StationId station) { m_userScheduler.activate(m_stations, m_accessPoint, station); }
+
+    // Start a round at `time` unless the MAC is already busy, every queue is
+    // empty or the iteration limit is reached
+    void wakeAccess(SimTime time) {
+        if (m_accessActive || m_stations.getQueuedPackets() == 0) return;
+        if (m_maxIterations > 0 && m_nextRound >= static_cast<std::uint32_t>(m_maxIterations)) return;
+
+        m_accessActive = true;
+        m_mac.startRound(*this, std::max(time, m_resumeTime), m_nextRound);
+    }
+
+    // End of a round: go on with `round` at `time`, or go idle
+    void continueAccess(SimTime time, std::uint32_t round) {
+        m_accessActive = false;
+        m_nextRound = round;
+        m_resumeTime = time;
+        wakeAccess(time);
+    }
+
+public:
+    Simulator(size_t userCount, const std::string& apId = "AP1",
+              std::uint64_t seed = DEFAULT_SIMULATION_SEED);
+
+    // Copy for fork(): shares the station columns copy-on-write and
+    // rebinds the copied events to the copy. The trace writer is not copied.
+    Simulator(const Simulator& other);
+    Simulator& operator=(const Simulator&) = delete;
+
+    void setMaxIterations(int iterations) { m_maxIterations = iterations; }
+    int getMaxIterations() const { return m_maxIterations; }
+
+    void setTrafficConfig(const TrafficConfig& config) { m_traffic.setConfig(config); }
+    const TrafficGenerator& getTraffic() const { return m_traffic; }
+
+    void setPhyConfig(const PhyConfig& phy) { m_accessPoint.setPhyConfig(phy); }
+
+    SimTime getSimulatedTime() const { return m_scheduler.now(); }
+
+    StationTable& getStations() { return m_stations; }
+    const StationTable& getStations() const { return m_stations; }
+
+    AccessPointType& getAccessPoint() { return m_accessPoint; }
+    const AccessPointType& getAccessPoint() const { return m_accessPoint; }
+
+    const SchedulerPolicy& getUserScheduler() const { return m_userScheduler; }
+
+    void handleEvent(const SimulationEvent& event) override {
+        if (event.type == TRAFFIC_ARRIVAL) {
+            if (m_traffic.handleArrival(m_stations, m_scheduler, event)) {
+                activateStation(static_cast<StationId>(event.target));
+            }
+            wakeAccess(event.time);
+            return;
+        }
+        m_mac.handleEvent(*this, event);
+    }
+
+    void start();
+    void runUntil(SimTime endTime);
+    void runSimulation();
+    void printSimulationResults() const;
+    StationId addUsers(size_t count);
+    SimulationMetrics collectMetrics() const;
+
+    std::unique_ptr<Simulator> fork() const { return std::make_unique<Simulator>(*this); }
+
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+};
+
+template <typename MacPolicy, typename PhyPolicy, typename SchedulerPolicy>
+Simulator<MacPolicy, PhyPolicy, SchedulerPolicy>::Simulator(size_t userCount, const std::string& apId,
+                                                            std::uint64_t seed)
+    : m_stations(userCount),
+      m_accessPoint(apId, PhyPolicy::accessPointSeed(seed)),
+      m_handlerId(m_scheduler.registerHandler(this)),
+      m_maxIterations(MacPolicy::DEFAULT_ITERATIONS),
+      m_traffic(TrafficConfig(), deriveStreamSeed(seed, 5)),
+      m_accessActive(false),
+      m_nextRound(0),
+      m_resumeTime(SimTime::zero()),
+      m_started(false),
+      m_userScheduler(seed) {
+    m_userScheduler.resize(userCount);
+
+    // Connect users to access point; their packets come from m_traffic
+    for (StationId station = 0; station < userCount; ++station) {
+        m_accessPoint.addUser(station);
+    }
+}
+
+template <typename MacPolicy, typename PhyPolicy, typename SchedulerPolicy>
+Simulator<MacPolicy, PhyPolicy, SchedulerPolicy>::Simulator(const Simulator& other)
+    : EventHandler(other),
+      m_stations(other.m_stations),
+      m_accessPoint(other.m_accessPoint),
+      m_scheduler(other.m_scheduler),
+      m_handlerId(other.m_handlerId),
+      m_maxIterations(other.m_maxIterations),
+      m_traffic(other.m_traffic),
+      m_accessActive(other.m_accessActive),
+      m_nextRound(other.m_nextRound),
+      m_resumeTime(other.m_resumeTime),
+      m_started(other.m_started),
+      m_userScheduler(other.m_userScheduler),
+      m_mac(other.m_mac) {
+    m_scheduler.setHandler(m_handlerId, this);
+    m_stations.setTraceWriter(nullptr);
+}
+
+template <typename MacPolicy, typename PhyPolicy, typename SchedulerPolicy>
+void Simulator<MacPolicy, PhyPolicy, SchedulerPolicy>::start() {
+    if (m_started) return;
+    m_started = true;
+    m_traffic.start(m_stations, m_scheduler, m_handlerId, TRAFFIC_ARRIVAL);
+    for (StationId station = m_stations.nextBacklogged(0); station != NO_STATION;
+         station = m_stations.nextBacklogged(station + 1)) {
+        activateStation(station);
+    }
+    wakeAccess(m_scheduler.now());
+}
+
+template <typename MacPolicy, typename PhyPolicy, typename SchedulerPolicy>
+void Simulator<MacPolicy, PhyPolicy, SchedulerPolicy>::runUntil(SimTime endTime) {
+    PROFILE_SCOPE("Simulator::run");
+    start();
+    m_scheduler.runUntil(endTime);
+}
+
+template <typename MacPolicy, typename PhyPolicy, typename SchedulerPolicy>
+void Simulator<MacPolicy, PhyPolicy, SchedulerPolicy>::runSimulation() {
+    PROFILE_SCOPE("Simulator::run");
+    start();
+    m_scheduler.run();
+}
+
+template <typename MacPolicy, typename PhyPolicy, typename SchedulerPolicy>
+StationId Simulator<MacPolicy, PhyPolicy, SchedulerPolicy>::addUsers(size_t count) {
+    const StationId first = m_stations.addStations(count);
+    for (StationId station = first; station < m_stations.size(); ++station) {
+        m_accessPoint.addUser(station);
+    }
+    m_userScheduler.resize(m_stations.size());
+    if (m_started) {
+        m_traffic.addStations(m_stations, m_scheduler, first, m_handlerId, TRAFFIC_ARRIVAL);
+        for (StationId station = m_stations.nextBacklogged(first); station != NO_STATION;
+             station = m_stations.nextBacklogged(station + 1)) {
+            activateStation(station);
+        }
+        wakeAccess(m_scheduler.now());
+    }
+    return first;
+}
+
+template <typename MacPolicy, typename PhyPolicy, typename SchedulerPolicy>
+SimulationMetrics Simulator<MacPolicy, PhyPolicy, SchedulerPolicy>::collectMetrics() const {
+    SimulationMetrics metrics = collectStationMetrics(m_stations);
+    metrics.collisions = m_userScheduler.getCollisions();
+    return metrics;
+}
+
+template <typename MacPolicy, typename PhyPolicy, typename SchedulerPolicy>
+void Simulator<MacPolicy, PhyPolicy, SchedulerPolicy>::printSimulationResults() const {
+    // Calculate and print throughput and latency
+    std::cout << toString(STANDARD) << " Simulation Results:\n";
+    std::cout << "Max Theoretical Throughput: "
+              << PhyPolicy::maxThroughput(m_accessPoint) << " Mbps\n";
+
+    SimulationMetrics metrics = collectMetrics();
+    std::cout << "Achieved Throughput: " << metrics.throughputMbps << " Mbps\n";
+    std::cout<< "Average Latency of "<< m_stations.size() << " Users: " << metrics.avgLatencyUs << " microseconds\n";
+    std::cout<< "Max Latency of "<< m_stations.size() << " Users: " << metrics.maxLatencyUs << " microseconds\n";
+    m_userScheduler.printSummary(m_accessPoint, std::cout);
+    printLatencyPercentiles(metrics.latency);
+    if (m_traffic.getReplaySkipped() > 0) {
+        std::cout << "Replay records skipped (station beyond the " << m_stations.size()
+                  << " users): " << m_traffic.getReplaySkipped() << "\n";
+    }
+}
+
+template <typename MacPolicy, typename PhyPolicy, typename SchedulerPolicy>
+void Simulator<MacPolicy, PhyPolicy, SchedulerPolicy>::saveState(SnapshotWriter& out) const {
+    m_stations.saveState(out);
+    m_accessPoint.saveState(out);
+    m_scheduler.saveState(out);
+    out.put(m_maxIterations);
+    m_traffic.saveState(out);
+    out.put(m_accessActive);
+    out.put(m_nextRound);
+    out.put(m_resumeTime);
+    out.put(m_started);
+    m_userScheduler.saveState(out);
+    m_mac.saveState(out);
+}
+
+template <typename MacPolicy, typename PhyPolicy, typename SchedulerPolicy>
+void Simulator<MacPolicy, PhyPolicy, SchedulerPolicy>::loadState(SnapshotReader& in) {
+    m_stations.loadState(in);
+    m_accessPoint.loadState(in);
+    m_scheduler.loadState(in);
+    in.get(m_maxIterations);
+    m_traffic.loadState(in);
+    in.get(m_accessActive);
+    in.get(m_nextRound);
+    in.get(m_resumeTime);
+    in.get(m_started);
+    m_userScheduler.loadState(in, m_stations);
+    m_mac.loadState(in);
+}
+
+// Type-erased handle on one composition, behind the WiFiSimulation
+// interface. Constructed in place: a Simulator is never moved, its events
+// point back at it.
+template <typename Sim>
+class SimulationAdapter final : public WiFiSimulation {
+private:
+    Sim m_simulation;
+
+public:
+    template <typename... Args>
+    explicit SimulationAdapter(std::in_place_t, Args&&... args) : m_simulation(std::forward<Args>(args)...) {}
+
+    Sim& get() { return m_simulation; }
+    const Sim& get() const { return m_simulation; }
+
+    WiFiStandard getStandard() const override { return Sim::STANDARD; }
+    void setMaxIterations(int iterations) override { m_simulation.setMaxIterations(iterations); }
+    int getMaxIterations() const override { return m_simulation.getMaxIterations(); }
+    void setTrafficConfig(const TrafficConfig& config) override { m_simulation.setTrafficConfig(config); }
+    const TrafficGenerator& getTraffic() const override { return m_simulation.getTraffic(); }
+    void setPhyConfig(const PhyConfig& phy) override { m_simulation.setPhyConfig(phy); }
+    SimTime getSimulatedTime() const override { return m_simulation.getSimulatedTime(); }
+    StationTable& getStations() override { return m_simulation.getStations(); }
+    const StationTable& getStations() const override { return m_simulation.getStations(); }
+    void start() override { m_simulation.start(); }
+    void runUntil(SimTime endTime) override { m_simulation.runUntil(endTime); }
+    void runSimulation() override { m_simulation.runSimulation(); }
+    void printSimulationResults() override { m_simulation.printSimulationResults(); }
+    StationId addUsers(size_t count) override { return m_simulation.addUsers(count); }
+    SimulationMetrics collectMetrics() const override { return m_simulation.collectMetrics(); }
+    std::unique_ptr<WiFiSimulation> fork() const override { return std::make_unique<SimulationAdapter>(*this); }
+    void saveState(SnapshotWriter& out) const override { m_simulation.saveState(out); }
+    void loadState(SnapshotReader& in) override { m_simulation.loadState(in); }
+};
+
+template <typename Sim>
+Sim* WiFiSimulation::as() {
+    SimulationAdapter<Sim>* adapter = dynamic_cast<SimulationAdapter<Sim>*>(this);
+    return adapter ? &adapter->get() : nullptr;
+}
+
+template <typename Sim>
+const Sim* WiFiSimulation::as() const {
+    const SimulationAdapter<Sim>* adapter = dynamic_cast<const SimulationAdapter<Sim>*>(this);
+    return adapter ? &adapter->get() : nullptr;
+}
+
+#endif // SIMULATOR_H
@@ -0,0 +1,153 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "cow_array.h"
+#include "wifi_common.h"
+
+// Appends simulation state to a byte buffer. Values are stored in host
+// byte order and layout; snapshots are meant to be read back by the same
+// build (the file header carries a format version).
+class SnapshotWriter {
+private:
+    std::vector<std::uint8_t>& m_out;
+
+public:
+    explicit SnapshotWriter(std::vector<std::uint8_t>& out) : m_out(out) {}
+
+    void putBytes(const void* data, size_t length) {
+        const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+        m_out.insert(m_out.end(), bytes, bytes + length);
+    }
+
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values are written directly");
+        putBytes(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void putVector(const std::vector<T>& values) {
+        put<std::uint64_t>(values.size());
+        putBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    template <typename T>
+    void putArray(const CowArray<T>& values) {
+        put<std::uint64_t>(values.size());
+        putBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    void putString(const std::string& value) {
+        put<std::uint64_t>(value.size());
+        putBytes(value.data(), value.size());
+    }
+
+    // Engine state (624 words and the position) as binary words
+    void putGenerator(const std::mt19937& generator) {
+        std::stringstream text;
+        text << generator;
+        std::uint32_t state[std::mt19937::state_size + 1];
+        for (std::uint32_t& word : state) {
+            if (!(text >> word)) throw WiFiSimulationException("Unexpected random engine state");
+        }
+        putBytes(state, sizeof(state));
+    }
+
+    // Any standard random object, through its text state
+    template <typename Random>
+    void putRandomState(const Random& random);
+};
+
+// Reads back what a SnapshotWriter wrote, in the same order; throws on a
+// truncated buffer
+class SnapshotReader {
+private:
+    const std::uint8_t* m_cursor;
+    const std::uint8_t* m_end;
+
+public:
+    SnapshotReader(const std::uint8_t* data, size_t length) : m_cursor(data), m_end(data + length) {}
+
+    void getBytes(void* data, size_t length) {
+        if (static_cast<size_t>(m_end - m_cursor) < length) {
+            throw WiFiSimulationException("Truncated simulation snapshot");
+        }
+        std::memcpy(data, m_cursor, length);
+        m_cursor += length;
+    }
+
+    template <typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values are read directly");
+        T value;
+        getBytes(&value, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void get(T& value) { value = get<T>(); }
+
+    template <typename T>
+    void getVector(std::vector<T>& values) {
+        values.resize(getCount(sizeof(T)));
+        getBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    template <typename T>
+    void getArray(CowArray<T>& values) {
+        values.resize(getCount(sizeof(T)));
+        getBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    std::string getString() {
+        std::string value(getCount(1), '\0');
+        getBytes(&value[0], value.size());
+        return value;
+    }
+
+    void getGenerator(std::mt19937& generator) {
+        std::uint32_t state[std::mt19937::state_size + 1];
+        getBytes(state, sizeof(state));
+        std::stringstream text;
+        for (std::uint32_t word : state) text << word << ' ';
+        if (!(text >> generator)) throw WiFiSimulationException("Corrupt random state in simulation snapshot");
+    }
+
+    template <typename Random>
+    void getRandomState(Random& random);
+
+    // Element count of a vector, checked against the bytes left
+    size_t getCount(size_t elementSize) {
+        std::uint64_t count = get<std::uint64_t>();
+        if (elementSize > 0 && count > static_cast<std::uint64_t>(m_end - m_cursor) / elementSize) {
+            throw WiFiSimulationException("Truncated simulation snapshot");
+        }
+        return static_cast<size_t>(count);
+    }
+
+    bool atEnd() const { return m_cursor == m_end; }
+};
+
+template <typename Random>
+void SnapshotWriter::putRandomState(const Random& random) {
+    std::ostringstream text;
+    text << random;
+    putString(text.str());
+}
+
+template <typename Random>
+void SnapshotReader::getRandomState(Random& random) {
+    std::istringstream text(getString());
+    text >> random;
+    if (!text) throw WiFiSimulationException("Corrupt random state in simulation snapshot");
+}
+
+#endif // SNAPSHOT_H
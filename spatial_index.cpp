@@ -0,0 +1,135 @@
+#include "spatial_index.h"
+#include "WiFiSimulation.h"
+#include <algorithm>
+#include <cmath>
+
+void SpatialGrid::reset(const Position& low, const Position& high, double cellSize) {
+    if (!(cellSize > 0.0) || high.x < low.x || high.y < low.y) {
+        throw WiFiSimulationException("Invalid spatial grid");
+    }
+    m_origin = low;
+    m_cellSize = cellSize;
+    m_columns = static_cast<std::uint32_t>(std::floor((high.x - low.x) / cellSize)) + 1;
+    m_rows = static_cast<std::uint32_t>(std::floor((high.y - low.y) / cellSize)) + 1;
+    m_cells.assign(static_cast<size_t>(m_columns) * m_rows, {});
+    m_x.clear();
+    m_y.clear();
+    m_cellOf.clear();
+    m_slot.clear();
+}
+
+std::uint32_t SpatialGrid::column(double x) const {
+    double index = std::floor((x - m_origin.x) / m_cellSize);
+    return static_cast<std::uint32_t>(std::min(std::max(index, 0.0), m_columns - 1.0));
+}
+
+std::uint32_t SpatialGrid::row(double y) const {
+    double index = std::floor((y - m_origin.y) / m_cellSize);
+    return static_cast<std::uint32_t>(std::min(std::max(index, 0.0), m_rows - 1.0));
+}
+
+double SpatialGrid::cellDistanceSquared(const Position& position, std::uint32_t column,
+                                        std::uint32_t row) const {
+    // Edge cells also hold every position beyond them, so they extend outwards
+    auto axis = [this](double value, double origin, std::uint32_t index, std::uint32_t count) {
+        double low = origin + index * m_cellSize;
+        double high = low + m_cellSize;
+        if (value < low && index > 0) return low - value;
+        if (value > high && index + 1 < count) return value - high;
+        return 0.0;
+    };
+    double dx = axis(position.x, m_origin.x, column, m_columns);
+    double dy = axis(position.y, m_origin.y, row, m_rows);
+    return dx * dx + dy * dy;
+}
+
+void SpatialGrid::file(std::uint32_t entry, std::uint32_t cell) {
+    m_cellOf[entry] = cell;
+    m_slot[entry] = static_cast<std::uint32_t>(m_cells[cell].size());
+    m_cells[cell].push_back(entry);
+}
+
+void SpatialGrid::unfile(std::uint32_t entry) {
+    // Swap-remove: the cell's last entry takes this entry's slot
+    std::vector<std::uint32_t>& members = m_cells[m_cellOf[entry]];
+    std::uint32_t last = members.back();
+    members[m_slot[entry]] = last;
+    m_slot[last] = m_slot[entry];
+    members.pop_back();
+}
+
+std::uint32_t SpatialGrid::insert(const Position& position) {
+    std::uint32_t entry = static_cast<std::uint32_t>(m_x.size());
+    m_x.push_back(position.x);
+    m_y.push_back(position.y);
+    m_cellOf.push_back(0);
+    m_slot.push_back(0);
+    file(entry, cellAt(position));
+    return entry;
+}
+
+void SpatialGrid::move(std::uint32_t entry, const Position& position) {
+    if (entry >= m_x.size()) {
+        throw WiFiSimulationException("Unknown spatial grid entry");
+    }
+    m_x[entry] = position.x;
+    m_y[entry] = position.y;
+    std::uint32_t cell = cellAt(position);
+    if (cell != m_cellOf[entry]) {
+        unfile(entry);
+        file(entry, cell);
+    }
+}
+
+void SpatialGrid::query(const Position& center, double radius, std::vector<std::uint32_t>& entries) const {
+    entries.clear();
+    forEachWithin(center, radius, [&entries](std::uint32_t entry, double) { entries.push_back(entry); });
+    std::sort(entries.begin(), entries.end());
+}
+
+std::uint32_t SpatialGrid::nearest(const Position& position) const {
+    const std::uint32_t centerColumn = column(position.x);
+    const std::uint32_t centerRow = row(position.y);
+    const std::uint32_t maxRing = std::max(m_columns, m_rows);
+
+    std::uint32_t best = NO_ENTRY;
+    double bestSquared = 0.0;
+    auto visitCell = [&](std::int64_t c, std::int64_t r) {
+        if (c < 0 || r < 0 || c >= m_columns || r >= m_rows) return;
+        for (std::uint32_t entry : m_cells[r * m_columns + c]) {
+            double dx = m_x[entry] - position.x;
+            double dy = m_y[entry] - position.y;
+            double distanceSquared = dx * dx + dy * dy;
+            if (best == NO_ENTRY || distanceSquared < bestSquared ||
+                (distanceSquared == bestSquared && entry < best)) {
+                best = entry;
+                bestSquared = distanceSquared;
+            }
+        }
+    };
+
+    for (std::uint32_t ring = 0; ring <= maxRing; ++ring) {
+        // Every cell of this ring is at least (ring - 1) cells away
+        if (best != NO_ENTRY && ring > 0) {
+            double bound = (ring - 1) * m_cellSize;
+            if (bound * bound > bestSquared) break;
+        }
+        std::int64_t c0 = static_cast<std::int64_t>(centerColumn) - ring;
+        std::int64_t c1 = static_cast<std::int64_t>(centerColumn) + ring;
+        std::int64_t r0 = static_cast<std::int64_t>(centerRow) - ring;
+        std::int64_t r1 = static_cast<std::int64_t>(centerRow) + ring;
+        if (ring == 0) {
+            visitCell(c0, r0);
+            continue;
+        }
+        for (std::int64_t c = c0; c <= c1; ++c) {
+            visitCell(c, r0);
+            visitCell(c, r1);
+        }
+        for (std::int64_t r = r0 + 1; r < r1; ++r) {
+            visitCell(c0, r);
+            visitCell(c1, r);
+        }
+    }
+    return best;
+}
@@ -0,0 +1,88 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <cstdint>
+#include <vector>
+
+#include "wifi_common.h"
+
+// Uniform grid over entity positions (a cell list). Each entry is filed
+// under the square cell holding its position, so a range query only looks
+// at the cells overlapping the query disc instead of every entity: with a
+// cell size near the query radius that is O(1) cells and O(density)
+// entries per query, and O(n) for a query per entity. Positions outside the
+// bounds are filed under the nearest edge cell, so queries stay exact.
+// Entries are numbered in insertion order and can move; a move only
+// touches the two cells involved.
+class SpatialGrid {
+private:
+    Position m_origin;
+    double m_cellSize;
+    std::uint32_t m_columns;
+    std::uint32_t m_rows;
+    std::vector<std::vector<std::uint32_t>> m_cells;  // Entries per cell, row-major
+
+    // Per entry
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<std::uint32_t> m_cellOf;
+    std::vector<std::uint32_t> m_slot;  // Index within its cell's list
+
+    std::uint32_t column(double x) const;
+    std::uint32_t row(double y) const;
+    std::uint32_t cellAt(const Position& position) const { return row(position.y) * m_columns + column(position.x); }
+    void file(std::uint32_t entry, std::uint32_t cell);
+    void unfile(std::uint32_t entry);
+
+    // Squared distance from `position` to the nearest point of a cell
+    double cellDistanceSquared(const Position& position, std::uint32_t column, std::uint32_t row) const;
+
+public:
+    static constexpr std::uint32_t NO_ENTRY = UINT32_MAX;
+
+    SpatialGrid() : m_cellSize(1.0), m_columns(1), m_rows(1), m_cells(1) {}
+
+    // Grid covering [low, high] with square cells; drops every entry
+    void reset(const Position& low, const Position& high, double cellSize);
+
+    std::uint32_t insert(const Position& position);
+    void move(std::uint32_t entry, const Position& position);
+
+    size_t size() const { return m_x.size(); }
+    Position getPosition(std::uint32_t entry) const { return {m_x[entry], m_y[entry]}; }
+    double getCellSize() const { return m_cellSize; }
+
+    // Call visit(entry, distance) for every entry closer than `radius`
+    template <typename Visitor>
+    void forEachWithin(const Position& center, double radius, Visitor&& visit) const;
+
+    // Entries closer than `radius`, in ascending order
+    void query(const Position& center, double radius, std::vector<std::uint32_t>& entries) const;
+
+    // Nearest entry (lowest index on ties), or NO_ENTRY if empty. Searches
+    // rings of cells outwards until no closer entry can remain.
+    std::uint32_t nearest(const Position& position) const;
+};
+
+template <typename Visitor>
+void SpatialGrid::forEachWithin(const Position& center, double radius, Visitor&& visit) const {
+    const double radiusSquared = radius * radius;
+    const std::uint32_t firstColumn = column(center.x - radius);
+    const std::uint32_t lastColumn = column(center.x + radius);
+    const std::uint32_t firstRow = row(center.y - radius);
+    const std::uint32_t lastRow = row(center.y + radius);
+    for (std::uint32_t r = firstRow; r <= lastRow; ++r) {
+        for (std::uint32_t c = firstColumn; c <= lastColumn; ++c) {
+            // Corner cells of the bounding square can lie wholly outside the disc
+            if (cellDistanceSquared(center, c, r) >= radiusSquared) continue;
+            for (std::uint32_t entry : m_cells[r * m_columns + c]) {
+                double dx = m_x[entry] - center.x;
+                double dy = m_y[entry] - center.y;
+                double distanceSquared = dx * dx + dy * dy;
+                if (distanceSquared < radiusSquared) visit(entry, std::sqrt(distanceSquared));
+            }
+        }
+    }
+}
+
+#endif // SPATIAL_INDEX_H
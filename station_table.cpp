@@ -0,0 +1,297 @@
+#include "station_table.h"
+#include "snapshot.h"
+#include <algorithm>
+
+// User (station view) Implementation
+std::string User::getId() const {
+    return m_stations->getName(m_station);
+}
+
+void User::addPacket(const PacketDescriptor& packet) {
+    m_stations->enqueue(m_station, packet);
+}
+
+bool User::hasPackets() const {
+    return m_stations->hasPackets(m_station);
+}
+
+PacketDescriptor User::getNextPacket() {
+    PacketDescriptor packet;
+    if (!m_stations->tryDequeue(m_station, packet)) {
+        throw WiFiSimulationException("No packets available");
+    }
+    return packet;
+}
+
+void User::recordTransmissionTime(SimTime time, const PacketDescriptor& packet) {
+    m_stations->recordDelivery(m_station, packet, time);
+}
+
+Position User::getPosition() const {
+    return m_stations->getPosition(m_station);
+}
+
+void User::setPosition(const Position& position) {
+    m_stations->setPosition(m_station, position);
+}
+
+// StationTable Implementation
+StationTable::StationTable(size_t stationCount, size_t queueCapacity)
+    : m_capacityShift(0),
+      m_capacityMask(0),
+      m_sourcePacketSize(1024),
+      m_queuedPackets(0),
+      m_totalDropped(0),
+      m_trace(nullptr) {
+    setQueueCapacity(queueCapacity);
+    addStations(stationCount);
+}
+
+void StationTable::setQueueCapacity(size_t queueCapacity) {
+    if (m_queuedPackets != 0) {
+        throw WiFiSimulationException("Queue capacity can only change while queues are empty");
+    }
+    if (queueCapacity == 0 || queueCapacity > (1u << 20)) {
+        throw WiFiSimulationException("Invalid queue capacity");
+    }
+
+    std::uint32_t shift = 0;
+    while ((static_cast<size_t>(1) << shift) < queueCapacity) {
+        ++shift;
+    }
+    m_capacityShift = shift;
+    m_capacityMask = (1u << shift) - 1;
+    m_ringSlots.assign(size() << m_capacityShift, NO_PACKET);
+    std::fill(m_queueHead.begin(), m_queueHead.end(), 0);
+}
+
+StationId StationTable::addStations(size_t count) {
+    size_t first = size();
+    size_t total = first + count;
+    if (total > UINT32_MAX) {
+        throw WiFiSimulationException("Too many stations");
+    }
+
+    m_ringSlots.resize(total << m_capacityShift, NO_PACKET);
+    m_queueHead.resize(total, 0);
+    m_queueLength.resize(total, 0);
+    m_backloggedWords.resize((total + 63) / 64, 0);
+    m_backloggedSummary.resize((m_backloggedWords.size() + 63) / 64, 0);
+    m_droppedPackets.resize(total, 0);
+    m_sourceBacklog.resize(total, 0);
+    m_linkEfficiency.resize(total, 1.0f);
+    m_position.resize(total);
+    m_deliveredPackets.resize(total, 0);
+    m_deliveredBytes.resize(total, 0);
+    m_lastDelivery.resize(total, SimTime::zero());
+    m_latencySum.resize(total, 0);
+    m_latencyMax.resize(total, SimTime::zero());
+    if (hasStationHistograms()) {
+        m_stationLatency.resize(total);
+    }
+    return static_cast<StationId>(first);
+}
+
+bool StationTable::enqueue(StationId station, const PacketDescriptor& packet) {
+    std::uint32_t length = m_queueLength[station];
+    if (length > m_capacityMask) {
+        // Drop-tail: the ring is full
+        ++m_droppedPackets[station];
+        ++m_totalDropped;
+        trace(TraceEventType::DROP, station, packet.enqueueTime, packet.sizeBytes);
+        return false;
+    }
+
+    std::uint32_t slot = (m_queueHead[station] + length) & m_capacityMask;
+    ring(station)[slot] = m_packets.allocate(packet);
+    m_queueLength[station] = length + 1;
+    if (length == 0) markBacklogged(station);
+    ++m_queuedPackets;
+    trace(TraceEventType::ENQUEUE, station, packet.enqueueTime, packet.sizeBytes);
+    return true;
+}
+
+bool StationTable::tryDequeue(StationId station, PacketDescriptor& packet) {
+    if (m_queueLength[station] == 0) return false;
+
+    std::uint32_t slot = m_queueHead[station] & m_capacityMask;
+    PacketHandle handle = ring(station)[slot];
+    packet = m_packets.get(handle);
+    m_packets.release(handle);
+
+    ++m_queueHead[station];
+    if (--m_queueLength[station] == 0) clearBacklogged(station);
+    --m_queuedPackets;
+    return true;
+}
+
+bool StationTable::dropHead(StationId station, SimTime now) {
+    PacketDescriptor packet;
+    if (!tryDequeue(station, packet)) return false;
+    ++m_droppedPackets[station];
+    ++m_totalDropped;
+    trace(TraceEventType::DROP, station, now, packet.sizeBytes);
+    return true;
+}
+
+PacketSpan StationTable::dequeueBatch(StationId station, size_t maxPackets) {
+    std::uint32_t slot = m_queueHead[station] & m_capacityMask;
+    size_t count = std::min<size_t>(m_queueLength[station], maxPackets);
+
+    // Slots past the wrap point continue at the start of the ring
+    PacketSpan span;
+    span.head = ring(station) + slot;
+    span.headSize = std::min<size_t>(count, getQueueCapacity() - slot);
+    span.wrapped = ring(station);
+    span.wrappedSize = count - span.headSize;
+    for (PacketHandle handle : span) {
+        m_packets.release(handle);
+    }
+
+    m_queueHead[station] += static_cast<std::uint32_t>(count);
+    m_queueLength[station] -= static_cast<std::uint32_t>(count);
+    if (count != 0 && m_queueLength[station] == 0) clearBacklogged(station);
+    m_queuedPackets -= count;
+    return span;
+}
+
+void StationTable::markBacklogged(StationId station) {
+    size_t word = station >> 6;
+    m_backloggedWords[word] |= 1ull << (station & 63);
+    m_backloggedSummary[word >> 6] |= 1ull << (word & 63);
+}
+
+void StationTable::clearBacklogged(StationId station) {
+    size_t word = station >> 6;
+    m_backloggedWords[word] &= ~(1ull << (station & 63));
+    if (m_backloggedWords[word] == 0) {
+        m_backloggedSummary[word >> 6] &= ~(1ull << (word & 63));
+    }
+}
+
+StationId StationTable::nextBacklogged(StationId from) const {
+    if (from >= size()) return NO_STATION;
+
+    // Rest of the word holding `from`
+    size_t word = from >> 6;
+    std::uint64_t bits = m_backloggedWords[word] & (~0ull << (from & 63));
+    if (bits != 0) {
+        return static_cast<StationId>((word << 6) + __builtin_ctzll(bits));
+    }
+
+    // Next non-empty word, found through the summary level
+    size_t next = word + 1;
+    size_t summary = next >> 6;
+    if (summary >= m_backloggedSummary.size()) return NO_STATION;
+    std::uint64_t words = (next & 63) ? m_backloggedSummary[summary] & (~0ull << (next & 63))
+                                      : m_backloggedSummary[summary];
+    while (words == 0) {
+        if (++summary >= m_backloggedSummary.size()) return NO_STATION;
+        words = m_backloggedSummary[summary];
+    }
+    word = (summary << 6) + __builtin_ctzll(words);
+    return static_cast<StationId>((word << 6) + __builtin_ctzll(m_backloggedWords[word]));
+}
+
+void StationTable::refillFromBacklog(StationId station, SimTime now) {
+    PacketDescriptor packet;
+    packet.enqueueTime = now;
+    packet.sizeBytes = m_sourcePacketSize;
+    packet.flowId = station;
+
+    std::uint32_t backlog = m_sourceBacklog[station];
+    while (backlog != 0 && m_queueLength[station] <= m_capacityMask) {
+        enqueue(station, packet);
+        if (backlog != UNLIMITED_BACKLOG) --backlog;
+    }
+    m_sourceBacklog[station] = backlog;
+}
+
+void StationTable::recordDelivery(StationId station, const PacketDescriptor& packet, SimTime time) {
+    trace(TraceEventType::ACK, station, time, packet.sizeBytes);
+    m_lastDelivery[station] = time;
+    ++m_deliveredPackets[station];
+    m_deliveredBytes[station] += packet.sizeBytes;
+
+    SimTime latency = time - packet.enqueueTime;
+    m_latencySum[station] += static_cast<std::uint64_t>(latency.count());
+    m_latencyMax[station] = std::max(m_latencyMax[station], latency);
+    m_latency.record(latency);
+    if (!m_stationLatency.empty()) {
+        m_stationLatency[station].record(latency);
+    }
+}
+
+void StationTable::enableStationHistograms(bool enabled) {
+    if (enabled) {
+        m_stationLatency.resize(size());
+    } else {
+        m_stationLatency.clear();
+        m_stationLatency.shrink_to_fit();
+    }
+}
+
+void StationTable::saveState(SnapshotWriter& out) const {
+    out.put(m_capacityShift);
+    out.putArray(m_ringSlots);
+    out.putArray(m_queueHead);
+    out.putArray(m_queueLength);
+    out.putArray(m_droppedPackets);
+    out.putArray(m_backloggedWords);
+    out.putArray(m_backloggedSummary);
+    out.putArray(m_sourceBacklog);
+    out.put(m_sourcePacketSize);
+    out.putArray(m_linkEfficiency);
+    out.putArray(m_position);
+    out.putArray(m_deliveredPackets);
+    out.putArray(m_deliveredBytes);
+    out.putArray(m_lastDelivery);
+    out.putArray(m_latencySum);
+    out.putArray(m_latencyMax);
+    out.put<std::uint64_t>(m_stationLatency.size());
+    for (const LatencyHistogram& histogram : m_stationLatency) histogram.saveState(out);
+    m_latency.saveState(out);
+    m_packets.saveState(out);
+    out.put<std::uint64_t>(m_queuedPackets);
+    out.put(m_totalDropped);
+}
+
+void StationTable::loadState(SnapshotReader& in) {
+    in.get(m_capacityShift);
+    if (m_capacityShift > 20) throw WiFiSimulationException("Corrupt station table in simulation snapshot");
+    m_capacityMask = (1u << m_capacityShift) - 1;
+    in.getArray(m_ringSlots);
+    in.getArray(m_queueHead);
+    in.getArray(m_queueLength);
+    in.getArray(m_droppedPackets);
+    in.getArray(m_backloggedWords);
+    in.getArray(m_backloggedSummary);
+    in.getArray(m_sourceBacklog);
+    in.get(m_sourcePacketSize);
+    in.getArray(m_linkEfficiency);
+    in.getArray(m_position);
+    in.getArray(m_deliveredPackets);
+    in.getArray(m_deliveredBytes);
+    in.getArray(m_lastDelivery);
+    in.getArray(m_latencySum);
+    in.getArray(m_latencyMax);
+    m_stationLatency.resize(in.getCount(1));
+    for (LatencyHistogram& histogram : m_stationLatency) histogram.loadState(in);
+    m_latency.loadState(in);
+    m_packets.loadState(in);
+    m_queuedPackets = static_cast<size_t>(in.get<std::uint64_t>());
+    in.get(m_totalDropped);
+
+    // Every column must cover the same stations
+    const size_t stations = size();
+    if (m_ringSlots.size() != stations << m_capacityShift || m_queueLength.size() != stations ||
+        m_droppedPackets.size() != stations || m_backloggedWords.size() != (stations + 63) / 64 ||
+        m_backloggedSummary.size() != (m_backloggedWords.size() + 63) / 64 ||
+        m_sourceBacklog.size() != stations || m_linkEfficiency.size() != stations ||
+        m_position.size() != stations || m_deliveredPackets.size() != stations ||
+        m_deliveredBytes.size() != stations || m_lastDelivery.size() != stations ||
+        m_latencySum.size() != stations || m_latencyMax.size() != stations ||
+        (!m_stationLatency.empty() && m_stationLatency.size() != stations)) {
+        throw WiFiSimulationException("Corrupt station table in simulation snapshot");
+    }
+}
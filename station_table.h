@@ -0,0 +1,258 @@
+#ifndef STATION_TABLE_H
+#define STATION_TABLE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "wifi_common.h"
+#include "packet_pool.h"
+#include "latency_histogram.h"
+#include "cow_array.h"
+#include "trace_writer.h"
+
+// Integer station handle; index into every StationTable array
+using StationId = std::uint32_t;
+const StationId NO_STATION = UINT32_MAX;
+
+// Queued packet handles returned by a batch dequeue, in queue order: the
+// ring slots from the head up to the wrap point, then, if the batch
+// wrapped, the slots from the start of the ring
+struct PacketSpan {
+    const PacketHandle* head = nullptr;
+    size_t headSize = 0;
+    const PacketHandle* wrapped = nullptr;
+    size_t wrappedSize = 0;
+
+    class Iterator {
+    private:
+        const PacketHandle* m_at;
+        const PacketHandle* m_runEnd;
+        const PacketHandle* m_next;
+        const PacketHandle* m_nextEnd;
+
+        void skipEmptyRun() {
+            if (m_at == m_runEnd && m_next != m_nextEnd) {
+                m_at = m_next;
+                m_runEnd = m_nextEnd;
+                m_next = m_nextEnd;
+            }
+        }
+
+    public:
+        Iterator(const PacketHandle* at, const PacketHandle* runEnd,
+                 const PacketHandle* next, const PacketHandle* nextEnd)
+            : m_at(at), m_runEnd(runEnd), m_next(next), m_nextEnd(nextEnd) {
+            skipEmptyRun();
+        }
+
+        PacketHandle operator*() const { return *m_at; }
+        Iterator& operator++() {
+            ++m_at;
+            skipEmptyRun();
+            return *this;
+        }
+        bool operator!=(const Iterator& other) const { return m_at != other.m_at; }
+    };
+
+    Iterator begin() const { return Iterator(head, head + headSize, wrapped, wrapped + wrappedSize); }
+    Iterator end() const {
+        const PacketHandle* last = wrappedSize != 0 ? wrapped + wrappedSize : head + headSize;
+        return Iterator(last, last, last, last);
+    }
+    size_t size() const { return headSize + wrappedSize; }
+    bool empty() const { return size() == 0; }
+};
+
+class StationTable;
+
+// Lightweight view of one station in a StationTable
+class User {
+private:
+    StationTable* m_stations;
+    StationId m_station;
+
+public:
+    User(StationTable& stations, StationId station)
+        : m_stations(&stations), m_station(station) {}
+
+    StationId getStationId() const { return m_station; }
+    std::string getId() const;
+
+    void addPacket(const PacketDescriptor& packet);
+    bool hasPackets() const;
+    PacketDescriptor getNextPacket();
+    // Record delivery of `packet` at `time`
+    void recordTransmissionTime(SimTime time, const PacketDescriptor& packet);
+
+    Position getPosition() const;
+    void setPosition(const Position& position);
+};
+
+// Station store laid out as structure-of-arrays. Every per-station attribute
+// lives in its own contiguous array indexed by StationId, so scheduler loops
+// are linear scans over a few arrays instead of walks over heap objects.
+// Packet queues are fixed-capacity power-of-two ring buffers of PacketPool
+// handles, all carved out of one contiguous slot array; per station only the
+// free-running head index, the length and the drop count are stored.
+// Columns are copy-on-write, so copies of a table (forked simulations)
+// share every column until they change it.
+class StationTable {
+private:
+    // Per-station queue state
+    CowArray<PacketHandle> m_ringSlots;   // size() << m_capacityShift slots
+    CowArray<std::uint32_t> m_queueHead;  // Free-running read index
+    CowArray<std::uint32_t> m_queueLength;
+    CowArray<std::uint64_t> m_droppedPackets;
+    std::uint32_t m_capacityShift;
+    std::uint32_t m_capacityMask;
+
+    // Two-level bitmap of stations with a non-empty queue: one bit per
+    // station, and one summary bit per non-zero 64-station word
+    CowArray<std::uint64_t> m_backloggedWords;
+    CowArray<std::uint64_t> m_backloggedSummary;
+
+    // Per-station traffic source backlog (packets not yet admitted to the ring)
+    CowArray<std::uint32_t> m_sourceBacklog;
+    std::uint32_t m_sourcePacketSize;
+
+    // Per-station link state: fraction of the AP's peak PHY rate achieved
+    CowArray<float> m_linkEfficiency;
+    CowArray<Position> m_position;
+
+    // Per-station delivery statistics
+    CowArray<std::uint64_t> m_deliveredPackets;
+    CowArray<std::uint64_t> m_deliveredBytes;
+    CowArray<SimTime> m_lastDelivery;
+
+    // Per-station enqueue-to-delivery latency (count is m_deliveredPackets)
+    CowArray<std::uint64_t> m_latencySum;   // ns
+    CowArray<SimTime> m_latencyMax;
+    CowArray<LatencyHistogram> m_stationLatency;  // Empty unless enabled
+    LatencyHistogram m_latency;                   // Every station of the table
+
+    // Descriptor storage shared by every station's queue
+    PacketPool m_packets;
+    size_t m_queuedPackets;
+    std::uint64_t m_totalDropped;
+
+    TraceWriter* m_trace;  // Optional per-packet event trace
+
+    void refillFromBacklog(StationId station, SimTime now);
+    void markBacklogged(StationId station);
+    void clearBacklogged(StationId station);
+
+    PacketHandle* ring(StationId station) {
+        return m_ringSlots.data() + (static_cast<size_t>(station) << m_capacityShift);
+    }
+
+public:
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY = 16;
+    static constexpr std::uint32_t UNLIMITED_BACKLOG = UINT32_MAX;
+
+    // queueCapacity is rounded up to a power of two
+    explicit StationTable(size_t stationCount = 0, size_t queueCapacity = DEFAULT_QUEUE_CAPACITY);
+
+    // Change the per-station queue capacity; only allowed while all queues are empty
+    void setQueueCapacity(size_t queueCapacity);
+    size_t getQueueCapacity() const { return static_cast<size_t>(m_capacityMask) + 1; }
+
+    // Append `count` stations; returns the id of the first new one
+    StationId addStations(size_t count);
+
+    // Pre-size the packet pool so enqueue never allocates
+    void reservePackets(size_t packetCount) { m_packets.reserve(packetCount); }
+
+    PacketPool& getPacketPool() { return m_packets; }
+
+    size_t size() const { return m_queueHead.size(); }
+
+    // Display name of a station ("User<id>")
+    std::string getName(StationId station) const { return "User" + std::to_string(station); }
+
+    User getUser(StationId station) { return User(*this, station); }
+
+    // Packet queues. enqueue() drops the packet (drop-tail) and returns false
+    // when the station's ring is full.
+    bool enqueue(StationId station, const PacketDescriptor& packet);
+
+    // Pop the head packet; returns false when the queue is empty
+    bool tryDequeue(StationId station, PacketDescriptor& packet);
+
+    // Head packet of a non-empty queue, left in place
+    const PacketDescriptor& peekPacket(StationId station) const {
+        return m_packets.get(m_ringSlots[(static_cast<size_t>(station) << m_capacityShift) +
+                                         (m_queueHead[station] & m_capacityMask)]);
+    }
+
+    // Discard the head packet at `now` (e.g. after too many retries) and count it as dropped
+    bool dropHead(StationId station, SimTime now);
+
+    // Pop up to `maxPackets` packets in one call, in place: the span covers
+    // the ring slots, in two runs when the batch crosses the wrap point.
+    // Handles and the descriptors they refer to stay valid until the next
+    // enqueue into this table.
+    PacketSpan dequeueBatch(StationId station, size_t maxPackets);
+
+    // Backlogged sources: `packets` more packets (UNLIMITED_BACKLOG = saturated)
+    // wait behind the station's queue and move into it as space frees up.
+    // MACs call admitBacklog() after taking packets from a station.
+    void setSourceBacklog(StationId station, std::uint32_t packets) { m_sourceBacklog[station] = packets; }
+    std::uint32_t getSourceBacklog(StationId station) const { return m_sourceBacklog[station]; }
+    void setSourcePacketSize(std::uint32_t sizeBytes) { m_sourcePacketSize = sizeBytes; }
+    void admitBacklog(StationId station, SimTime now) {
+        if (m_sourceBacklog[station] != 0) refillFromBacklog(station, now);
+    }
+
+    const PacketDescriptor& getPacket(PacketHandle handle) const { return m_packets.get(handle); }
+
+    bool hasPackets(StationId station) const { return m_queueLength[station] != 0; }
+
+    // First station >= `from` with a non-empty queue, or NO_STATION. Lets
+    // schedulers skip idle stations without scanning them.
+    StationId nextBacklogged(StationId from) const;
+    std::uint32_t getQueueLength(StationId station) const { return m_queueLength[station]; }
+    const std::uint32_t* queueLengths() const { return m_queueLength.data(); }
+    size_t getQueuedPackets() const { return m_queuedPackets; }
+    std::uint64_t getDroppedPackets(StationId station) const { return m_droppedPackets[station]; }
+    std::uint64_t getTotalDroppedPackets() const { return m_totalDropped; }
+
+    // Link state (1.0 = the AP's full PHY rate, the default)
+    float getLinkEfficiency(StationId station) const { return m_linkEfficiency[station]; }
+    void setLinkEfficiency(StationId station, float efficiency) { m_linkEfficiency[station] = efficiency; }
+    const Position& getPosition(StationId station) const { return m_position[station]; }
+    void setPosition(StationId station, const Position& position) { m_position[station] = position; }
+
+    // Per-packet event trace (nullptr = off). Queues record enqueues, drops
+    // and deliveries (as ACK) themselves; MACs add transmissions and
+    // collisions through trace(). The writer must outlive its use.
+    void setTraceWriter(TraceWriter* trace) { m_trace = trace; }
+    TraceWriter* getTraceWriter() const { return m_trace; }
+    void trace(TraceEventType type, StationId station, SimTime time, std::uint32_t sizeBytes) {
+        if (m_trace) m_trace->record(type, station, time, sizeBytes);
+    }
+
+    // Statistics. A delivery's latency is measured from the packet's enqueueTime.
+    void recordDelivery(StationId station, const PacketDescriptor& packet, SimTime time);
+    std::uint64_t getDeliveredPackets(StationId station) const { return m_deliveredPackets[station]; }
+    std::uint64_t getDeliveredBytes(StationId station) const { return m_deliveredBytes[station]; }
+    SimTime getLastDelivery(StationId station) const { return m_lastDelivery[station]; }
+
+    // Exact per-station latency summary
+    SimTime getLatencySum(StationId station) const { return SimTime(m_latencySum[station]); }
+    SimTime getMaxLatency(StationId station) const { return m_latencyMax[station]; }
+
+    // Latency distribution of all stations in the table (i.e. of the AP serving them)
+    const LatencyHistogram& getLatencyHistogram() const { return m_latency; }
+
+    // Per-station histograms cost up to a few KB each, so they are opt-in.
+    // Enabling them starts recording from the next delivery.
+    void enableStationHistograms(bool enabled);
+    bool hasStationHistograms() const { return !m_stationLatency.empty(); }
+    const LatencyHistogram& getStationHistogram(StationId station) const { return m_stationLatency[station]; }
+
+    // Every column, the packet pool and the statistics; not the trace writer
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+};
+
+#endif // STATION_TABLE_H
@@ -0,0 +1,127 @@
+#include "statistics.h"
+#include "WiFiSimulation.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// RunningStatistics Implementation
+RunningStatistics::RunningStatistics()
+    : m_count(0), m_mean(0.0), m_m2(0.0),
+      m_min(std::numeric_limits<double>::infinity()),
+      m_max(-std::numeric_limits<double>::infinity()) {}
+
+void RunningStatistics::add(double value) {
+    ++m_count;
+    double delta = value - m_mean;
+    m_mean += delta / m_count;
+    m_m2 += delta * (value - m_mean);
+    m_min = std::min(m_min, value);
+    m_max = std::max(m_max, value);
+}
+
+void RunningStatistics::merge(const RunningStatistics& other) {
+    if (other.m_count == 0) return;
+    if (m_count == 0) {
+        *this = other;
+        return;
+    }
+
+    // Chan et al. parallel combination of two partial results
+    size_t total = m_count + other.m_count;
+    double delta = other.m_mean - m_mean;
+    m_mean += delta * other.m_count / total;
+    m_m2 += other.m_m2 + delta * delta * (static_cast<double>(m_count) * other.m_count / total);
+    m_count = total;
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+}
+
+double RunningStatistics::variance() const {
+    return m_count > 1 ? m_m2 / (m_count - 1) : 0.0;
+}
+
+double RunningStatistics::stddev() const {
+    return std::sqrt(variance());
+}
+
+double ConfidenceInterval::relativeHalfWidth() const {
+    return mean != 0.0 ? halfWidth / std::fabs(mean) : 0.0;
+}
+
+double inverseNormalCdf(double probability) {
+    if (probability <= 0.0 || probability >= 1.0) {
+        throw WiFiSimulationException("Probability must be in (0, 1)");
+    }
+
+    static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02,
+                               -2.759285104469687e+02, 1.383577518672690e+02,
+                               -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02,
+                               -1.556989798598866e+02, 6.680131188771972e+01,
+                               -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01,
+                               -2.400758277161838e+00, -2.549732539343734e+00,
+                               4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01,
+                               2.445134137142996e+00, 3.754408661907416e+00};
+    const double low = 0.02425;
+
+    if (probability < low) {
+        double q = std::sqrt(-2.0 * std::log(probability));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    if (probability > 1.0 - low) {
+        return -inverseNormalCdf(1.0 - probability);
+    }
+
+    double q = probability - 0.5;
+    double r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
+
+double studentTQuantile(double probability, size_t degreesOfFreedom) {
+    if (degreesOfFreedom == 0) {
+        throw WiFiSimulationException("Student t needs at least one degree of freedom");
+    }
+
+    // Closed forms for the two smallest cases, where the expansion is poor
+    if (degreesOfFreedom == 1) {
+        return std::tan(M_PI * (probability - 0.5));
+    }
+    if (degreesOfFreedom == 2) {
+        return (2.0 * probability - 1.0) / std::sqrt(2.0 * probability * (1.0 - probability));
+    }
+
+    // Cornish-Fisher expansion around the normal quantile (A&S 26.7.5)
+    double z = inverseNormalCdf(probability);
+    double n = static_cast<double>(degreesOfFreedom);
+    double z2 = z * z;
+    double g1 = (z2 + 1.0) * z / 4.0;
+    double g2 = ((5.0 * z2 + 16.0) * z2 + 3.0) * z / 96.0;
+    double g3 = (((3.0 * z2 + 19.0) * z2 + 17.0) * z2 - 15.0) * z / 384.0;
+    double g4 = ((((79.0 * z2 + 776.0) * z2 + 1482.0) * z2 - 1920.0) * z2 - 945.0) * z / 92160.0;
+    return z + g1 / n + g2 / (n * n) + g3 / (n * n * n) + g4 / (n * n * n * n);
+}
+
+ConfidenceInterval computeConfidenceInterval(const RunningStatistics& statistics, double confidence) {
+    ConfidenceInterval interval;
+    interval.mean = statistics.count() > 0 ? statistics.mean() : 0.0;
+    interval.stddev = statistics.stddev();
+    interval.samples = statistics.count();
+
+    if (statistics.count() > 1) {
+        double t = studentTQuantile(0.5 + confidence / 2.0, statistics.count() - 1);
+        interval.halfWidth = t * interval.stddev / std::sqrt(static_cast<double>(statistics.count()));
+    }
+    return interval;
+}
+
+ConfidenceInterval computeConfidenceInterval(const std::vector<double>& samples, double confidence) {
+    RunningStatistics statistics;
+    for (double sample : samples) {
+        statistics.add(sample);
+    }
+    return computeConfidenceInterval(statistics, confidence);
+}
@@ -0,0 +1,56 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <cstddef>
+#include <vector>
+
+// Streaming mean/variance (Welford); mergeable across threads and replications
+class RunningStatistics {
+private:
+    size_t m_count;
+    double m_mean;
+    double m_m2;  // Sum of squared deviations from the mean
+    double m_min;
+    double m_max;
+
+public:
+    RunningStatistics();
+
+    void add(double value);
+    void merge(const RunningStatistics& other);
+
+    size_t count() const { return m_count; }
+    double mean() const { return m_mean; }
+    double variance() const;  // Sample variance (n - 1)
+    double stddev() const;
+    double min() const { return m_min; }
+    double max() const { return m_max; }
+};
+
+// Two-sided confidence interval around a sample mean
+struct ConfidenceInterval {
+    double mean = 0.0;
+    double stddev = 0.0;
+    double halfWidth = 0.0;
+    size_t samples = 0;
+
+    double lower() const { return mean - halfWidth; }
+    double upper() const { return mean + halfWidth; }
+
+    // Half-width relative to the mean (0 when the mean is 0)
+    double relativeHalfWidth() const;
+};
+
+// Quantile of the standard normal distribution (Acklam's approximation)
+double inverseNormalCdf(double probability);
+
+// Quantile of Student's t distribution with the given degrees of freedom
+double studentTQuantile(double probability, size_t degreesOfFreedom);
+
+// Student-t confidence interval for the mean of independent samples
+ConfidenceInterval computeConfidenceInterval(const RunningStatistics& statistics,
+                                             double confidence = 0.95);
+ConfidenceInterval computeConfidenceInterval(const std::vector<double>& samples,
+                                             double confidence = 0.95);
+
+#endif // STATISTICS_H
@@ -0,0 +1,139 @@
+#include "sweep_engine.h"
+#include <algorithm>
+#include <mutex>
+
+SweepEngine::SweepEngine(std::uint64_t masterSeed, size_t threadCount)
+    : m_masterSeed(masterSeed),
+      m_pool(threadCount) {}
+
+std::vector<SweepPoint> SweepEngine::expand(const SweepSpace& space) {
+    std::vector<SweepPoint> points;
+    points.reserve(space.standards.size() * space.userCounts.size() *
+                   space.modulationOrders.size() * space.codingRates.size() *
+                   space.channelWidths.size() * space.offeredLoadsMbps.size());
+
+    for (WiFiStandard standard : space.standards) {
+        for (size_t users : space.userCounts) {
+            for (int modulation : space.modulationOrders) {
+                for (double codingRate : space.codingRates) {
+                    for (double width : space.channelWidths) {
+                        for (double load : space.offeredLoadsMbps) {
+                            SweepPoint point;
+                            point.index = points.size();
+                            point.standard = standard;
+                            point.userCount = users;
+                            point.phy.modulationOrder = modulation;
+                            point.phy.codingRate = codingRate;
+                            point.phy.channelWidth = width;
+                            point.offeredLoadMbps = load;
+
+                            // Loaded runs end when the traffic does
+                            point.iterations = space.iterations > 0 ? space.iterations
+                                             : load > 0.0          ? 0
+                                             : getDefaultIterations(standard);
+                            points.push_back(point);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return points;
+}
+
+TrafficConfig getSweepTraffic(const SweepPoint& point) {
+    TrafficConfig traffic;
+    if (point.offeredLoadMbps > 0.0) {
+        traffic.model = TrafficModel::POISSON;
+        traffic.packetsPerSecond = packetRateForLoad(point.offeredLoadMbps, point.userCount,
+                                                     traffic.packetSize);
+    }
+    return traffic;
+}
+
+double SweepEngine::estimateCost(const SweepPoint& point) {
+    // Under load the work is the number of arrivals (1 KB packets over 1 s)
+    if (point.offeredLoadMbps > 0.0) {
+        return point.offeredLoadMbps * 1e6 / 8192.0 + static_cast<double>(point.userCount);
+    }
+
+    // Every round touches every user; MU-MIMO rounds also sound each user
+    double perRound = static_cast<double>(point.userCount);
+    if (point.standard == WiFiStandard::WIFI5) perRound *= 2.0;
+    return perRound * point.iterations;
+}
+
+AnalyticEstimate SweepEngine::estimate(const SweepPoint& point) {
+    return estimatePerformance(point.standard, point.userCount, point.phy, getSweepTraffic(point),
+                               point.iterations);
+}
+
+SweepResult SweepEngine::runPoint(const SweepPoint& point) const {
+    auto start = std::chrono::steady_clock::now();
+
+    auto simulation = createSimulation(point.standard, point.userCount,
+                                       deriveStreamSeed(m_masterSeed, point.index), point.phy,
+                                       getSweepTraffic(point));
+    simulation->setMaxIterations(point.iterations);
+    simulation->runSimulation();
+
+    SweepResult result;
+    result.point = point;
+    result.metrics = simulation->collectMetrics();
+    result.wallTimeMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    result.estimate = estimate(point);
+    return result;
+}
+
+size_t SweepEngine::run(const SweepSpace& space, const std::function<void(const SweepResult&)>& onResult,
+                        const SweepFilter& keep) {
+    std::vector<SweepPoint> points = expand(space);
+    if (keep) {
+        points.erase(std::remove_if(points.begin(), points.end(), [&keep](const SweepPoint& point) {
+            return !keep(point, estimate(point));
+        }), points.end());
+    }
+
+    // Largest first, so the long configurations do not straggle at the end
+    std::stable_sort(points.begin(), points.end(), [](const SweepPoint& a, const SweepPoint& b) {
+        return estimateCost(a) > estimateCost(b);
+    });
+
+    std::mutex outputMutex;
+    std::vector<std::future<void>> pending;
+    pending.reserve(points.size());
+    for (const SweepPoint& point : points) {
+        pending.push_back(m_pool.submit([this, point, &onResult, &outputMutex]() {
+            SweepResult result = runPoint(point);
+            std::lock_guard<std::mutex> lock(outputMutex);
+            onResult(result);
+        }));
+    }
+
+    // Rethrows the first failure, after every point has finished
+    m_pool.waitIdle();
+    for (auto& future : pending) {
+        future.get();
+    }
+    return points.size();
+}
+
+void writeSweepCsvHeader(std::ostream& out) {
+    out << "index,standard,users,modulation,coding_rate,channel_width_mhz,offered_load_mbps,iterations,"
+           "delivered_packets,throughput_mbps,avg_latency_us,max_latency_us,"
+           "p50_latency_us,p99_latency_us,wall_time_ms,estimated_throughput_mbps,estimated_avg_latency_us\n";
+}
+
+void writeSweepCsvRow(std::ostream& out, const SweepResult& result) {
+    const SweepPoint& point = result.point;
+    out << point.index << ',' << toString(point.standard) << ',' << point.userCount << ','
+        << point.phy.modulationOrder << ',' << point.phy.codingRate << ','
+        << point.phy.channelWidth << ',' << point.offeredLoadMbps << ',' << point.iterations << ','
+        << result.metrics.deliveredPackets << ',' << result.metrics.throughputMbps << ','
+        << result.metrics.avgLatencyUs << ',' << result.metrics.maxLatencyUs << ','
+        << result.metrics.latency.percentileMicroseconds(50.0) << ','
+        << result.metrics.latency.percentileMicroseconds(99.0) << ','
+        << result.wallTimeMs << ',' << result.estimate.throughputMbps << ','
+        << result.estimate.avgLatencyUs << '\n';
+}
@@ -0,0 +1,81 @@
+#ifndef SWEEP_ENGINE_H
+#define SWEEP_ENGINE_H
+
+#include "simulation_factory.h"
+#include "analytic_model.h"
+#include "thread_pool.h"
+#include <functional>
+#include <ostream>
+
+// Axes of a parameter sweep; every combination becomes one sweep point
+struct SweepSpace {
+    std::vector<WiFiStandard> standards = {WiFiStandard::WIFI4, WiFiStandard::WIFI5, WiFiStandard::WIFI6};
+    std::vector<size_t> userCounts = {1, 10, 100};
+    std::vector<int> modulationOrders = {256};
+    std::vector<double> codingRates = {5.0 / 6.0};
+    std::vector<double> channelWidths = {20.0};  // in MHz
+    std::vector<double> offeredLoadsMbps = {0.0};  // Poisson load per cell; 0 = backlogged stations
+    int iterations = 0;  // 0 keeps each standard's default MAX_ITERATIONS (unlimited under load)
+};
+
+// One configuration of the cross product
+struct SweepPoint {
+    size_t index = 0;  // Position in the cross product; also selects the RNG substream
+    WiFiStandard standard = WiFiStandard::WIFI4;
+    size_t userCount = 1;
+    PhyConfig phy;
+    double offeredLoadMbps = 0.0;
+    int iterations = 0;
+};
+
+// Traffic a sweep point offers: the original backlog, or Poisson arrivals
+// adding up to the point's offered load for one simulated second
+TrafficConfig getSweepTraffic(const SweepPoint& point);
+
+struct SweepResult {
+    SweepPoint point;
+    SimulationMetrics metrics;
+    AnalyticEstimate estimate;  // What the analytic model predicted for the point
+    double wallTimeMs = 0.0;    // Host time spent simulating this point
+};
+
+// Decides from a point's analytic estimate whether it is worth simulating
+using SweepFilter = std::function<bool(const SweepPoint&, const AnalyticEstimate&)>;
+
+// Runs every point of a sweep space on a work-stealing pool and streams each
+// point's result to a callback as soon as it completes
+class SweepEngine {
+private:
+    std::uint64_t m_masterSeed;
+    ThreadPool m_pool;
+
+public:
+    // threadCount == 0 uses every hardware thread
+    explicit SweepEngine(std::uint64_t masterSeed = DEFAULT_SIMULATION_SEED, size_t threadCount = 0);
+
+    // Expand the cross product standard x users x modulation x coding x width x load
+    static std::vector<SweepPoint> expand(const SweepSpace& space);
+
+    // Relative cost of a point, used to start the largest configurations first
+    static double estimateCost(const SweepPoint& point);
+
+    // Analytic estimate of a point (analytic_model.h); microseconds instead of a simulation
+    static AnalyticEstimate estimate(const SweepPoint& point);
+
+    // Simulate a single point on the calling thread
+    SweepResult runPoint(const SweepPoint& point) const;
+
+    // Run the whole sweep; `onResult` is called once per point, in completion
+    // order, never concurrently with itself. Points `keep` rejects on their
+    // estimate are not simulated. Returns the number of points run.
+    size_t run(const SweepSpace& space, const std::function<void(const SweepResult&)>& onResult,
+               const SweepFilter& keep = SweepFilter());
+
+    size_t getThreadCount() const { return m_pool.getThreadCount(); }
+};
+
+// CSV output of sweep results
+void writeSweepCsvHeader(std::ostream& out);
+void writeSweepCsvRow(std::ostream& out, const SweepResult& result);
+
+#endif // SWEEP_ENGINE_H
@@ -0,0 +1,51 @@
+#include "sweep_engine.h"
+#include "command_line.h"
+
+int main(int argc, char* argv[]) {
+    try {
+        const char* usage = "Usage: sweep [max users] [master seed] [offered load (Mbps) ...]\n";
+        size_t maxUsers = 1000;
+        std::uint64_t masterSeed = DEFAULT_SIMULATION_SEED;
+        if ((argc > 1 && !parseCount(argv[1], maxUsers)) || (argc > 2 && !parseUnsigned(argv[2], masterSeed))) {
+            std::cerr << usage;
+            return 1;
+        }
+
+        SweepSpace space;
+        space.userCounts.clear();
+        for (size_t users : {1, 10, 100, 1000, 10000, 100000}) {
+            if (users <= maxUsers) space.userCounts.push_back(users);
+        }
+        space.modulationOrders = {16, 64, 256};
+        space.codingRates = {1.0 / 2.0, 3.0 / 4.0, 5.0 / 6.0};
+        space.channelWidths = {20.0, 40.0, 80.0};
+        if (argc > 3) {
+            space.offeredLoadsMbps.clear();
+            for (int arg = 3; arg < argc; ++arg) {
+                double load = 0.0;
+                if (!parseNumber(argv[arg], load) || load < 0.0) {
+                    std::cerr << usage;
+                    return 1;
+                }
+                space.offeredLoadsMbps.push_back(load);
+            }
+        }
+
+        SweepEngine engine(masterSeed);
+        writeSweepCsvHeader(std::cout);
+        size_t points = engine.run(space, [](const SweepResult& result) {
+            writeSweepCsvRow(std::cout, result);
+            std::cout.flush();
+        });
+        std::cerr << points << " points on " << engine.getThreadCount() << " threads\n";
+        return 0;
+    }
+    catch (const WiFiSimulationException& e) {
+        std::cerr << "Simulation Error: " << e.what() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Unexpected Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
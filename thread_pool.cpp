@@ -0,0 +1,112 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+namespace {
+// Index of the pool worker running on this thread, or SIZE_MAX elsewhere
+thread_local size_t t_workerIndex = SIZE_MAX;
+thread_local const void* t_workerPool = nullptr;
+}
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : m_nextQueue(0), m_stolenTasks(0), m_queuedTasks(0), m_pendingTasks(0), m_stopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_taskAvailable.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    // Tasks spawned by a worker stay local; others are dealt out round-robin
+    size_t target = t_workerPool == this
+        ? t_workerIndex
+        : m_nextQueue.fetch_add(1) % m_queues.size();
+    {
+        std::lock_guard<std::mutex> lock(m_queues[target]->mutex);
+        m_queues[target]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_queuedTasks;
+        ++m_pendingTasks;
+    }
+    m_taskAvailable.notify_one();
+}
+
+bool ThreadPool::popTask(size_t index, std::function<void()>& task) {
+    // Own deque first, oldest task first
+    {
+        WorkerQueue& own = *m_queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.front());
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    // Steal from the back of the other deques, away from their owners
+    for (size_t offset = 1; offset < m_queues.size(); ++offset) {
+        WorkerQueue& victim = *m_queues[(index + offset) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+            ++m_stolenTasks;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() { return m_pendingTasks == 0; });
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    t_workerIndex = index;
+    t_workerPool = this;
+
+    while (true) {
+        {
+            // Claim one queued task, or exit once stopping with nothing left
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taskAvailable.wait(lock, [this]() { return m_stopping || m_queuedTasks > 0; });
+            if (m_queuedTasks == 0) return;
+            --m_queuedTasks;
+        }
+
+        // The claim guarantees a task exists in some deque; only workers
+        // holding claims remove tasks, so this terminates quickly
+        std::function<void()> task;
+        while (!popTask(index, task)) {
+            std::this_thread::yield();
+        }
+
+        // Exceptions are captured by the packaged_task behind submit()
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_pendingTasks == 0) {
+                m_idle.notify_all();
+            }
+        }
+    }
+}
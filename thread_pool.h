@@ -0,0 +1,68 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool of worker threads. Every worker owns a task deque and
+// runs it front to back, so tasks submitted in priority order start in that
+// order. A worker whose deque is empty steals from the back of another's.
+class ThreadPool {
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+    std::atomic<size_t> m_nextQueue;    // Round-robin target for external submits
+    std::atomic<size_t> m_stolenTasks;
+
+    // Guards sleeping/waking and the pending task count
+    std::mutex m_mutex;
+    std::condition_variable m_taskAvailable;
+    std::condition_variable m_idle;
+    size_t m_queuedTasks;   // Sitting in a deque and not yet claimed by a worker
+    size_t m_pendingTasks;  // Queued or running
+    bool m_stopping;
+
+    void workerLoop(size_t index);
+    bool popTask(size_t index, std::function<void()>& task);
+    void enqueue(std::function<void()> task);
+
+public:
+    // threadCount == 0 uses one worker per hardware thread
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue a task; the future yields its result (or rethrows its exception)
+    template <typename F>
+    auto submit(F task) -> std::future<decltype(task())> {
+        using Result = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+        std::future<Result> result = packaged->get_future();
+        enqueue([packaged]() { (*packaged)(); });
+        return result;
+    }
+
+    // Block until every queued task has finished
+    void waitIdle();
+
+    size_t getThreadCount() const { return m_workers.size(); }
+
+    // Number of tasks a worker took from another worker's deque
+    size_t getStolenTaskCount() const { return m_stolenTasks.load(); }
+};
+
+#endif // THREAD_POOL_H
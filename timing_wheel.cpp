@@ -0,0 +1,165 @@
+#include "timing_wheel.h"
+#include "WiFiSimulation.h"
+#include "snapshot.h"
+
+static unsigned lowestSetBit(std::uint64_t mask) {
+    return static_cast<unsigned>(__builtin_ctzll(mask));
+}
+
+TimingWheel::TimingWheel(size_t timers)
+    : m_now(0),
+      m_armed(0) {
+    for (TimerId& head : m_heads) head = NO_TIMER;
+    for (std::uint64_t& mask : m_occupied) mask = 0;
+    resize(timers);
+}
+
+void TimingWheel::resize(size_t timers) {
+    if (timers > NO_TIMER) {
+        throw WiFiSimulationException("Too many timers");
+    }
+    for (size_t timer = timers; timer < m_bucket.size(); ++timer) {
+        cancel(static_cast<TimerId>(timer));
+    }
+    m_expiry.resize(timers, 0);
+    m_next.resize(timers, NO_TIMER);
+    m_prev.resize(timers, NO_TIMER);
+    m_bucket.resize(timers, NOT_ARMED);
+}
+
+void TimingWheel::link(TimerId timer) {
+    // Level of the highest 6-bit group where the expiry differs from now
+    std::uint64_t expiry = m_expiry[timer];
+    std::uint64_t differing = expiry ^ m_now;
+    unsigned level = differing ? (63u - static_cast<unsigned>(__builtin_clzll(differing))) / LEVEL_BITS : 0;
+    unsigned slot = static_cast<unsigned>(expiry >> (level * LEVEL_BITS)) & (SLOTS - 1);
+    std::uint16_t bucket = static_cast<std::uint16_t>(level * SLOTS + slot);
+
+    TimerId head = m_heads[bucket];
+    m_next[timer] = head;
+    m_prev[timer] = NO_TIMER;
+    if (head != NO_TIMER) m_prev[head] = timer;
+    m_heads[bucket] = timer;
+    m_bucket[timer] = bucket;
+    m_occupied[level] |= std::uint64_t(1) << slot;
+}
+
+void TimingWheel::unlink(TimerId timer) {
+    std::uint16_t bucket = m_bucket[timer];
+    TimerId next = m_next[timer];
+    TimerId prev = m_prev[timer];
+    if (prev != NO_TIMER) {
+        m_next[prev] = next;
+    } else {
+        m_heads[bucket] = next;
+        if (next == NO_TIMER) {
+            m_occupied[bucket / SLOTS] &= ~(std::uint64_t(1) << (bucket % SLOTS));
+        }
+    }
+    if (next != NO_TIMER) m_prev[next] = prev;
+    m_bucket[timer] = NOT_ARMED;
+}
+
+void TimingWheel::arm(TimerId timer, std::uint64_t expiry) {
+    if (timer >= m_bucket.size()) {
+        throw WiFiSimulationException("Unknown timer");
+    }
+    if (expiry < m_now) {
+        throw WiFiSimulationException("Cannot arm a timer in the past");
+    }
+    if (isArmed(timer)) {
+        unlink(timer);
+    } else {
+        ++m_armed;
+    }
+    m_expiry[timer] = expiry;
+    link(timer);
+}
+
+bool TimingWheel::cancel(TimerId timer) {
+    if (timer >= m_bucket.size() || !isArmed(timer)) return false;
+    unlink(timer);
+    --m_armed;
+    return true;
+}
+
+bool TimingWheel::cascadeToNext() {
+    // Move the clock to the start of the earliest occupied bucket above
+    // level 0 and redistribute its timers over the lower levels
+    for (unsigned level = 1; level < LEVELS; ++level) {
+        if (m_occupied[level] == 0) continue;
+
+        unsigned slot = lowestSetBit(m_occupied[level]);
+        unsigned shift = level * LEVEL_BITS;
+        std::uint64_t keptMask = shift + LEVEL_BITS >= 64 ? 0 : ~std::uint64_t(0) << (shift + LEVEL_BITS);
+        m_now = (m_now & keptMask) | (std::uint64_t(slot) << shift);
+
+        std::uint16_t bucket = static_cast<std::uint16_t>(level * SLOTS + slot);
+        TimerId timer = m_heads[bucket];
+        m_heads[bucket] = NO_TIMER;
+        m_occupied[level] &= ~(std::uint64_t(1) << slot);
+        while (timer != NO_TIMER) {
+            TimerId next = m_next[timer];
+            link(timer);
+            timer = next;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool TimingWheel::expireNext(std::vector<TimerId>& fired) {
+    if (m_armed == 0) return false;
+
+    while (m_occupied[0] == 0) {
+        cascadeToNext();
+    }
+
+    unsigned slot = lowestSetBit(m_occupied[0]);
+    m_now = (m_now & ~std::uint64_t(SLOTS - 1)) | slot;
+
+    TimerId timer = m_heads[slot];
+    m_heads[slot] = NO_TIMER;
+    m_occupied[0] &= ~(std::uint64_t(1) << slot);
+    while (timer != NO_TIMER) {
+        fired.push_back(timer);
+        m_bucket[timer] = NOT_ARMED;
+        --m_armed;
+        timer = m_next[timer];
+    }
+    return true;
+}
+
+void TimingWheel::reset() {
+    for (TimerId& head : m_heads) head = NO_TIMER;
+    for (std::uint64_t& mask : m_occupied) mask = 0;
+    for (std::uint16_t& bucket : m_bucket) bucket = NOT_ARMED;
+    m_now = 0;
+    m_armed = 0;
+}
+
+void TimingWheel::saveState(SnapshotWriter& out) const {
+    out.putVector(m_expiry);
+    out.putVector(m_next);
+    out.putVector(m_prev);
+    out.putVector(m_bucket);
+    out.putBytes(m_heads, sizeof(m_heads));
+    out.putBytes(m_occupied, sizeof(m_occupied));
+    out.put(m_now);
+    out.put<std::uint64_t>(m_armed);
+}
+
+void TimingWheel::loadState(SnapshotReader& in) {
+    in.getVector(m_expiry);
+    in.getVector(m_next);
+    in.getVector(m_prev);
+    in.getVector(m_bucket);
+    in.getBytes(m_heads, sizeof(m_heads));
+    in.getBytes(m_occupied, sizeof(m_occupied));
+    in.get(m_now);
+    m_armed = static_cast<size_t>(in.get<std::uint64_t>());
+    const size_t timers = m_expiry.size();
+    if (m_next.size() != timers || m_prev.size() != timers || m_bucket.size() != timers) {
+        throw WiFiSimulationException("Corrupt timing wheel in simulation snapshot");
+    }
+}
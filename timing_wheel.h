@@ -0,0 +1,77 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Timer ids are dense indices chosen by the caller (e.g. a StationId)
+using TimerId = std::uint32_t;
+const TimerId NO_TIMER = UINT32_MAX;
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// Hierarchical timing wheel over integer ticks (e.g. backoff slots).
+// Each level has 64 buckets; level l covers 64^(l+1) ticks, and eleven
+// levels span the whole 64-bit range. A timer lives in the level of the
+// highest 6-bit group in which its expiry differs from the current tick,
+// and is cascaded down as the wheel advances towards it. Buckets are
+// intrusive doubly linked lists over per-timer arrays, so arm and cancel
+// are O(1) and never allocate; a 64-bit occupancy mask per level lets the
+// next expiry be found with a count-trailing-zeros instead of a scan.
+class TimingWheel {
+private:
+    static constexpr unsigned LEVEL_BITS = 6;
+    static constexpr unsigned SLOTS = 1u << LEVEL_BITS;
+    static constexpr unsigned LEVELS = (64 + LEVEL_BITS - 1) / LEVEL_BITS;
+    static constexpr std::uint16_t NOT_ARMED = UINT16_MAX;
+
+    // Per-timer state
+    std::vector<std::uint64_t> m_expiry;
+    std::vector<TimerId> m_next;
+    std::vector<TimerId> m_prev;
+    std::vector<std::uint16_t> m_bucket;  // level * SLOTS + slot, or NOT_ARMED
+
+    TimerId m_heads[LEVELS * SLOTS];
+    std::uint64_t m_occupied[LEVELS];
+    std::uint64_t m_now;
+    size_t m_armed;
+
+    void link(TimerId timer);
+    void unlink(TimerId timer);
+    bool cascadeToNext();
+
+public:
+    explicit TimingWheel(size_t timers = 0);
+
+    // Size the per-timer state; existing timers keep their expiries
+    void resize(size_t timers);
+    size_t size() const { return m_expiry.size(); }
+
+    // Arm (or re-arm) a timer to fire at an absolute tick no earlier than now()
+    void arm(TimerId timer, std::uint64_t expiry);
+
+    // Disarm a timer; returns false if it was not armed
+    bool cancel(TimerId timer);
+
+    bool isArmed(TimerId timer) const { return m_bucket[timer] != NOT_ARMED; }
+    std::uint64_t getExpiry(TimerId timer) const { return m_expiry[timer]; }
+
+    // Advance to the earliest pending expiry and disarm every timer due at
+    // that tick, appending them to `fired` (in no particular order).
+    // Returns false, leaving the clock alone, when nothing is armed.
+    bool expireNext(std::vector<TimerId>& fired);
+
+    // Drop all timers and rewind the clock to zero
+    void reset();
+
+    std::uint64_t now() const { return m_now; }
+    bool empty() const { return m_armed == 0; }
+    size_t armedTimers() const { return m_armed; }
+
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+};
+
+#endif // TIMING_WHEEL_H
@@ -0,0 +1,44 @@
+#include "trace_writer.h"
+#include "WiFiSimulation.h"
+#include <cstdlib>
+
+int main(int argc, char* argv[]) {
+    try {
+        // Usage: tracedump <trace file> [max records to print]
+        if (argc < 2) {
+            std::cerr << "Usage: tracedump <trace file> [max records to print]\n";
+            return 1;
+        }
+        std::uint64_t limit = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : UINT64_MAX;
+
+        TraceReader reader(argv[1]);
+        std::vector<TraceRecord> records;
+        std::uint64_t total = 0;
+        std::uint64_t counts[5] = {};
+        std::cout << "time_ns\tstation\tevent\tbytes\n";
+        while (reader.next(records)) {
+            for (const TraceRecord& record : records) {
+                if (total++ < limit) {
+                    std::cout << record.time.count() << '\t' << record.station << '\t'
+                              << toString(record.type) << '\t' << record.sizeBytes << '\n';
+                }
+                if (static_cast<unsigned>(record.type) < 5) ++counts[static_cast<unsigned>(record.type)];
+            }
+        }
+
+        std::cerr << total << " records:";
+        for (unsigned type = 0; type < 5; ++type) {
+            std::cerr << ' ' << toString(static_cast<TraceEventType>(type)) << '=' << counts[type];
+        }
+        std::cerr << '\n';
+        return 0;
+    }
+    catch (const WiFiSimulationException& e) {
+        std::cerr << "Simulation Error: " << e.what() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Unexpected Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,234 @@
+#include "trace_writer.h"
+#include "WiFiSimulation.h"
+#include <cstring>
+
+const char* toString(TraceEventType type) {
+    switch (type) {
+    case TraceEventType::ENQUEUE:   return "enqueue";
+    case TraceEventType::TX_START:  return "tx_start";
+    case TraceEventType::COLLISION: return "collision";
+    case TraceEventType::ACK:       return "ack";
+    case TraceEventType::DROP:      return "drop";
+    }
+    return "unknown";
+}
+
+namespace {
+
+const char TRACE_MAGIC[4] = {'W', 'T', 'R', 'C'};
+const size_t COLUMNS = 4;
+
+// Worst-case LEB128 length of a 64-bit value
+const size_t MAX_VARINT_BYTES = 10;
+
+void putU32(std::uint8_t* out, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) out[i] = static_cast<std::uint8_t>(value >> (8 * i));
+}
+
+std::uint32_t getU32(const std::uint8_t* in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<std::uint32_t>(in[3]) << 24);
+}
+
+// Zigzag maps small negative deltas to small unsigned values; returns the
+// end of the encoding
+std::uint8_t* putDelta(std::uint8_t* out, std::int64_t delta) {
+    std::uint64_t value = (static_cast<std::uint64_t>(delta) << 1) ^ static_cast<std::uint64_t>(delta >> 63);
+    while (value >= 0x80) {
+        *out++ = static_cast<std::uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<std::uint8_t>(value);
+    return out;
+}
+
+// Delta-encode one column from `out`; returns the encoded length
+template <typename T>
+std::uint32_t putColumn(std::uint8_t* out, const T* values, size_t count) {
+    std::uint8_t* cursor = out;
+    std::int64_t previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const std::int64_t value = static_cast<std::int64_t>(values[i]);
+        cursor = putDelta(cursor, value - previous);
+        previous = value;
+    }
+    return static_cast<std::uint32_t>(cursor - out);
+}
+
+std::int64_t getDelta(const std::uint8_t*& in, const std::uint8_t* end) {
+    std::uint64_t value = 0;
+    for (unsigned shift = 0; in < end && shift < 64; shift += 7) {
+        std::uint8_t byte = *in++;
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+    throw WiFiSimulationException("Corrupt trace chunk");
+}
+
+} // namespace
+
+TraceWriter::TraceWriter(const std::string& path, size_t chunkRecords)
+    : m_out(path, std::ios::binary | std::ios::trunc),
+      m_chunkRecords(chunkRecords),
+      m_active(&m_buffers[0]),
+      m_pending(nullptr),
+      m_stopping(false),
+      m_failed(false),
+      m_closed(false),
+      m_records(0),
+      m_bytesWritten(0) {
+    if (!m_out || chunkRecords == 0 || chunkRecords > UINT32_MAX) {
+        throw WiFiSimulationException("Cannot open trace file " + path);
+    }
+    // One allocation per chunk, widest column first so each stays aligned
+    const size_t bytesPerRecord = sizeof(std::int64_t) + 2 * sizeof(std::uint32_t) + 1;
+    for (Chunk& chunk : m_buffers) {
+        chunk.storage.resize(chunkRecords * bytesPerRecord);
+        std::uint8_t* base = chunk.storage.data();
+        chunk.time = reinterpret_cast<std::int64_t*>(base);
+        chunk.station = reinterpret_cast<std::uint32_t*>(base + chunkRecords * sizeof(std::int64_t));
+        chunk.size = chunk.station + chunkRecords;
+        chunk.type = reinterpret_cast<std::uint8_t*>(chunk.size + chunkRecords);
+    }
+    m_encoded.resize(4 * (1 + COLUMNS) + chunkRecords * (3 * MAX_VARINT_BYTES + 1));
+
+    std::uint8_t header[8];
+    std::memcpy(header, TRACE_MAGIC, 4);
+    putU32(header + 4, VERSION);
+    m_out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    m_bytesWritten = sizeof(header);
+
+    m_thread = std::thread(&TraceWriter::writerLoop, this);
+}
+
+TraceWriter::~TraceWriter() {
+    try {
+        close();
+    } catch (...) {
+        // Destructors must not throw; call close() to see write errors
+    }
+}
+
+void TraceWriter::submit() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_written.wait(lock, [this] { return m_pending == nullptr; });
+    m_pending = m_active;
+    m_active = (m_active == &m_buffers[0]) ? &m_buffers[1] : &m_buffers[0];
+    m_active->count = 0;
+    m_wake.notify_one();
+}
+
+void TraceWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this] { return m_pending != nullptr || m_stopping; });
+        if (m_pending == nullptr) return;  // Stopping with nothing left
+
+        // Encode and write without holding the lock; the simulation keeps
+        // filling the other buffer meanwhile
+        Chunk* chunk = m_pending;
+        lock.unlock();
+        const size_t bytes = encode(*chunk);
+        m_out.write(reinterpret_cast<const char*>(m_encoded.data()), bytes);
+        lock.lock();
+
+        m_bytesWritten += bytes;
+        if (!m_out) m_failed = true;
+        m_pending = nullptr;
+        m_written.notify_one();
+    }
+}
+
+size_t TraceWriter::encode(const Chunk& chunk) {
+    std::uint8_t* header = m_encoded.data();
+    std::uint8_t* out = header + 4 * (1 + COLUMNS);
+    putU32(header, static_cast<std::uint32_t>(chunk.count));
+
+    std::uint32_t length = putColumn(out, chunk.time, chunk.count);
+    putU32(header + 4, length);
+    out += length;
+
+    length = putColumn(out, chunk.station, chunk.count);
+    putU32(header + 8, length);
+    out += length;
+
+    std::memcpy(out, chunk.type, chunk.count);
+    putU32(header + 12, static_cast<std::uint32_t>(chunk.count));
+    out += chunk.count;
+
+    length = putColumn(out, chunk.size, chunk.count);
+    putU32(header + 16, length);
+    out += length;
+    return static_cast<size_t>(out - header);
+}
+
+void TraceWriter::recordAfterClose() const {
+    throw WiFiSimulationException("Trace record after the trace was closed");
+}
+
+void TraceWriter::close() {
+    if (m_closed) return;
+    m_closed = true;
+    if (m_active->count > 0) submit();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_wake.notify_one();
+    }
+    m_thread.join();
+    m_out.close();
+    if (m_failed || !m_out) {
+        throw WiFiSimulationException("Failed to write trace file");
+    }
+}
+
+TraceReader::TraceReader(const std::string& path)
+    : m_in(path, std::ios::binary) {
+    char header[8];
+    if (!m_in.read(header, sizeof(header)) || std::memcmp(header, TRACE_MAGIC, 4) != 0) {
+        throw WiFiSimulationException("Not a trace file: " + path);
+    }
+    if (getU32(reinterpret_cast<const std::uint8_t*>(header) + 4) != TraceWriter::VERSION) {
+        throw WiFiSimulationException("Unsupported trace version in " + path);
+    }
+}
+
+bool TraceReader::next(std::vector<TraceRecord>& records) {
+    std::uint8_t header[4 * (1 + COLUMNS)];
+    if (!m_in.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        if (m_in.gcount() == 0) return false;
+        throw WiFiSimulationException("Truncated trace chunk");
+    }
+    const std::uint32_t count = getU32(header);
+    records.assign(count, TraceRecord{});
+
+    for (size_t column = 0; column < COLUMNS; ++column) {
+        m_column.resize(getU32(header + 4 * (1 + column)));
+        if (!m_in.read(reinterpret_cast<char*>(m_column.data()), m_column.size())) {
+            throw WiFiSimulationException("Truncated trace chunk");
+        }
+        const std::uint8_t* in = m_column.data();
+        const std::uint8_t* end = in + m_column.size();
+        std::int64_t value = 0;
+        for (TraceRecord& record : records) {
+            switch (column) {
+            case 0:
+                value += getDelta(in, end);
+                record.time = SimTime(value);
+                break;
+            case 1:
+                value += getDelta(in, end);
+                record.station = static_cast<std::uint32_t>(value);
+                break;
+            case 2:
+                if (in == end) throw WiFiSimulationException("Corrupt trace chunk");
+                record.type = static_cast<TraceEventType>(*in++);
+                break;
+            case 3:
+                value += getDelta(in, end);
+                record.sizeBytes = static_cast<std::uint32_t>(value);
+                break;
+            }
+        }
+    }
+    return true;
+}
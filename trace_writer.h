@@ -0,0 +1,122 @@
+#ifndef TRACE_WRITER_H
+#define TRACE_WRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "event_scheduler.h"
+
+// Per-packet MAC events
+enum class TraceEventType : std::uint8_t {
+    ENQUEUE = 0,    // Packet entered a station queue
+    TX_START = 1,   // Transmission began
+    COLLISION = 2,  // Transmission collided
+    ACK = 3,        // Packet delivered
+    DROP = 4        // Queue overflow or retry limit
+};
+
+const char* toString(TraceEventType type);
+
+struct TraceRecord {
+    SimTime time;
+    std::uint32_t station;
+    TraceEventType type;
+    std::uint32_t sizeBytes;
+};
+
+// Binary event trace. Records are buffered column by column in chunks;
+// a full chunk goes to a background thread, which encodes and writes it
+// while the simulation fills the other buffer. Recording is an append to
+// preallocated arrays and only waits if the writer falls a whole chunk
+// behind.
+//
+// File layout: "WTRC", a u32 version, then chunks. A chunk is a u32 record
+// count, the u32 byte length of each of its four columns, and the columns:
+// time (ns), station and size as zigzag LEB128 deltas from the previous
+// record of the chunk (from 0 for the first), type as one byte per record.
+// Chunks are independent, so a reader can stop or seek at any of them.
+class TraceWriter {
+private:
+    // Column storage of one chunk; the pointers index into `storage`
+    struct Chunk {
+        std::vector<std::uint8_t> storage;
+        std::int64_t* time = nullptr;
+        std::uint32_t* station = nullptr;
+        std::uint32_t* size = nullptr;
+        std::uint8_t* type = nullptr;
+        size_t count = 0;
+    };
+
+    std::ofstream m_out;
+    size_t m_chunkRecords;
+    Chunk m_buffers[2];
+    Chunk* m_active;
+    Chunk* m_pending;  // Handed to the writer thread, or nullptr
+    std::vector<std::uint8_t> m_encoded;  // Writer thread scratch, sized for a worst-case chunk
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_written;
+    bool m_stopping;
+    bool m_failed;
+    bool m_closed;
+
+    std::uint64_t m_records;
+    std::uint64_t m_bytesWritten;
+
+    void submit();
+    [[noreturn]] void recordAfterClose() const;
+    void writerLoop();
+    size_t encode(const Chunk& chunk);  // Into m_encoded; returns its length
+
+public:
+    static constexpr std::uint32_t VERSION = 1;
+    static constexpr size_t DEFAULT_CHUNK_RECORDS = 1 << 12;  // ~70 KB per buffer, stays in L2
+
+    explicit TraceWriter(const std::string& path, size_t chunkRecords = DEFAULT_CHUNK_RECORDS);
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    // Throws once the writer is closed
+    void record(TraceEventType type, std::uint32_t station, SimTime time, std::uint32_t sizeBytes) {
+        if (m_closed) recordAfterClose();
+        Chunk& chunk = *m_active;
+        const size_t index = chunk.count++;
+        chunk.time[index] = time.count();
+        chunk.station[index] = station;
+        chunk.type[index] = static_cast<std::uint8_t>(type);
+        chunk.size[index] = sizeBytes;
+        ++m_records;
+        if (chunk.count == m_chunkRecords) submit();
+    }
+
+    // Write out the partial chunk and stop the writer thread; throws if any
+    // write failed. Called by the destructor if needed (which cannot throw).
+    void close();
+
+    std::uint64_t getRecordCount() const { return m_records; }
+    std::uint64_t getBytesWritten() const { return m_bytesWritten; }  // Exact after close()
+};
+
+// Sequential reader of a TraceWriter file
+class TraceReader {
+private:
+    std::ifstream m_in;
+    std::vector<std::uint8_t> m_column;
+
+public:
+    explicit TraceReader(const std::string& path);
+
+    // Decode the next chunk into `records`; false at the end of the file
+    bool next(std::vector<TraceRecord>& records);
+};
+
+#endif // TRACE_WRITER_H
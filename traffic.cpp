@@ -0,0 +1,285 @@
+#include "traffic.h"
+#include "snapshot.h"
+#include <algorithm>
+#include <cmath>
+
+const char* toString(TrafficModel model) {
+    switch (model) {
+    case TrafficModel::BACKLOG:   return "Backlog";
+    case TrafficModel::SATURATED: return "Saturated";
+    case TrafficModel::POISSON:   return "Poisson";
+    case TrafficModel::CBR:       return "CBR";
+    case TrafficModel::ON_OFF:    return "OnOff";
+    case TrafficModel::REPLAY:    return "Replay";
+    }
+    return "Unknown";
+}
+
+// Replayed records between releases of the pages behind the cursor (4 MB)
+static const std::uint64_t REPLAY_RELEASE_RECORDS = 1 << 18;
+
+// Models whose packets arrive as scheduler events
+static bool isArrivalModel(TrafficModel model) {
+    return model == TrafficModel::POISSON || model == TrafficModel::CBR || model == TrafficModel::ON_OFF ||
+           model == TrafficModel::REPLAY;
+}
+
+double packetRateForLoad(double offeredLoadMbps, size_t stations, std::uint32_t packetSize) {
+    if (stations == 0 || packetSize == 0) return 0.0;
+    return offeredLoadMbps * 1e6 / (packetSize * 8.0) / stations;
+}
+
+TrafficGenerator::TrafficGenerator(const TrafficConfig& config, std::uint64_t seed)
+    : m_uniform(0.0, 1.0),
+      m_endTime(SimTime::zero()),
+      m_offeredPackets(0),
+      m_replayNext(0),
+      m_replayStart(SimTime::zero()),
+      m_replaySkipped(0) {
+    seedGenerator(m_generator, seed);
+    setConfig(config);
+}
+
+void TrafficGenerator::setConfig(const TrafficConfig& config) {
+    if (config.packetSize == 0 ||
+        (isArrivalModel(config.model) && config.model != TrafficModel::REPLAY && !(config.packetsPerSecond > 0.0)) ||
+        (config.model == TrafficModel::ON_OFF &&
+         (!(config.paretoShape > 1.0) || !(config.meanOnMs > 0.0) || !(config.meanOffMs > 0.0)))) {
+        throw WiFiSimulationException("Invalid traffic configuration");
+    }
+    if (config.model == TrafficModel::REPLAY && (!m_replay || config.replayPath != m_replayPath)) {
+        m_replay = std::make_shared<const ReplaySource>(config.replayPath);
+        m_replayPath = config.replayPath;
+    }
+    m_config = config;
+}
+
+bool TrafficGenerator::isEventDriven() const {
+    return isArrivalModel(m_config.model);
+}
+
+SimTime TrafficGenerator::packetGap() const {
+    return std::chrono::duration_cast<SimTime>(
+        std::chrono::duration<double>(1.0 / m_config.packetsPerSecond));
+}
+
+double TrafficGenerator::pareto(double mean) {
+    // Inverse transform with the scale chosen to give the requested mean
+    double shape = m_config.paretoShape;
+    double scale = mean * (shape - 1.0) / shape;
+    return scale / std::pow(1.0 - m_uniform(m_generator), 1.0 / shape);
+}
+
+SimTime TrafficGenerator::advanceOnTime(StationId station, SimTime from, SimTime gap) {
+    // The gap only elapses while the source is on; the remainder carries over
+    // the off periods, so the rate while on is honoured even for slow sources
+    SimTime time = from;
+    while (time + gap >= m_burstEnd[station]) {
+        if (time >= m_endTime) return time;  // Past the end; the caller drops it
+
+        gap -= std::max(m_burstEnd[station] - time, SimTime::zero());
+        time = m_burstEnd[station] + std::chrono::duration_cast<SimTime>(
+            std::chrono::duration<double, std::milli>(pareto(m_config.meanOffMs)));
+        m_burstEnd[station] = time + std::chrono::duration_cast<SimTime>(
+            std::chrono::duration<double, std::milli>(pareto(m_config.meanOnMs)));
+    }
+    return time + gap;
+}
+
+SimTime TrafficGenerator::firstArrival(StationId station, SimTime now) {
+    switch (m_config.model) {
+    case TrafficModel::CBR:
+        // Random phase so stations don't all fire on the same tick
+        return now + std::chrono::duration_cast<SimTime>(packetGap() * m_uniform(m_generator));
+    case TrafficModel::ON_OFF: {
+        // Start somewhere in an off period, then burst with a random phase
+        SimTime start = now + std::chrono::duration_cast<SimTime>(
+            std::chrono::duration<double, std::milli>(m_config.meanOffMs * m_uniform(m_generator)));
+        m_burstEnd[station] = start + std::chrono::duration_cast<SimTime>(
+            std::chrono::duration<double, std::milli>(pareto(m_config.meanOnMs)));
+        return advanceOnTime(station, start,
+                             std::chrono::duration_cast<SimTime>(packetGap() * m_uniform(m_generator)));
+    }
+    default:
+        return nextArrival(station, now);
+    }
+}
+
+SimTime TrafficGenerator::nextArrival(StationId station, SimTime now) {
+    switch (m_config.model) {
+    case TrafficModel::POISSON: {
+        double gap = -std::log(1.0 - m_uniform(m_generator)) / m_config.packetsPerSecond;
+        return now + std::chrono::duration_cast<SimTime>(std::chrono::duration<double>(gap));
+    }
+    case TrafficModel::ON_OFF:
+        return advanceOnTime(station, now, packetGap());
+    default:
+        return now + packetGap();
+    }
+}
+
+void TrafficGenerator::start(StationTable& stations, EventScheduler& scheduler,
+                             std::uint16_t handler, std::uint16_t arrivalType) {
+    const SimTime now = scheduler.now();
+    const StationId stationCount = static_cast<StationId>(stations.size());
+    stations.setSourcePacketSize(m_config.packetSize);
+
+    if (!isEventDriven()) {
+        std::uint32_t backlog = m_config.model == TrafficModel::SATURATED
+            ? StationTable::UNLIMITED_BACKLOG
+            : m_config.backlogPackets;
+        size_t perStation = std::min<size_t>(backlog, stations.getQueueCapacity());
+        stations.reservePackets(stations.size() * perStation);
+        for (StationId station = 0; station < stationCount; ++station) {
+            stations.setSourceBacklog(station, backlog);
+            stations.admitBacklog(station, now);
+        }
+        return;
+    }
+
+    if (m_config.model == TrafficModel::ON_OFF) {
+        m_burstEnd.assign(stationCount, SimTime::zero());
+    }
+    m_endTime = m_config.model == TrafficModel::REPLAY || m_config.duration >= SimTime::max() - now
+        ? SimTime::max()
+        : now + m_config.duration;
+    if (m_config.model == TrafficModel::REPLAY) {
+        m_replayNext = 0;
+        m_replaySkipped = 0;
+        m_replayStart = now;
+        scheduleReplay(stations, scheduler, handler, arrivalType);
+        return;
+    }
+    for (StationId station = 0; station < stationCount; ++station) {
+        SimTime arrival = firstArrival(station, now);
+        if (arrival < m_endTime) {
+            scheduler.schedule(arrival, handler, arrivalType, station);
+        }
+    }
+}
+
+void TrafficGenerator::addStations(StationTable& stations, EventScheduler& scheduler, StationId first,
+                                   std::uint16_t handler, std::uint16_t arrivalType) {
+    const SimTime now = scheduler.now();
+    const StationId stationCount = static_cast<StationId>(stations.size());
+
+    if (!isEventDriven()) {
+        std::uint32_t backlog = m_config.model == TrafficModel::SATURATED
+            ? StationTable::UNLIMITED_BACKLOG
+            : m_config.backlogPackets;
+        for (StationId station = first; station < stationCount; ++station) {
+            stations.setSourceBacklog(station, backlog);
+            stations.admitBacklog(station, now);
+        }
+        return;
+    }
+
+    // Replay records of the new stations are picked up as the cursor reaches them
+    if (m_config.model == TrafficModel::REPLAY) return;
+    if (m_config.model == TrafficModel::ON_OFF) {
+        m_burstEnd.resize(stationCount, SimTime::zero());
+    }
+    for (StationId station = first; station < stationCount; ++station) {
+        SimTime arrival = firstArrival(station, now);
+        if (arrival < m_endTime) {
+            scheduler.schedule(arrival, handler, arrivalType, station);
+        }
+    }
+}
+
+void TrafficGenerator::scheduleReplay(const StationTable& stations, EventScheduler& scheduler,
+                                      std::uint16_t handler, std::uint16_t arrivalType) {
+    const ReplaySource& replay = *m_replay;
+    // Order is checked as the cursor reaches each record, so the file is
+    // still read only once; an earlier record would land in the past
+    while (m_replayNext < replay.size()) {
+        const ReplayRecord& record = replay[m_replayNext];
+        if (m_replayNext > 0 && record.timeNs < replay[m_replayNext - 1].timeNs) {
+            throw WiFiSimulationException("Replay records out of time order in " + m_replayPath +
+                                          " at record " + std::to_string(m_replayNext));
+        }
+        if (record.station < stations.size()) break;
+        ++m_replaySkipped;
+        ++m_replayNext;
+    }
+    if (m_replayNext == replay.size()) return;
+
+    SimTime arrival = m_replayStart + SimTime(replay[m_replayNext].timeNs);
+    if (arrival < m_endTime) {
+        scheduler.schedule(arrival, handler, arrivalType, replay[m_replayNext].station);
+    }
+}
+
+bool TrafficGenerator::handleArrival(StationTable& stations, EventScheduler& scheduler,
+                                     const SimulationEvent& event) {
+    StationId station = static_cast<StationId>(event.target);
+
+    if (m_config.model == TrafficModel::REPLAY) {
+        PacketDescriptor packet;
+        packet.enqueueTime = event.time;
+        packet.sizeBytes = (*m_replay)[m_replayNext++].sizeBytes;
+        if (m_replayNext % REPLAY_RELEASE_RECORDS == 0) m_replay->release(m_replayNext);
+        packet.flowId = station;
+        ++m_offeredPackets;
+        bool queued = stations.enqueue(station, packet);
+        scheduleReplay(stations, scheduler, event.handler, event.type);
+        return queued;
+    }
+
+    PacketDescriptor packet;
+    packet.enqueueTime = event.time;
+    packet.sizeBytes = m_config.packetSize;
+    packet.flowId = station;
+    ++m_offeredPackets;
+    bool queued = stations.enqueue(station, packet);
+
+    // Generation stops at the end of the configured duration
+    SimTime next = nextArrival(station, event.time);
+    if (next < m_endTime) {
+        scheduler.schedule(next, event.handler, event.type, event.target);
+    }
+    return queued;
+}
+
+void TrafficGenerator::saveState(SnapshotWriter& out) const {
+    out.put(m_config.model);
+    out.put(m_config.packetSize);
+    out.put(m_config.backlogPackets);
+    out.put(m_config.packetsPerSecond);
+    out.put(m_config.meanOnMs);
+    out.put(m_config.meanOffMs);
+    out.put(m_config.paretoShape);
+    out.put(m_config.duration);
+    out.putString(m_config.replayPath);
+    out.putGenerator(m_generator);
+    out.putVector(m_burstEnd);
+    out.put(m_endTime);
+    out.put(m_offeredPackets);
+    out.put(m_replayNext);
+    out.put(m_replayStart);
+    out.put(m_replaySkipped);
+}
+
+void TrafficGenerator::loadState(SnapshotReader& in) {
+    TrafficConfig config;
+    in.get(config.model);
+    in.get(config.packetSize);
+    in.get(config.backlogPackets);
+    in.get(config.packetsPerSecond);
+    in.get(config.meanOnMs);
+    in.get(config.meanOffMs);
+    in.get(config.paretoShape);
+    in.get(config.duration);
+    config.replayPath = in.getString();
+    setConfig(config);
+    in.getGenerator(m_generator);
+    in.getVector(m_burstEnd);
+    in.get(m_endTime);
+    in.get(m_offeredPackets);
+    in.get(m_replayNext);
+    in.get(m_replayStart);
+    in.get(m_replaySkipped);
+    if (m_config.model == TrafficModel::REPLAY && m_replayNext > m_replay->size()) {
+        throw WiFiSimulationException("Replay file is shorter than the snapshot's position");
+    }
+}
@@ -0,0 +1,114 @@
+#ifndef TRAFFIC_H
+#define TRAFFIC_H
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "station_table.h"
+#include "random_streams.h"
+#include "packet_replay.h"
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// How stations generate packets
+enum class TrafficModel {
+    BACKLOG,    // backlogPackets per station waiting at time zero (the original workload)
+    SATURATED,  // Endless backlog: every station always has a packet to send
+    POISSON,    // Exponential inter-arrival times
+    CBR,        // Constant bit rate, randomly phased per station
+    ON_OFF,     // CBR bursts with Pareto-distributed on and off periods
+    REPLAY      // Arrivals read from a replay file (see packet_replay.h)
+};
+
+const char* toString(TrafficModel model);
+
+struct TrafficConfig {
+    TrafficModel model = TrafficModel::BACKLOG;
+    std::uint32_t packetSize = 1024;     // bytes
+    std::uint32_t backlogPackets = 10;   // BACKLOG only
+    double packetsPerSecond = 100.0;     // Per station; the rate while on for ON_OFF
+    double meanOnMs = 10.0;              // ON_OFF
+    double meanOffMs = 90.0;             // ON_OFF
+    double paretoShape = 1.5;            // ON_OFF; must be > 1 for a finite mean
+    SimTime duration = std::chrono::seconds(1);  // Arrival models stop generating after this;
+                                                 // REPLAY always runs to the end of the file
+    std::string replayPath;              // REPLAY; packet sizes come from the file
+};
+
+// Per-station packet rate giving a total offered load of `offeredLoadMbps`
+double packetRateForLoad(double offeredLoadMbps, size_t stations, std::uint32_t packetSize = 1024);
+
+// Traffic sources for every station of a table. Backlogged and saturated
+// sources are a per-station counter in the StationTable that refills the
+// queue as it drains, so no packets exist before they fit in the queue.
+// Arrival models keep one pending arrival event per station and draw the
+// next inter-arrival time only when that event fires, so memory holds only
+// in-flight packets whatever the number of users or the run length.
+// Replay works the same way with a single pending event: the next record
+// of the mapped file, whichever station it belongs to.
+class TrafficGenerator {
+private:
+    TrafficConfig m_config;
+    std::mt19937 m_generator;
+    std::uniform_real_distribution<> m_uniform;
+    std::vector<SimTime> m_burstEnd;  // ON_OFF: end of each station's current burst
+    SimTime m_endTime;                // No arrivals at or after this time
+    std::uint64_t m_offeredPackets;
+
+    // REPLAY: the mapped file (shared by copies), the next record and the
+    // time the replay started
+    std::shared_ptr<const ReplaySource> m_replay;
+    std::string m_replayPath;
+    std::uint64_t m_replayNext;
+    SimTime m_replayStart;
+    std::uint64_t m_replaySkipped;
+
+    SimTime packetGap() const;
+    double pareto(double mean);
+    SimTime advanceOnTime(StationId station, SimTime from, SimTime gap);
+    SimTime firstArrival(StationId station, SimTime now);
+    SimTime nextArrival(StationId station, SimTime now);
+    void scheduleReplay(const StationTable& stations, EventScheduler& scheduler,
+                        std::uint16_t handler, std::uint16_t arrivalType);
+
+public:
+    explicit TrafficGenerator(const TrafficConfig& config = TrafficConfig(),
+                              std::uint64_t seed = DEFAULT_SIMULATION_SEED);
+
+    void setConfig(const TrafficConfig& config);
+    const TrafficConfig& getConfig() const { return m_config; }
+
+    // True when packets arrive as scheduler events
+    bool isEventDriven() const;
+
+    // Start every station's source at the scheduler's current time. Arrival
+    // events are scheduled for `handler` with the given event type and the
+    // station as target, and must be passed back to handleArrival().
+    void start(StationTable& stations, EventScheduler& scheduler,
+               std::uint16_t handler, std::uint16_t arrivalType);
+
+    // Start the sources of stations [first, stations.size()) added to a
+    // running simulation; arrivals follow the same rules as in start()
+    void addStations(StationTable& stations, EventScheduler& scheduler, StationId first,
+                     std::uint16_t handler, std::uint16_t arrivalType);
+
+    // Queue the arriving packet and schedule the station's next arrival.
+    // Returns false if the packet was dropped by a full queue.
+    bool handleArrival(StationTable& stations, EventScheduler& scheduler, const SimulationEvent& event);
+
+    // Packets generated by arrival models so far
+    std::uint64_t getOfferedPackets() const { return m_offeredPackets; }
+
+    // REPLAY: records skipped because their station is not in the table
+    std::uint64_t getReplaySkipped() const { return m_replaySkipped; }
+
+    // Configuration, generator state and replay position. Loading a
+    // REPLAY source maps its file again from the saved path.
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+};
+
+#endif // TRAFFIC_H
@@ -1,7 +1,11 @@
-#include "WiFiSimulation.h"
+#include "wifi4_simulation.h"
 
-int main() {
+int main(int argc, char* argv[]) {
     try {
+        // Usage: wifi4_sim [trace file|-] [replay file]; both apply to Test Case 3
+        std::unique_ptr<TraceWriter> trace;
+        if (argc > 1 && std::string(argv[1]) != "-") trace = std::make_unique<TraceWriter>(argv[1]);
+
         // Test Case 1: 1 User, 1 AP
         std::cout << "Simulation with 1 User and 1 AP:\n";
         WiFi4Simulation sim1(1);
@@ -21,8 +25,21 @@ int main() {
         // Test Case 3: 100 Users, 1 AP
         std::cout << "Simulation with 100 Users and 1 AP:\n";
         WiFi4Simulation sim3(100);
+        sim3.getStations().setTraceWriter(trace.get());
+        if (argc > 2) {
+            // Arrivals from a converted capture instead of the default backlog
+            TrafficConfig replay;
+            replay.model = TrafficModel::REPLAY;
+            replay.replayPath = argv[2];
+            sim3.setTrafficConfig(replay);
+        }
         sim3.runSimulation();
         sim3.printSimulationResults();
+        if (trace) {
+            trace->close();
+            std::cout << "Trace: " << trace->getRecordCount() << " events, "
+                      << trace->getBytesWritten() << " bytes written to " << argv[1] << "\n";
+        }
 
         return 0;
     }
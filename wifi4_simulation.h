@@ -0,0 +1,87 @@
+#ifndef WIFI4_SIMULATION_H
+#define WIFI4_SIMULATION_H
+
+#include "simulator.h"
+#include "dcf.h"
+
+// 802.11n PHY: a single-user access point on the simulation seed itself
+struct HtPhy {
+    using AccessPointType = AccessPoint;
+    static constexpr WiFiStandard STANDARD = WiFiStandard::WIFI4;
+    static std::uint64_t accessPointSeed(std::uint64_t seed) { return seed; }
+    static double maxThroughput(const AccessPoint& accessPoint) { return accessPoint.calculateMaxThroughput(); }
+};
+
+// Backlogged stations contend with DCF random backoff
+class DcfBackoff {
+private:
+    DcfContention m_dcf;
+
+public:
+    explicit DcfBackoff(std::uint64_t seed) : m_dcf(DcfParameters(), deriveStreamSeed(seed, 6)) {}
+
+    void resize(size_t stations) { m_dcf.resize(stations); }
+    void activate(const StationTable&, const AccessPoint&, StationId station) { m_dcf.activate(station); }
+
+    DcfContention& getContention() { return m_dcf; }
+    const DcfContention& getContention() const { return m_dcf; }
+
+    std::uint64_t getCollisions() const { return m_dcf.getCollisions(); }
+    void printSummary(const AccessPoint&, std::ostream& out) const {
+        out << "Collisions: " << m_dcf.getCollisions() << " (" << m_dcf.getRetryDrops()
+            << " packets dropped at the retry limit)\n";
+    }
+
+    void saveState(SnapshotWriter& out) const { m_dcf.saveState(out); }
+    void loadState(SnapshotReader& in, const StationTable& stations) {
+        m_dcf.loadState(in);
+        if (m_dcf.size() != stations.size()) {
+            throw WiFiSimulationException("Corrupt simulation snapshot: DCF and station table disagree");
+        }
+    }
+};
+
+// One DCF channel access per event; needs the DcfBackoff scheduler
+class DcfMac {
+private:
+    std::uint64_t m_channelAccesses = 0;
+
+public:
+    enum EventType : std::uint16_t {
+        CONTENTION_ROUND = 0  // One DCF channel access; target = iteration index
+    };
+    static constexpr int DEFAULT_ITERATIONS = 1000;
+
+    template <typename Sim>
+    void startRound(Sim& sim, SimTime time, std::uint32_t round) {
+        sim.m_scheduler.schedule(time, sim.m_handlerId, CONTENTION_ROUND, round);
+    }
+
+    template <typename Sim>
+    void handleEvent(Sim& sim, const SimulationEvent& event) {
+        if (event.type != CONTENTION_ROUND) return;
+
+        // One DCF access: every backlogged user counts down its backoff and the
+        // earliest expiry transmits (or several collide). The medium is busy
+        // until the ACK or ACK timeout, and the next access starts from there.
+        DcfAccess access = sim.m_userScheduler.getContention().access(sim.m_stations, sim.m_accessPoint, event.time);
+        sim.m_accessPoint.getChannel().occupy(access.end);
+        ++m_channelAccesses;
+
+        const std::uint64_t users = std::max<std::uint64_t>(sim.m_stations.size(), 1);
+        sim.continueAccess(access.end, static_cast<std::uint32_t>(m_channelAccesses / users));
+    }
+
+    void saveState(SnapshotWriter& out) const { out.put(m_channelAccesses); }
+    void loadState(SnapshotReader& in) { in.get(m_channelAccesses); }
+};
+
+// WiFi4: DCF contention on an 802.11n access point. Defined in WiFiSimulation.cpp.
+using WiFi4Simulation = Simulator<DcfMac, HtPhy, DcfBackoff>;
+extern template class Simulator<DcfMac, HtPhy, DcfBackoff>;
+
+// Factory method to create WiFi4 simulation
+std::unique_ptr<WiFiSimulation> createWiFi4Simulation(size_t userCount,
+                                                      std::uint64_t seed = DEFAULT_SIMULATION_SEED);
+
+#endif // WIFI4_SIMULATION_H
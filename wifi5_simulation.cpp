@@ -1,72 +1,93 @@
 #include "wifi5_simulation.h"
+#include "profiler.h"
+#include "snapshot.h"
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 
 // WiFi5 Access Point Implementation
-WiFi5AccessPoint::WiFi5AccessPoint(const std::string& id)
-    : AccessPoint(id), 
+WiFi5AccessPoint::WiFi5AccessPoint(const std::string& id, std::uint64_t seed)
+    : AccessPoint(id, seed), 
       m_currentUserIndex(0),
-      m_generator(std::random_device{}()) {}
+      m_maxAggregation(1) {
+    seedGenerator(m_generator, deriveStreamSeed(seed, 2));
+}
 
-void WiFi5AccessPoint::broadcastInitialPacket() {
+SimTime WiFi5AccessPoint::broadcastInitialPacket(SimTime now) {
+    PROFILE_SCOPE("WiFi5AccessPoint::broadcastInitialPacket");
     // Simulate broadcast packet for multi-user MIMO setup
-    Packet<std::string> broadcastPacket("MIMO_SETUP", 0.5); // Small packet
+    PacketDescriptor broadcastPacket; // Small packet
+    broadcastPacket.sizeBytes = 512;
+    broadcastPacket.enqueueTime = now;
     // std::cout << "Broadcast Initial MIMO Setup Packet\n";
+    return now + getTransmissionDuration(broadcastPacket.sizeBytes);
 }
 
-void WiFi5AccessPoint::collectChannelStateInfo(std::vector<User>& users) {
-    m_csiPackets.clear();
-    
-    // Collect 200-byte CSI packets from each user
-    for (auto& user : users) {
-        Packet<std::string> csiPacket("CSI_" + user.getId(), 0.2); // 200 bytes
-        m_csiPackets.push_back(csiPacket);
-        // std::cout << "Collected CSI from " << user.getId() << "\n";
-    }
+SimTime WiFi5AccessPoint::collectChannelStateInfo(StationTable& stations, SimTime now) {
+    PROFILE_SCOPE("WiFi5AccessPoint::collectChannelStateInfo");
+    // Every user feeds back a 200-byte CSI report, sequentially on the
+    // medium; the reports land in one contiguous channel matrix
+    const std::uint32_t CSI_BYTES = 200;
+    m_muMimo.sound(stations.size(), m_generator);
+    return now + getTransmissionDuration(CSI_BYTES) * static_cast<std::int64_t>(stations.size());
 }
 
-void WiFi5AccessPoint::performMultiUserMIMOTransmission(std::vector<User>& users) {
-    // Round-robin transmission for 15ms
-    auto startTime = std::chrono::steady_clock::now();
-    
-    while (true) {
-        // Check if 15ms have passed
-        auto currentTime = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-            currentTime - startTime
-        ).count();
-        
-        if (elapsed >= 15) break;
+SimTime WiFi5AccessPoint::performMultiUserMIMOTransmission(StationTable& stations, SimTime start) {
+    PROFILE_SCOPE("WiFi5AccessPoint::performMultiUserMIMOTransmission");
+    const SimTime windowEnd = start + getMultiUserMIMODuration();
+    const double peakEfficiency = calculateMaxThroughput() / getChannel().getBandwidth();  // bits/s/Hz
+    const size_t poolSize = m_muMimo.getConfig().candidatePool;
+    SimTime now = start;
 
-        // Round-robin transmission
-        if (m_currentUserIndex >= users.size()) {
-            m_currentUserIndex = 0;
+    // Only users sounded for this window can be grouped; users that joined
+    // since wait for the next sounding round
+    const size_t sounded = m_muMimo.getChannelState().users();
+    auto nextCandidate = [&](size_t from) {
+        StationId station = stations.nextBacklogged(static_cast<StationId>(std::min<size_t>(from, NO_STATION)));
+        return station < sounded ? station : NO_STATION;
+    };
+
+    // Stop at the end of the window, or once no user has anything to send
+    while (now < windowEnd) {
+        // Candidates: the next backlogged users in round-robin order
+        m_candidates.clear();
+        StationId anchor = nextCandidate(m_currentUserIndex);
+        if (anchor == NO_STATION) anchor = nextCandidate(0);
+        if (anchor == NO_STATION) break;
+        for (StationId station = anchor; station != NO_STATION && m_candidates.size() < poolSize;) {
+            m_candidates.push_back(station);
+            station = nextCandidate(station + 1);
+            if (station == NO_STATION) station = nextCandidate(0);
+            if (station == anchor) break;
         }
 
-        User& currentUser = users[m_currentUserIndex];
-        
-        // Attempt transmission for current user
-        try {
-            if (currentUser.hasPackets()) {
-                Packet<std::string> packet = currentUser.getNextPacket();
-                
-                // Simulate parallel transmission
-                // std::cout << "Parallel transmission for " 
-                //           << currentUser.getId() << "\n";
-                
-                // Record transmission time
-                currentUser.recordTransmissionTime(
-                    std::chrono::steady_clock::now()
-                );
+        m_muMimo.formGroup(m_candidates, m_group, m_groupSinr);
+
+        // Members send up to one A-MPDU each, in parallel
+        SimTime txopEnd = now;
+        for (size_t member = 0; member < m_group.size(); ++member) {
+            StationId station = m_group[member];
+            double efficiency = std::min(std::log2(1.0 + m_groupSinr[member]), peakEfficiency);
+            double rateMbps = getChannel().getBandwidth() * efficiency;
+            SimTime streamTime = now;
+            PacketSpan batch = stations.dequeueBatch(station, getMaxAggregation());
+            for (PacketHandle handle : batch) {
+                const PacketDescriptor& packet = stations.getPacket(handle);
+                stations.trace(TraceEventType::TX_START, station, streamTime, packet.sizeBytes);
+                // Bits divided by Mbps gives microseconds
+                streamTime += std::chrono::duration_cast<SimTime>(
+                    std::chrono::duration<double, std::micro>(packet.sizeBytes * 8.0 / rateMbps));
+                stations.recordDelivery(station, packet, streamTime);
             }
+            stations.admitBacklog(station, streamTime);
+            txopEnd = std::max(txopEnd, streamTime);
         }
-        catch (const WiFiSimulationException& e) {
-            std::cerr << "Transmission error: " << e.what() << std::endl;
-        }
+        now = txopEnd;
 
         // Move to next user
-        m_currentUserIndex++;
+        m_currentUserIndex = static_cast<size_t>(anchor) + 1;
     }
+    return now;
 }
 
 bool WiFi5AccessPoint::tryMultiUserTransmission(User* user) {
@@ -75,56 +96,26 @@ bool WiFi5AccessPoint::tryMultiUserTransmission(User* user) {
     return true;
 }
 
-// WiFi5 Simulation Implementation
-WiFi5Simulation::WiFi5Simulation(size_t userCount, const std::string& apId)
-    : WiFi4Simulation(userCount, apId), 
-      m_wifi5AccessPoint(apId) {}
-
-void WiFi5Simulation::runSimulation() {
-    const int MAX_ITERATIONS = 100;
-
-    for (int iter = 0; iter < MAX_ITERATIONS; ++iter) {
-        // WiFi5 specific simulation flow
-        
-        // 1. Broadcast initial packet
-        m_wifi5AccessPoint.broadcastInitialPacket();
-        
-        // 2. Collect Channel State Information
-        m_wifi5AccessPoint.collectChannelStateInfo(m_users);
-        
-        // 3. Perform Multi-User MIMO transmission
-        m_wifi5AccessPoint.performMultiUserMIMOTransmission(m_users);
-    }
+void WiFi5AccessPoint::saveState(SnapshotWriter& out) const {
+    AccessPoint::saveState(out);
+    m_muMimo.saveState(out);
+    out.put<std::uint64_t>(m_currentUserIndex);
+    out.put<std::uint64_t>(m_maxAggregation);
+    out.putGenerator(m_generator);
 }
 
-void WiFi5Simulation::printSimulationResults() {
-    std::cout << "WiFi5 Simulation Results:\n";
-    
-    // Calculate and print throughput and latency
-    std::cout << "Max Theoretical Throughput: " 
-              << m_wifi5AccessPoint.calculateMaxThroughput() << " Mbps\n";
-
-    // Calculate latency for each user
-    float avg_latency = 0.0;
-    float max_latency = 0.0;
-    for (const auto& user : m_users) {
-        const auto& transmissionTimes = user.getTransmissionTimes();
-        
-        if (transmissionTimes.size() > 1) {
-            auto totalLatency = std::chrono::duration_cast<std::chrono::microseconds>(
-                transmissionTimes.back() - transmissionTimes.front()
-            ).count();
-            avg_latency += totalLatency / transmissionTimes.size();
-            max_latency = max_latency > (totalLatency / transmissionTimes.size()) ? max_latency : (totalLatency / transmissionTimes.size());
-            // std::cout << user.getId() << " Average Latency: " 
-            //           << (totalLatency / transmissionTimes.size()) << " microseconds\n";
-        }
-    }
-    std::cout<< "Average Latency of "<< m_users.size() << " Users: " << avg_latency / m_users.size() << " microseconds\n";
-    std::cout<< "Max Latency of "<< m_users.size() << " Users: " << max_latency << " microseconds\n";
+void WiFi5AccessPoint::loadState(SnapshotReader& in) {
+    AccessPoint::loadState(in);
+    m_muMimo.loadState(in);
+    m_currentUserIndex = static_cast<size_t>(in.get<std::uint64_t>());
+    setMaxAggregation(static_cast<size_t>(in.get<std::uint64_t>()));
+    in.getGenerator(m_generator);
 }
 
+// WiFi5 Simulation Implementation
+template class Simulator<MuMimoMac, VhtPhy, BacklogPolling>;
+
 // Factory method implementation
-std::unique_ptr<WiFi5Simulation> createWiFi5Simulation(size_t userCount) {
-    return std::make_unique<WiFi5Simulation>(userCount);
-}
\ No newline at end of file
+std::unique_ptr<WiFiSimulation> createWiFi5Simulation(size_t userCount, std::uint64_t seed) {
+    return std::make_unique<SimulationAdapter<WiFi5Simulation>>(std::in_place, userCount, "AP1", seed);
+}
@@ -1,48 +1,148 @@
 #ifndef WIFI5_SIMULATION_H
 #define WIFI5_SIMULATION_H
 
-#include "WiFiSimulation.h"
+#include "simulator.h"
+#include "mu_mimo.h"
 
 class WiFi5AccessPoint : public AccessPoint {
 private:
-    // CSI (Channel State Information) specific attributes
-    std::vector<Packet<std::string>> m_csiPackets;
+    // CSI (Channel State Information) of the last sounding round, grouping
+    // and precoding
+    MuMimoEngine m_muMimo;
     const double m_multiUserMIMODuration = 15.0; // ms
+
+    // Scratch space reused by every group
+    std::vector<StationId> m_candidates;
+    std::vector<StationId> m_group;
+    std::vector<float> m_groupSinr;
     
     // Round-robin scheduling attributes
     size_t m_currentUserIndex;
+    size_t m_maxAggregation;  // Packets a user may send per round-robin turn
     std::mt19937 m_generator;
 
 public:
-    WiFi5AccessPoint(const std::string& id);
+    WiFi5AccessPoint(const std::string& id, std::uint64_t seed = DEFAULT_SIMULATION_SEED);
+
+    // Broadcast initial packet for multi-user MIMO setup; returns the
+    // simulated time at which the broadcast has been delivered
+    SimTime broadcastInitialPacket(SimTime now);
+
+    // Collect Channel State Information (CSI) from users, one after another;
+    // returns the simulated time at which the last CSI packet arrives
+    SimTime collectChannelStateInfo(StationTable& stations, SimTime now);
 
-    // Broadcast initial packet for multi-user MIMO setup
-    void broadcastInitialPacket();
+    // Perform multi-user MIMO transmission for one 15 ms window starting at
+    // `start`: a sequence of TXOPs, each serving a near-orthogonal group
+    // anchored at the next backlogged user in round-robin order. Members
+    // send in parallel at the rate their zero-forcing SINR supports, and a
+    // TXOP lasts as long as its longest A-MPDU. Returns when the last TXOP
+    // ends, which is past the window if one started close to its end.
+    SimTime performMultiUserMIMOTransmission(StationTable& stations, SimTime start);
 
-    // Collect Channel State Information (CSI) from users
-    void collectChannelStateInfo(std::vector<User>& users);
+    void setMuMimoConfig(const MuMimoConfig& config) { m_muMimo.setConfig(config); }
+    const MuMimoEngine& getMuMimo() const { return m_muMimo; }
 
-    // Perform multi-user MIMO transmission
-    void performMultiUserMIMOTransmission(std::vector<User>& users);
+    // Length of the multi-user MIMO data window
+    SimTime getMultiUserMIMODuration() const {
+        return std::chrono::duration_cast<SimTime>(
+            std::chrono::duration<double, std::milli>(m_multiUserMIMODuration));
+    }
+
+    // Limit on packets aggregated into one transmission (A-MPDU length)
+    void setMaxAggregation(size_t packets) { m_maxAggregation = packets > 0 ? packets : 1; }
+    size_t getMaxAggregation() const { return m_maxAggregation; }
 
     // Additional WiFi5 specific transmission method
     bool tryMultiUserTransmission(User* user);
+
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
 };
 
-// Extended Simulation Class for WiFi5
-class WiFi5Simulation : public WiFi4Simulation {
-private:
-    WiFi5AccessPoint m_wifi5AccessPoint;
+// 802.11ac PHY: a multi-user MIMO access point on its own random stream
+struct VhtPhy {
+    using AccessPointType = WiFi5AccessPoint;
+    static constexpr WiFiStandard STANDARD = WiFiStandard::WIFI5;
+    static std::uint64_t accessPointSeed(std::uint64_t seed) { return deriveStreamSeed(seed, 3); }
 
-public:
-    WiFi5Simulation(size_t userCount, const std::string& apId = "AP1");
+    // Every spatial stream of a full group at the peak rate
+    static double maxThroughput(const WiFi5AccessPoint& accessPoint) {
+        const MuMimoConfig& config = accessPoint.getMuMimo().getConfig();
+        return std::max(1u, std::min(config.maxGroupSize, config.antennas)) * accessPoint.calculateMaxThroughput();
+    }
+};
+
+// No per-station access state: the access point polls the backlog bitmap
+// in round-robin order when it forms groups
+struct BacklogPolling {
+    explicit BacklogPolling(std::uint64_t) {}
+
+    void resize(size_t) {}
+    template <typename AccessPointType>
+    void activate(const StationTable&, AccessPointType&, StationId) {}
 
-    // Override base class methods
-    void runSimulation() override;
-    void printSimulationResults() override;
+    std::uint64_t getCollisions() const { return 0; }
+    template <typename AccessPointType>
+    void printSummary(const AccessPointType&, std::ostream&) const {}
+
+    void saveState(SnapshotWriter&) const {}
+    void loadState(SnapshotReader&, const StationTable&) {}
+};
+
+// Sounding (NDP announcement and CSI feedback) followed by a multi-user
+// MIMO data window; needs a WiFi5AccessPoint
+struct MuMimoMac {
+    enum EventType : std::uint16_t {
+        SOUNDING_ROUND = 1,  // target = iteration index
+        MU_MIMO_WINDOW = 2   // target = iteration index
+    };
+    static constexpr int DEFAULT_ITERATIONS = 100;
+
+    template <typename Sim>
+    void startRound(Sim& sim, SimTime time, std::uint32_t round) {
+        sim.m_scheduler.schedule(time, sim.m_handlerId, SOUNDING_ROUND, round);
+    }
+
+    template <typename Sim>
+    void handleEvent(Sim& sim, const SimulationEvent& event) {
+        switch (event.type) {
+        case SOUNDING_ROUND: {
+            // 1. Broadcast initial packet
+            SimTime now = sim.m_accessPoint.broadcastInitialPacket(event.time);
+
+            // 2. Collect Channel State Information
+            now = sim.m_accessPoint.collectChannelStateInfo(sim.m_stations, now);
+
+            sim.m_scheduler.schedule(now, sim.m_handlerId, MU_MIMO_WINDOW, event.target);
+            break;
+        }
+        case MU_MIMO_WINDOW: {
+            // 3. Perform Multi-User MIMO transmission
+            SimTime end = sim.m_accessPoint.performMultiUserMIMOTransmission(sim.m_stations, event.time);
+
+            // The data window holds the medium for its full length; the next
+            // sounding also waits for a TXOP that overran it
+            sim.continueAccess(std::max(end, event.time + sim.m_accessPoint.getMultiUserMIMODuration()),
+                               event.target + 1);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    void saveState(SnapshotWriter&) const {}
+    void loadState(SnapshotReader&) {}
 };
 
+// WiFi5: sounding and MU-MIMO windows on an 802.11ac access point.
+// Defined in wifi5_simulation.cpp.
+using WiFi5Simulation = Simulator<MuMimoMac, VhtPhy, BacklogPolling>;
+extern template class Simulator<MuMimoMac, VhtPhy, BacklogPolling>;
+
 // Factory method to create WiFi5 simulation
-std::unique_ptr<WiFi5Simulation> createWiFi5Simulation(size_t userCount);
+std::unique_ptr<WiFiSimulation> createWiFi5Simulation(size_t userCount,
+                                                      std::uint64_t seed = DEFAULT_SIMULATION_SEED);
 
-#endif // WIFI5_SIMULATION_H
\ No newline at end of file
+#endif // WIFI5_SIMULATION_H
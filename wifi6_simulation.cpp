@@ -1,70 +1,137 @@
 #include "wifi6_simulation.h"
+#include "profiler.h"
+#include "snapshot.h"
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 
 // WiFi6 Access Point Implementation
-WiFi6AccessPoint::WiFi6AccessPoint(const std::string& id) : WiFi5AccessPoint(id) {}
+WiFi6AccessPoint::WiFi6AccessPoint(const std::string& id, std::uint64_t seed)
+    : AccessPoint(id, seed),
+      m_ruScheduler(createRuScheduler(RuSchedulingPolicy::ROUND_ROBIN)) {}
+
+WiFi6AccessPoint::WiFi6AccessPoint(const WiFi6AccessPoint& other)
+    : AccessPoint(other),
+      m_ruAllocator(other.m_ruAllocator),
+      m_grants(other.m_grants),
+      m_ruScheduler(other.m_ruScheduler->clone()) {}
 
 void WiFi6AccessPoint::initializeSubChannels() {
-    m_subChannels = {
-        {2.0, false}, {4.0, false}, {10.0, false}, {4.0, false} // Sub-channels totaling 20 MHz
-    };
+    const RuLayout& layout = ruLayoutFor(getChannel().getBandwidth());
+    if (&layout != &m_ruAllocator.getLayout()) {
+        m_ruAllocator.setLayout(layout);
+    } else {
+        m_ruAllocator.clear();
+    }
 }
 
-void WiFi6AccessPoint::allocateSubChannels(std::vector<User>& users) {
-    size_t userIndex = 0;
-    for (auto& subChannel : m_subChannels) {
-        if (userIndex >= users.size()) break;
-        subChannel.isOccupied = true;
-        // Simulate allocation (no real packet logic for this demo)
-        userIndex++;
+void WiFi6AccessPoint::activateUser(const StationTable& stations, StationId station) {
+    if (m_ruScheduler->size() < stations.size()) {
+        m_ruScheduler->resize(stations.size());
     }
+    m_ruScheduler->activate(stations, station);
 }
 
-void WiFi6AccessPoint::performOFDMA(std::vector<User>& users) {
-    initializeSubChannels();
-    allocateSubChannels(users);
-
-    auto startTime = std::chrono::steady_clock::now();
-    while (true) {
-        auto currentTime = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-            currentTime - startTime).count();
-        if (elapsed >= m_ofdmaDuration) break;
-
-        // Transmit packets for each allocated user
-        for (auto& user : users) {
-            if (user.hasPackets()) {
-                try {
-                    Packet<std::string> packet = user.getNextPacket();
-                    user.recordTransmissionTime(std::chrono::steady_clock::now());
-                } catch (const WiFiSimulationException& e) {
-                    std::cerr << "Transmission error: " << e.what() << std::endl;
-                }
-            }
+void WiFi6AccessPoint::releaseSubChannels(StationTable& stations) {
+    for (const RuGrant& grant : m_grants) {
+        m_ruScheduler->complete(stations, grant.user, 0);
+    }
+    m_grants.clear();
+}
+
+void WiFi6AccessPoint::allocateSubChannels(StationTable& stations) {
+    PROFILE_SCOPE("WiFi6AccessPoint::allocateSubChannels");
+    releaseSubChannels(stations);
+    m_ruAllocator.clear();
+
+    const RuLayout& layout = m_ruAllocator.getLayout();
+    m_selectedUsers.clear();
+    m_ruScheduler->selectUsers(stations, layout.maxUsers(), m_selectedUsers);
+    if (m_selectedUsers.empty()) return;
+
+    // Tones each user needs to empty its queue within the window, assuming
+    // every queued packet is the size of its head packet
+    const double windowUs = std::chrono::duration<double, std::micro>(getOFDMADuration()).count();
+    const double bitsPerTone = calculateMaxThroughput() * windowUs / layout.fullBandTones;
+    const std::uint32_t share = largestRuWithin(
+        static_cast<std::uint32_t>(layout.fullBandTones / m_selectedUsers.size()));
+    m_demands.clear();
+    for (StationId station : m_selectedUsers) {
+        double bits = 8.0 * stations.peekPacket(station).sizeBytes * stations.getQueueLength(station);
+        double tones = std::ceil(bits / (bitsPerTone * stations.getLinkEfficiency(station)));
+        m_demands.push_back(static_cast<std::uint32_t>(std::min<double>(tones, share)));
+    }
+
+    m_ruAllocator.allocate(m_demands, m_assignments);
+    for (size_t i = 0; i < m_selectedUsers.size(); ++i) {
+        if (m_assignments[i] != RuAllocator::NO_RU) {
+            m_grants.push_back(RuGrant{m_selectedUsers[i], m_assignments[i]});
+        } else {
+            m_ruScheduler->complete(stations, m_selectedUsers[i], 0);  // No room this window
         }
     }
 }
 
-// WiFi6 Simulation Implementation
-WiFi6Simulation::WiFi6Simulation(size_t userCount, const std::string& apId)
-    : WiFi5Simulation(userCount, apId), 
-      m_wifi6AccessPoint(apId) {}
+SimTime WiFi6AccessPoint::performOFDMA(StationTable& stations, SimTime start) {
+    PROFILE_SCOPE("WiFi6AccessPoint::performOFDMA");
+    initializeSubChannels();
+    allocateSubChannels(stations);
 
-void WiFi6Simulation::runSimulation() {
-    const int MAX_ITERATIONS = 100;
+    // Allocated users send in parallel, each at its RU's share of the PHY
+    // rate scaled by its link, until the window or its queue ends
+    const SimTime windowEnd = start + getOFDMADuration();
+    const RuLayout& layout = m_ruAllocator.getLayout();
+    const double peakRate = calculateMaxThroughput();
+    SimTime end = start;
+    for (const RuGrant& grant : m_grants) {
+        StationId station = grant.user;
+        double share = static_cast<double>(layout.units[grant.unit].tones) / layout.fullBandTones;
+        double rateMbps = peakRate * share * stations.getLinkEfficiency(station);
+        std::uint64_t bytes = 0;
+        SimTime now = start;
+        while (stations.hasPackets(station)) {
+            // Bits divided by Mbps gives microseconds. Only whole packets fit,
+            // except that a packet longer than a window still goes out alone.
+            SimTime airtime = std::chrono::duration_cast<SimTime>(std::chrono::duration<double, std::micro>(
+                stations.peekPacket(station).sizeBytes * 8.0 / rateMbps));
+            if (now + airtime > windowEnd && bytes > 0) break;
 
-    for (int iter = 0; iter < MAX_ITERATIONS; ++iter) {
-        m_wifi6AccessPoint.performOFDMA(m_users);
+            PacketDescriptor packet;
+            stations.tryDequeue(station, packet);
+            stations.trace(TraceEventType::TX_START, station, now, packet.sizeBytes);
+            now += airtime;
+            stations.recordDelivery(station, packet, now);
+            stations.admitBacklog(station, now);
+            bytes += packet.sizeBytes;
+        }
+        m_ruScheduler->complete(stations, station, bytes);
+        end = std::max(end, now);
     }
+    m_grants.clear();
+    m_ruScheduler->endWindow(stations);
+    return end;
 }
 
-void WiFi6Simulation::printSimulationResults() {
-    std::cout << "WiFi6 Simulation Results:\n";
-    WiFi5Simulation::printSimulationResults();
+void WiFi6AccessPoint::saveState(SnapshotWriter& out) const {
+    AccessPoint::saveState(out);
+    m_ruAllocator.saveState(out);
+    out.putVector(m_grants);
+    out.put(m_ruScheduler->getPolicy());
+    m_ruScheduler->saveState(out);
 }
 
+void WiFi6AccessPoint::loadState(SnapshotReader& in) {
+    AccessPoint::loadState(in);
+    m_ruAllocator.loadState(in);
+    in.getVector(m_grants);
+    m_ruScheduler = createRuScheduler(in.get<RuSchedulingPolicy>());
+    m_ruScheduler->loadState(in);
+}
+
+// WiFi6 Simulation Implementation
+template class Simulator<OfdmaMac, HePhy, RuQueue>;
+
 // Factory method implementation
-std::unique_ptr<WiFi6Simulation> createWiFi6Simulation(size_t userCount) {
-    return std::make_unique<WiFi6Simulation>(userCount);
+std::unique_ptr<WiFiSimulation> createWiFi6Simulation(size_t userCount, std::uint64_t seed) {
+    return std::make_unique<SimulationAdapter<WiFi6Simulation>>(std::in_place, userCount, "AP1", seed);
 }
@@ -1,45 +1,133 @@
 #ifndef WIFI6_SIMULATION_H
 #define WIFI6_SIMULATION_H
 
-#include "wifi5_simulation.h"
+#include "simulator.h"
+#include "ru_scheduler.h"
+#include "ru_allocation.h"
 #include <queue>
 #include <vector>
 
-class WiFi6AccessPoint : public WiFi5AccessPoint {
+class WiFi6AccessPoint : public AccessPoint {
 private:
-    struct SubChannel {
-        double bandwidth; // Bandwidth of the sub-channel
-        bool isOccupied;  // Is this sub-channel currently occupied
+    struct RuGrant {
+        StationId user;
+        int unit;  // Index into the allocator's layout
     };
 
-    std::vector<SubChannel> m_subChannels; // List of sub-channels
-    const double m_ofdmaDuration = 5.0;    // Duration for OFDMA scheduling (ms)
+    RuAllocator m_ruAllocator;
+    std::vector<RuGrant> m_grants;       // This window's user-to-RU mapping
+    const double m_ofdmaDuration = 5.0;  // Duration for OFDMA scheduling (ms)
+
+    std::unique_ptr<RuScheduler> m_ruScheduler;
+
+    // Scratch space reused every window
+    std::vector<StationId> m_selectedUsers;
+    std::vector<std::uint32_t> m_demands;
+    std::vector<int> m_assignments;
+
+    void releaseSubChannels(StationTable& stations);
 
 public:
-    WiFi6AccessPoint(const std::string& id);
+    WiFi6AccessPoint(const std::string& id, std::uint64_t seed = DEFAULT_SIMULATION_SEED);
+    WiFi6AccessPoint(const WiFi6AccessPoint& other);
+    WiFi6AccessPoint& operator=(const WiFi6AccessPoint&) = delete;
 
-    // Initialize sub-channels based on 20 MHz bandwidth
+    // Free every RU of the channel's 802.11ax layout (20/40/80/160 MHz)
     void initializeSubChannels();
 
-    // Allocate sub-channels to users
-    void allocateSubChannels(std::vector<User>& users);
+    // Map the scheduler's best backlogged users (at most one per 26-tone
+    // RU) to non-overlapping RUs sized by their queued bytes, capped at an
+    // equal share of the band. Users left over from an earlier allocation
+    // go back to the scheduler first.
+    void allocateSubChannels(StationTable& stations);
+
+    // Perform OFDMA transmission for one 5 ms window starting at `start`:
+    // each allocated user sends back to back on its own RU. Returns when the
+    // last transmission ends, which is past the window if a packet longer
+    // than the window went out.
+    SimTime performOFDMA(StationTable& stations, SimTime start);
+
+    // Users granted an RU in the last allocation
+    size_t getAllocatedUsers() const { return m_grants.size(); }
+
+    // Choose the user selection policy; queued users are dropped, so set
+    // it before the first activateUser()
+    void setRuSchedulingPolicy(RuSchedulingPolicy policy) { m_ruScheduler = createRuScheduler(policy); }
+    RuSchedulingPolicy getRuSchedulingPolicy() const { return m_ruScheduler->getPolicy(); }
 
-    // Perform OFDMA transmission
-    void performOFDMA(std::vector<User>& users);
+    // Make a newly backlogged station eligible for sub-channels
+    void activateUser(const StationTable& stations, StationId station);
+
+    // Length of the OFDMA scheduling window
+    SimTime getOFDMADuration() const {
+        return std::chrono::duration_cast<SimTime>(
+            std::chrono::duration<double, std::milli>(m_ofdmaDuration));
+    }
+
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
 };
 
-class WiFi6Simulation : public WiFi5Simulation {
-private:
-    WiFi6AccessPoint m_wifi6AccessPoint;
+// 802.11ax PHY: an OFDMA access point on its own random stream
+struct HePhy {
+    using AccessPointType = WiFi6AccessPoint;
+    static constexpr WiFiStandard STANDARD = WiFiStandard::WIFI6;
+    static std::uint64_t accessPointSeed(std::uint64_t seed) { return deriveStreamSeed(seed, 4); }
+    static double maxThroughput(const WiFi6AccessPoint& accessPoint) { return accessPoint.calculateMaxThroughput(); }
+};
 
-public:
-    WiFi6Simulation(size_t userCount, const std::string& apId = "AP1");
+// Backlogged stations queue in the access point's RU scheduler
+struct RuQueue {
+    explicit RuQueue(std::uint64_t) {}
 
-    void runSimulation() override;
-    void printSimulationResults() override;
+    void resize(size_t) {}
+    void activate(const StationTable& stations, WiFi6AccessPoint& accessPoint, StationId station) {
+        accessPoint.activateUser(stations, station);
+    }
+
+    std::uint64_t getCollisions() const { return 0; }
+    void printSummary(const WiFi6AccessPoint& accessPoint, std::ostream& out) const {
+        out << "RU Scheduling: " << toString(accessPoint.getRuSchedulingPolicy()) << "\n";
+    }
+
+    void saveState(SnapshotWriter&) const {}
+    void loadState(SnapshotReader&, const StationTable&) {}
+};
+
+// One OFDMA window per round; needs a WiFi6AccessPoint
+struct OfdmaMac {
+    enum EventType : std::uint16_t {
+        OFDMA_WINDOW = 3  // target = iteration index
+    };
+    static constexpr int DEFAULT_ITERATIONS = 100;
+
+    template <typename Sim>
+    void startRound(Sim& sim, SimTime time, std::uint32_t round) {
+        sim.m_scheduler.schedule(time, sim.m_handlerId, OFDMA_WINDOW, round);
+    }
+
+    template <typename Sim>
+    void handleEvent(Sim& sim, const SimulationEvent& event) {
+        if (event.type != OFDMA_WINDOW) return;
+
+        // The next window waits for a frame that overran this one
+        SimTime end = sim.m_accessPoint.performOFDMA(sim.m_stations, event.time);
+        sim.continueAccess(std::max(end, event.time + sim.m_accessPoint.getOFDMADuration()), event.target + 1);
+    }
+
+    void saveState(SnapshotWriter&) const {}
+    void loadState(SnapshotReader&) {}
 };
 
+// WiFi6: OFDMA windows on an 802.11ax access point. The RU scheduling
+// policy is the access point's, e.g.
+//   simulation->as<WiFi6Simulation>()->getAccessPoint().setRuSchedulingPolicy(policy)
+// Defined in wifi6_simulation.cpp.
+using WiFi6Simulation = Simulator<OfdmaMac, HePhy, RuQueue>;
+extern template class Simulator<OfdmaMac, HePhy, RuQueue>;
+
 // Factory method to create WiFi6 simulation
-std::unique_ptr<WiFi6Simulation> createWiFi6Simulation(size_t userCount);
+std::unique_ptr<WiFiSimulation> createWiFi6Simulation(size_t userCount,
+                                                      std::uint64_t seed = DEFAULT_SIMULATION_SEED);
 
 #endif // WIFI6_SIMULATION_H
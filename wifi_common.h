@@ -0,0 +1,61 @@
+#ifndef WIFI_COMMON_H
+#define WIFI_COMMON_H
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "event_scheduler.h"
+
+// Exception class for WiFi simulation errors
+class WiFiSimulationException : public std::runtime_error {
+public:
+    explicit WiFiSimulationException(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
+// Location on the deployment floor plan, in meters
+struct Position {
+    double x = 0.0;
+    double y = 0.0;
+};
+
+inline double distanceBetween(const Position& a, const Position& b) {
+    double dx = a.x - b.x;
+    double dy = a.y - b.y;
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Abstract base class for network entities
+class NetworkEntity {
+protected:
+    std::string m_id;
+    Position m_position;
+
+public:
+    NetworkEntity(const std::string& id) : m_id(id) {}
+    virtual ~NetworkEntity() = default;
+    std::string getId() const { return m_id; }
+
+    const Position& getPosition() const { return m_position; }
+    void setPosition(const Position& position) { m_position = position; }
+};
+
+// Packet Template Class
+template <typename T>
+class Packet {
+private:
+    T m_data;
+    size_t m_size;  // in KB
+    SimTime m_creationTime;
+
+public:
+    Packet(const T& data, size_t size = 1, SimTime creationTime = SimTime::zero()) 
+        : m_data(data), m_size(size), 
+          m_creationTime(creationTime) {}
+
+    size_t getSize() const { return m_size; }
+    auto getCreationTime() const { return m_creationTime; }
+};
+
+#endif // WIFI_COMMON_H